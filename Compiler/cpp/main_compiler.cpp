@@ -1,14 +1,14 @@
 // main.cpp
-#include "../include/Compiler.h"
+#include "../../Program/include/Compiler.h"
 #include <fstream>
 #include <iostream>
-#include <vector>
 #include <string>
 #include <cstring>
 
 int main(int argc, char* argv[]) {
     std::string input_file;
     std::string output_file;
+    ObjectEncoding encoding = ObjectEncoding::TEXT;
 
     // Parseo simple de argumentos tipo -i <input> -o <output>
     for (int i = 1; i < argc; ++i) {
@@ -16,8 +16,11 @@ int main(int argc, char* argv[]) {
             input_file = argv[++i];
         } else if ((std::strcmp(argv[i], "-o") == 0 || std::strcmp(argv[i], "--ofile") == 0) && i + 1 < argc) {
             output_file = argv[++i];
+        } else if (std::strcmp(argv[i], "-b") == 0 || std::strcmp(argv[i], "--binary") == 0) {
+            encoding = ObjectEncoding::PACKED;
         } else if (std::strcmp(argv[i], "-h") == 0) {
-            std::cout << "Uso: ./compiler -i <archivo_entrada> -o <archivo_salida>\n";
+            std::cout << "Uso: ./compiler -i <archivo_entrada> -o <archivo_salida> [-b]\n"
+                      << "  -b  objeto binario (el que carga el simulador) en lugar de texto\n";
             return 0;
         }
     }
@@ -33,13 +36,8 @@ int main(int argc, char* argv[]) {
             throw std::runtime_error("No se pudo abrir el archivo de entrada: " + input_file);
         }
 
-        std::vector<std::vector<std::string>> instr = clean_instructions(input);
-        std::vector<std::string> bin_instr = get_binary(instr);
-
-        std::ofstream output(output_file);
-        for (const auto& line : bin_instr) {
-            output << line << '\n';
-        }
+        std::ofstream output(output_file, std::ios::binary);
+        Compiler::assemble(input, output, input_file, ObjectFormat::ANY_PE, encoding);
 
         std::cout << "Compilación completada. Resultado en: " << output_file << '\n';
 
@@ -1,44 +1,120 @@
+import os
 import sys
 import getopt
 import re
 
 CLI_ERROR_CODE = 2
 
-# Opcodes de 2 bits
+# Formato de instrucción: copia de InstructionFormat (Program/include/Instruction_Format.h).
+# Campos como (bit menos significativo, ancho); las instrucciones ocupan 64 bits.
+INSTRUCTION_BITS = 64
+OPCODE = (62, 2)
+SRC = (57, 5)
+ADDR = (20, 37)
+LINES = (12, 8)         # LINE_COUNT de WRITE_MEM o SIZE de READ_MEM
+START = (4, 8)
+CACHE_LINE = (20, 8)
+QOS = (0, 4)
+
+# Mnemónico -> (opcode, [(validador, campo)] en orden de ensamblador)
 isa = {
-    'WRITE_MEM': {'opcode': '00'},
-    'READ_MEM': {'opcode': '01'},
-    'BROADCAST_INVALIDATE': {'opcode': '10'}
+    'WRITE_MEM': (0b00, [('src', SRC), ('addr', ADDR), ('line_count', LINES),
+                         ('start_line', START), ('qos', QOS)]),
+    'READ_MEM': (0b01, [('src', SRC), ('addr', ADDR), ('read_size', LINES), ('qos', QOS)]),
+    'BROADCAST_INVALIDATE': (0b10, [('src', SRC), ('cache_frame', CACHE_LINE), ('qos', QOS)]),
 }
 
-ADDR_SIZE = 16
-CACHE_LINE_SIZE = 8
-QOS_SIZE = 4
-SRC_SIZE = 5
-
-MAX_ADDR = 4096 * 4
-MAX_CACHE_LINE = 512
 MAX_QOS = 15
 MAX_SRC = 31
 
+# Geometría: copia de Geometry (Program/include/Geometry.h), leída de los mismos
+# archivos de configuración que usan el generador y el simulador
+WORD_BYTES = 4
+BLOCK_SIZE = 16
+BLOCK_WORDS = BLOCK_SIZE // WORD_BYTES
+CONFIG_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'Program', 'config')
+
+
+def field_max(field):
+    return (1 << field[1]) - 1
+
+
+class Geometry:
+    def __init__(self, memory_words=4096, sets=32, ways=4, line_size=16):
+        self.memory_words = memory_words
+        self.sets = sets
+        self.ways = ways
+        self.line_size = line_size
+
+    @staticmethod
+    def load(config_dir):
+        memory = read_config(os.path.join(config_dir, 'memory.txt'))
+        cache = read_config(os.path.join(config_dir, 'cache.txt'))
+        geometry = Geometry()
+        geometry.memory_words = int(memory.get('memory_words', str(geometry.memory_words)), 0)
+        geometry.sets = int(cache.get('sets', str(geometry.sets)), 0)
+        geometry.ways = int(cache.get('ways', str(geometry.ways)), 0)
+        geometry.line_size = int(cache.get('line_size', str(geometry.line_size)), 0)
+        geometry.validate()
+        return geometry
+
+    def validate(self):
+        if self.memory_words <= 0 or self.memory_words % BLOCK_WORDS != 0:
+            raise Exception(f"Geometry: memory_words debe ser múltiplo de {BLOCK_WORDS} y mayor que 0")
+        if self.memory_words > 1 << ADDR[1]:
+            raise Exception(f"Geometry: memory_words no puede pasar de 2^{ADDR[1]}, lo que direcciona el campo ADDR")
+        if self.sets <= 0 or self.sets & (self.sets - 1) or self.ways <= 0:
+            raise Exception("Geometry: sets debe ser potencia de 2 y ways mayor que 0")
+        if self.line_size < BLOCK_SIZE or self.line_size & (self.line_size - 1):
+            raise Exception(f"Geometry: line_size debe ser potencia de 2 y al menos {BLOCK_SIZE}")
+
+    def cache_block_limit(self):
+        # START_LINE y LINE_COUNT cuentan bloques de 16 bytes, recortados al campo
+        return min(self.sets * self.ways * (self.line_size // BLOCK_SIZE), 1 << LINES[1])
+
+    def cache_frame_limit(self):
+        # CACHE_LINE de BROADCAST_INVALIDATE es un frame (set * ways + way)
+        return min(self.sets * self.ways, 1 << CACHE_LINE[1])
+
+
+def read_config(path):
+    """Lee un archivo "clave: valor" con comentarios '#'; si no existe, queda vacío."""
+    values = {}
+    if not os.path.exists(path):
+        return values
+    with open(path, 'r') as f:
+        for line in f:
+            line = line.split('#')[0].strip()
+            if ':' in line:
+                key, value = line.split(':', 1)
+                values[key.strip()] = value.strip()
+    return values
+
+
+geometry = Geometry()
+
 
 def get_args(argv):
     input_file = ''
     output_file = ''
+    config_dir = CONFIG_DIR
+    usage = 'python compiler.py -i <inputfile> -o <outputfile> [-c <config_dir>]'
     try:
-        opts, _ = getopt.getopt(argv, "hi:o:", ["ifile=", "ofile="])
+        opts, _ = getopt.getopt(argv, "hi:o:c:", ["ifile=", "ofile=", "config="])
     except getopt.GetoptError:
-        print('Usage: python compiler.py -i <inputfile> -o <outputfile>')
+        print('Usage: ' + usage)
         sys.exit(CLI_ERROR_CODE)
     for opt, arg in opts:
         if opt == '-h':
-            print('python compiler.py -i <inputfile> -o <outputfile>')
+            print(usage)
             sys.exit()
         elif opt in ("-i", "--ifile"):
             input_file = arg
         elif opt in ("-o", "--ofile"):
             output_file = arg
-    return input_file, output_file
+        elif opt in ("-c", "--config"):
+            config_dir = arg
+    return input_file, output_file, config_dir
 
 
 def clean_instructions(file):
@@ -50,77 +126,101 @@ def clean_instructions(file):
     return instructions
 
 
+def insert(word, field, value):
+    shift, bits = field
+    return word | ((value & ((1 << bits) - 1)) << shift)
+
+
 def get_binary(instructions):
     binary_instr = []
     for instr in instructions:
         mnemonic = instr[0]
-        opcode = isa[mnemonic]['opcode']
-
-        if mnemonic == 'WRITE_MEM':
-            src = validate_src(instr[1])
-            addr = validate_addr(instr[2])
-            num_cl = validate_cache_line(instr[3])
-            start_cl = validate_cache_line(instr[4])
-            qos = validate_qos(instr[5])
-            bin_str = opcode + src + addr + num_cl + start_cl + qos
-            binary_instr.append(bin_str)
-
-        elif mnemonic == 'READ_MEM':
-            src = validate_src(instr[1])
-            addr = validate_addr(instr[2])
-            size = validate_cache_line(instr[3])
-            qos = validate_qos(instr[4])
-            relleno = '0' * 8
-            bin_str = opcode + src + addr + size + relleno + qos
-            binary_instr.append(bin_str)
-
-        elif mnemonic == 'BROADCAST_INVALIDATE':
-            src = validate_src(instr[1])
-            cache_line = validate_cache_line(instr[2])
-            qos = validate_qos(instr[3])
-            relleno1 = '0' * 8
-            relleno2 = '0' * 16
-            bin_str = opcode + src + relleno1 + cache_line + relleno2 + qos
-            binary_instr.append(bin_str)
-
-        else:
+        if mnemonic not in isa:
             raise Exception(f"Instrucción no válida: {mnemonic}")
+        opcode, operands = isa[mnemonic]
+        if len(instr) != len(operands) + 1:
+            raise Exception(f"{mnemonic} espera {len(operands)} operandos, tiene {len(instr) - 1}")
+
+        word = insert(0, OPCODE, opcode)
+        values = {}
+        for (kind, field), value in zip(operands, instr[1:]):
+            values[kind] = VALIDATORS[kind](value)
+            word = insert(word, field, values[kind])
+        validate_range(values)
+        binary_instr.append(bin(word)[2:].zfill(INSTRUCTION_BITS))
     return binary_instr
 
 
-def to_bin(value, bits):
-    num = int(value, 0)
-    return bin(num & (2**bits - 1))[2:].zfill(bits)
-
-
 def validate_src(value):
     num = int(value, 0)
     if num < 0 or num > MAX_SRC:
         raise Exception(f"SRC inválido: {value} (debe estar entre 0 y {MAX_SRC})")
-    return to_bin(value, SRC_SIZE)
+    return num
 
 
 def validate_addr(value):
     num = int(value, 0)
-    if num % 4 != 0:
-        raise Exception(f"Dirección {value} no está alineada a 4 bytes")
-    if num < 0 or num >= MAX_ADDR:
-        raise Exception(f"Dirección {value} fuera del rango de memoria compartida")
-    return to_bin(value, ADDR_SIZE)
+    if num % BLOCK_WORDS != 0:
+        raise Exception(f"Dirección no alineada a {BLOCK_WORDS} palabras: {value}")
+    if num < 0 or num >= geometry.memory_words:
+        raise Exception(f"Dirección fuera de rango: {value}")
+    return num
 
 
-def validate_cache_line(value):
+def validate_start_line(value):
     num = int(value, 0)
-    if num < 0 or num >= MAX_CACHE_LINE:
-        raise Exception(f"Línea de caché {value} fuera de rango [0-{MAX_CACHE_LINE - 1}]")
-    return to_bin(value, CACHE_LINE_SIZE)
+    if num < 0 or num >= geometry.cache_block_limit():
+        raise Exception(f"Línea de caché fuera de rango: {value}")
+    return num
+
+
+def validate_cache_frame(value):
+    num = int(value, 0)
+    if num < 0 or num >= geometry.cache_frame_limit():
+        raise Exception(f"Frame de caché fuera de rango: {value}")
+    return num
+
+
+def validate_line_count(value):
+    num = int(value, 0)
+    if num < 0 or num > min(geometry.cache_block_limit(), field_max(LINES)):
+        raise Exception(f"Cantidad de líneas fuera de rango: {value}")
+    return num
+
+
+def validate_read_size(value):
+    num = int(value, 0)
+    if num < 0 or num > field_max(LINES):
+        raise Exception(f"Tamaño de lectura fuera de rango: {value}")
+    return num
+
+
+def validate_range(values):
+    # Como Compiler::validate_range: el acceso entero, no solo ADDR, debe caber en la memoria
+    if 'addr' not in values:
+        return
+    size = values.get('line_count', 0) * BLOCK_SIZE + values.get('read_size', 0)
+    if values['addr'] * WORD_BYTES + size > geometry.memory_words * WORD_BYTES:
+        raise Exception(f"Acceso fuera de rango: {size} bytes desde la palabra {values['addr']} "
+                        f"pasan de memory_words ({geometry.memory_words})")
 
 
 def validate_qos(value):
     num = int(value, 0)
     if num < 0 or num > MAX_QOS:
         raise Exception(f"Valor de QoS {value} fuera de rango [0-{MAX_QOS}]")
-    return to_bin(value, QOS_SIZE)
+    return num
+
+
+VALIDATORS = {
+    'src': validate_src,
+    'addr': validate_addr,
+    'line_count': validate_line_count,
+    'read_size': validate_read_size,
+    'start_line': validate_start_line,
+    'cache_frame': validate_cache_frame,
+    'qos': validate_qos,
+}
 
 
 def write_binary(instructions, output_file):
@@ -131,9 +231,10 @@ def write_binary(instructions, output_file):
 
 if __name__ == "__main__":
     try:
-        input_file, output_file = get_args(sys.argv[1:])
+        input_file, output_file, config_dir = get_args(sys.argv[1:])
         if not input_file or not output_file:
             raise Exception("Missing input or output file.")
+        geometry = Geometry.load(config_dir)
         with open(input_file, 'r') as f:
             instr = clean_instructions(f)
         bin_instr = get_binary(instr)
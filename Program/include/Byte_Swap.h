@@ -0,0 +1,21 @@
+#ifndef BYTE_SWAP_H
+#define BYTE_SWAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Copia @p words palabras de 32 bits de @p src a @p dst entre orden nativo y big-endian.
+ *
+ * Es la conversión entre las palabras de SharedMemory (orden nativo) y los
+ * bloques big-endian de los Message, en ambos sentidos: en una máquina
+ * little-endian invierte los bytes de cada palabra y en una big-endian copia. Usa AVX2 o SSSE3 si
+ * la CPU los tiene (se decide una vez, al primer uso) y un bucle portable si
+ * no. @p src y @p dst no deben solaparse y no necesitan estar alineados.
+ */
+void bswap32_copy(const void* src, void* dst, size_t words);
+
+/** @brief Nombre del kernel elegido para esta CPU ("avx2", "ssse3" o "scalar"). */
+const char* bswap32_kernel_name();
+
+#endif // BYTE_SWAP_H
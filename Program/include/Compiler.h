@@ -3,8 +3,25 @@
 #define COMPILER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <fstream>
+#include <istream>
+#include <ostream>
+#include "Geometry.h"
+#include "Instruction_Format.h"
+#include "Object_Format.h"
+
+/**
+ * @struct Symbol
+ * @brief Símbolo del ensamblador: una constante de .equ o la variable de un .repeat.
+ */
+struct Symbol {
+    std::string name;   /**< Nombre */
+    int64_t     value;  /**< Valor actual */
+};
+
+/** @brief Símbolos visibles; se buscan desde el final, así los internos tapan a los externos. */
+using SymbolTable = std::vector<Symbol>;
 
 /**
  * @class Compiler
@@ -13,62 +30,177 @@
 class Compiler {
 public:
     /**
-     * @brief Convierte un valor entero a una cadena binaria de longitud fija.
-     * @param value Valor entero a convertir.
-     * @param bits  Número de bits deseado.
-     * @return Cadena binaria.
+     * @brief Fija la geometría contra la que se validan direcciones y líneas.
+     * @param geometry Geometría cargada de config/ (por defecto, la de Geometry{}).
+     */
+    static void set_geometry(const Geometry& geometry);
+
+    /**
+     * @brief Lee un entero como std::stoi con base 0: 0x hexadecimal, 0 octal, si no decimal.
+     * @param value Token sin espacios.
+     * @return Valor leído (puede ser negativo; los validadores lo rechazan).
+     * @throws std::invalid_argument si el token no es un número completo o no cabe en 64 bits.
+     */
+    static int64_t parse_number(std::string_view value);
+
+    /**
+     * @brief Valida el campo SRC.
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
+     */
+    static uint64_t validate_src(int64_t value, std::string_view text);
+
+    /**
+     * @brief Valida la dirección (alineada a bloque y dentro de la memoria).
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
      */
-    static std::string to_bin(int value, int bits);
+    static uint64_t validate_addr(int64_t value, std::string_view text);
 
     /**
-     * @brief Valida y convierte el campo SRC a binario.
-     * @param value Cadena con el valor a validar.
-     * @return Cadena binaria de tamaño SRC.
+     * @brief Valida la primera línea de caché de un WRITE_MEM (índice de bloque de 16 bytes).
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
      */
-    static std::string validate_src(const std::string& value);
+    static uint64_t validate_start_line(int64_t value, std::string_view text);
 
     /**
-     * @brief Valida y convierte la dirección a binario.
-     * @param value Cadena con el valor a validar.
-     * @return Cadena binaria de tamaño ADDR.
+     * @brief Valida la línea de un BROADCAST_INVALIDATE (frame del caché: set * ways + way).
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
      */
-    static std::string validate_addr(const std::string& value);
+    static uint64_t validate_cache_line(int64_t value, std::string_view text);
 
     /**
-     * @brief Valida y convierte un número de línea de caché a binario.
-     * @param value Cadena con el valor a validar.
-     * @return Cadena binaria de tamaño CACHE_LINE.
+     * @brief Valida una cantidad de líneas de caché (WRITE_MEM).
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
      */
-    static std::string validate_cache_line(const std::string& value);
+    static uint64_t validate_line_count(int64_t value, std::string_view text);
 
     /**
-     * @brief Valida y convierte el valor de QoS a binario.
-     * @param value Cadena con el valor a validar.
-     * @return Cadena binaria de tamaño QoS.
+     * @brief Valida el tamaño en bytes de un READ_MEM.
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
      */
-    static std::string validate_qos(const std::string& value);
+    static uint64_t validate_size(int64_t value, std::string_view text);
 
     /**
-     * @brief Limpia y tokeniza instrucciones desde un flujo de entrada.
-     * @param file Flujo de archivo de entrada.
-     * @return Vector de instrucciones tokenizadas.
+     * @brief Valida el valor de QoS.
+     * @param value Valor del operando, ya evaluado.
+     * @param text  Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
      */
-    static std::vector<std::vector<std::string>> clean_instructions(std::ifstream& file);
+    static uint64_t validate_qos(int64_t value, std::string_view text);
 
     /**
-     * @brief Convierte instrucciones tokenizadas a su representación binaria.
-     * @param instructions Vector de instrucciones tokenizadas.
-     * @return Vector de cadenas binarias.
+     * @brief Valida un operando con la regla que le corresponde.
+     * @param operand Tipo de operando (de InstructionFormat::LAYOUTS).
+     * @param value   Valor del operando, ya evaluado.
+     * @param text    Operando tal como se escribió, para el mensaje de error.
+     * @return Valor del campo.
+     * @throws std::invalid_argument si el valor está fuera de rango.
      */
-    static std::vector<std::string> get_binary(const std::vector<std::vector<std::string>>& instructions);
+    static uint64_t validate_operand(Operand operand, int64_t value, std::string_view text);
+
+    /**
+     * @brief Valida que el acceso completo de una instrucción quepa en la memoria compartida.
+     *
+     * validate_addr() solo mira la primera palabra: WRITE_MEM escribe
+     * LINE_COUNT bloques de BLOCK_WORDS palabras y READ_MEM lee SIZE bytes a
+     * partir de ADDR, y ninguno de los dos puede pasar de memory_words.
+     *
+     * @param layout Formato de la instrucción.
+     * @param values Operandos ya validados, en el orden de layout.operands.
+     * @throws std::invalid_argument si el acceso pasa del final de la memoria.
+     */
+    static void validate_range(const InstructionLayout& layout,
+                               const std::array<uint64_t, InstructionLayout::MAX_OPERANDS>& values);
+
+    /**
+     * @brief Evalúa un operando: un número o una expresión con símbolos.
+     *
+     * Acepta + - * / % con la precedencia usual, signo, paréntesis, números
+     * (como parse_number) y símbolos de @p symbols. Un número solo no pasa
+     * por el parser de expresiones.
+     *
+     * @param expression Operando, por ejemplo "BASE+i*16" o "(BASE + i * 16)".
+     * @param symbols    Símbolos visibles.
+     * @throws std::invalid_argument si la expresión es inválida, usa un símbolo
+     *         no definido, divide por cero o desborda.
+     */
+    static int64_t evaluate(std::string_view expression, const SymbolTable& symbols);
+
+    /**
+     * @brief Ensambla una línea: separa tokens, evalúa y valida los operandos y codifica.
+     *
+     * Los tokens son vistas sobre la línea (separados por espacios o comas,
+     * salvo dentro de paréntesis, y lo que sigue a ';' es comentario), así que
+     * no se reserva memoria salvo para armar un mensaje de error. El formato
+     * sale de InstructionFormat, la misma tabla con la que el PE decodifica.
+     *
+     * @param line    Línea del archivo de ensamblador (sin directivas).
+     * @param symbols Símbolos que pueden usar los operandos.
+     * @param empty   Queda en true si la línea no tiene instrucción (vacía o solo comentario).
+     * @return Instrucción codificada, o 0 si @p empty.
+     * @throws std::invalid_argument si la instrucción o un operando es inválido.
+     */
+    static uint64_t assemble_line(std::string_view line, const SymbolTable& symbols, bool& empty);
+
+    /**
+     * @brief Ensambla un flujo completo en una sola pasada, línea por línea.
+     *
+     * Además de instrucciones acepta directivas que se expanden al compilar:
+     *
+     *     .equ NOMBRE expr        define (o redefine) una constante
+     *     .repeat N [VAR]         repite el bloque N veces, con VAR = 0..N-1
+     *     .endr                   cierra el .repeat (se pueden anidar)
+     *
+     * Las instrucciones salen a @p output de a bloques a medida que se leen,
+     * así que la memoria usada no depende del tamaño del archivo. En
+     * ObjectEncoding::PACKED se escribe la cabecera de ObjectFormat y se
+     * completa su COUNT al final, por lo que @p output debe admitir seekp.
+     *
+     * @param input    Archivo de ensamblador.
+     * @param output   Destino del objeto (abierto en modo binario).
+     * @param source   Nombre del archivo, para los mensajes de error.
+     * @param pe_id    PE que se anota en la cabecera.
+     * @param encoding Objeto binario o, para inspeccionarlo, texto '0'/'1'.
+     * @return Cantidad de instrucciones ensambladas.
+     * @throws std::invalid_argument con "source:línea: motivo" en la primera línea inválida
+     *         (dentro de un .repeat, también la iteración).
+     * @throws std::runtime_error si no se pudo escribir @p output.
+     */
+    static size_t assemble(std::istream& input, std::ostream& output, const std::string& source,
+                           uint32_t pe_id = ObjectFormat::ANY_PE,
+                           ObjectEncoding encoding = ObjectEncoding::PACKED);
 
     /**
      * @brief Compila todos los archivos de instrucciones en `input_dir` y genera `.bin` en `output_dir`.
+     *
+     * Los `.bin` están en el formato de ObjectFormat; el PE de la cabecera
+     * sale del nombre del archivo (pe_<n>.txt).
+     *
+     * Los archivos se compilan en paralelo, uno por hilo a la vez, con tantos
+     * hilos como núcleos. Cada archivo produce siempre el mismo binario; el
+     * progreso se informa al terminar cada uno y al final el tiempo total.
+     *
      * @param input_dir  Directorio de archivos de entrada.
      * @param output_dir Directorio donde colocar los binarios.
+     * @throws std::invalid_argument con la primera instrucción inválida (por orden de archivo),
+     *         después de compilar los demás.
      */
-    void compile_directory(const std::string& input_dir,
-                           const std::string& output_dir) const;
+    static void compile_directory(const std::string& input_dir,
+                                  const std::string& output_dir);
+
+private:
+    static Geometry geometry_;  /**< Límites de memoria y caché vigentes */
 };
 
 #endif // COMPILER_H
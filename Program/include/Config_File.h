@@ -0,0 +1,57 @@
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class ConfigFile
+ * @brief Lector de archivos de configuración con líneas "clave: valor".
+ *
+ * Sigue el mismo formato que config/qos.txt. Todo lo que sigue a '#' es
+ * comentario y las líneas vacías se ignoran. Si el archivo no existe, todas
+ * las consultas devuelven el valor por defecto indicado.
+ */
+class ConfigFile {
+public:
+    /**
+     * @brief Carga el archivo indicado.
+     * @param path Ruta al archivo de configuración.
+     */
+    explicit ConfigFile(const std::string& path);
+
+    /** @brief Devuelve true si el archivo se pudo abrir. */
+    bool is_loaded() const;
+
+    /** @brief Devuelve true si la clave existe en el archivo. */
+    bool has(const std::string& key) const;
+
+    /**
+     * @brief Lee un entero (acepta prefijo 0x).
+     * @throws std::invalid_argument si el valor no es un entero válido.
+     */
+    int64_t get_int(const std::string& key, int64_t fallback) const;
+
+    /**
+     * @brief Lee un número real.
+     * @throws std::invalid_argument si el valor no es un número válido.
+     */
+    double get_double(const std::string& key, double fallback) const;
+
+    /** @brief Lee el valor tal cual, sin espacios a los lados. */
+    std::string get_string(const std::string& key, const std::string& fallback) const;
+
+    /** @brief Lee un booleano (1/0, true/false, on/off, yes/no). */
+    bool get_bool(const std::string& key, bool fallback) const;
+
+    /** @brief Ruta del archivo cargado. */
+    const std::string& path() const;
+
+private:
+    std::string path_;                                      /**< Ruta del archivo. */
+    bool loaded_{false};                                    /**< true si se pudo abrir. */
+    std::unordered_map<std::string, std::string> values_;   /**< Pares clave -> valor. */
+};
+
+#endif // CONFIG_FILE_H
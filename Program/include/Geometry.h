@@ -0,0 +1,166 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct Geometry
+ * @brief Tamaños de memoria y caché que comparten el generador, el compilador y el simulador.
+ *
+ * Es la única fuente de estos límites: memory_words viene de config/memory.txt
+ * y sets/ways/line_size de config/cache.txt, con los mismos valores por
+ * defecto que MemoryConfig y CacheConfig. Los límites de caché que ve el
+ * ensamblador se recortan al ancho de los campos de la instrucción; la memoria
+ * no puede pasar de lo que direcciona ADDR.
+ */
+struct Geometry {
+    static constexpr uint32_t WORD_BYTES   = 4;     /**< Bytes por palabra de memoria */
+    static constexpr uint32_t BLOCK_SIZE   = 16;    /**< Bytes por bloque de datos de un Message */
+    static constexpr uint32_t BLOCK_WORDS  = BLOCK_SIZE / WORD_BYTES;   /**< Palabras por bloque */
+
+    static constexpr uint32_t ADDRESS_FIELD_BITS = 37;  /**< Campo ADDR de la instrucción */
+    static constexpr uint32_t LINE_FIELD_BITS    = 8;   /**< Campos de línea/tamaño de la instrucción */
+
+    static constexpr uint32_t DEFAULT_MEMORY_WORDS = 4096;  /**< Palabras de SharedMemory */
+    static constexpr uint32_t DEFAULT_SETS         = 32;    /**< Conjuntos del caché local */
+    static constexpr uint32_t DEFAULT_WAYS         = 4;     /**< Vías del caché local */
+    static constexpr uint32_t DEFAULT_LINE_SIZE    = 16;    /**< Bytes por línea del caché local */
+
+    uint64_t memory_words{DEFAULT_MEMORY_WORDS};    /**< Palabras de 32 bits de SharedMemory */
+    uint32_t sets{DEFAULT_SETS};                    /**< Conjuntos del caché local */
+    uint32_t ways{DEFAULT_WAYS};                    /**< Vías del caché local */
+    uint32_t line_size{DEFAULT_LINE_SIZE};          /**< Bytes por línea del caché local */
+
+    /** @brief Bloques de 16 bytes de un caché local (frames si line_size es 16). */
+    constexpr uint32_t cache_blocks() const {
+        return sets * ways * (line_size / BLOCK_SIZE);
+    }
+
+    /** @brief Frames (set * ways + way) de un caché local. */
+    constexpr uint32_t cache_frames() const {
+        return sets * ways;
+    }
+
+    /** @brief Palabras que direcciona el campo ADDR; memory_words no puede pasar de aquí. */
+    static constexpr uint64_t max_memory_words() {
+        return uint64_t{1} << ADDRESS_FIELD_BITS;
+    }
+
+    /**
+     * @brief Primera dirección (palabra) inválida para el ensamblador.
+     *
+     * validate() garantiza que toda la memoria cabe en el campo ADDR.
+     */
+    constexpr uint64_t address_limit() const {
+        return memory_words;
+    }
+
+    /**
+     * @brief Primer índice de bloque de caché inválido para el ensamblador.
+     *
+     * Límite de START_LINE y LINE_COUNT de WRITE_MEM, que cuentan bloques de 16 bytes.
+     */
+    constexpr uint32_t cache_block_limit() const {
+        return cache_blocks() < (1u << LINE_FIELD_BITS) ? cache_blocks() : (1u << LINE_FIELD_BITS);
+    }
+
+    /**
+     * @brief Primer frame de caché inválido para el ensamblador.
+     *
+     * Límite de CACHE_LINE de BROADCAST_INVALIDATE, que el caché toma como frame.
+     */
+    constexpr uint32_t cache_frame_limit() const {
+        return cache_frames() < (1u << LINE_FIELD_BITS) ? cache_frames() : (1u << LINE_FIELD_BITS);
+    }
+
+    /** @brief Mayor valor que cabe en un campo de línea/tamaño (cantidad de líneas de WRITE_MEM). */
+    static constexpr uint32_t max_field_value() {
+        return (1u << LINE_FIELD_BITS) - 1;
+    }
+
+    /** @brief Mayor tamaño de READ_MEM que cabe en su campo, en bloques completos. */
+    static constexpr uint32_t max_read_size() {
+        return max_field_value() / BLOCK_SIZE * BLOCK_SIZE;
+    }
+
+    /**
+     * @brief Lee memory_words de @p memory_file y sets/ways/line_size de @p cache_file.
+     *
+     * Las claves ausentes (o los archivos que no existan) conservan el valor
+     * por defecto.
+     *
+     * @throws std::invalid_argument si la geometría no es válida.
+     */
+    static Geometry load(const std::string& memory_file = "config/memory.txt",
+                         const std::string& cache_file  = "config/cache.txt");
+
+    /**
+     * @brief Comprueba que la geometría sea usable.
+     * @throws std::invalid_argument con la regla que no se cumple.
+     */
+    void validate() const;
+};
+
+/* ------------------------------------- Line Geometry ----------------------------------------- */
+
+/**
+ * @struct FixedLineGeometry
+ * @brief Cálculos de línea con el tamaño conocido en compilación.
+ *
+ * Con LineSize constante, los desplazamientos y las copias de una línea se
+ * resuelven en compilación (shift y bucles de longitud fija). Tiene la misma
+ * interfaz que LineGeometry para que un mismo template sirva a los dos.
+ */
+template <uint32_t LineSize>
+struct FixedLineGeometry {
+    static_assert(LineSize >= Geometry::BLOCK_SIZE && (LineSize & (LineSize - 1)) == 0,
+                  "line_size debe ser potencia de 2 y al menos 16");
+
+    static constexpr uint32_t size()   { return LineSize; }
+    static constexpr uint32_t words()  { return LineSize / Geometry::WORD_BYTES; }
+    static constexpr uint32_t blocks() { return LineSize / Geometry::BLOCK_SIZE; }
+
+    /** @brief Línea que contiene la palabra @p word. */
+    static constexpr uint64_t line_of_word(uint64_t word) { return word / words(); }
+
+    /** @brief Primera palabra de la línea @p line. */
+    static constexpr uint64_t word_of_line(uint64_t line) { return line * words(); }
+};
+
+/**
+ * @struct LineGeometry
+ * @brief Cálculos de línea con el tamaño en tiempo de ejecución (cualquier potencia de 2).
+ */
+struct LineGeometry {
+    uint32_t line_size;     /**< Bytes por línea */
+
+    constexpr uint32_t size()   const { return line_size; }
+    constexpr uint32_t words()  const { return line_size / Geometry::WORD_BYTES; }
+    constexpr uint32_t blocks() const { return line_size / Geometry::BLOCK_SIZE; }
+
+    constexpr uint64_t line_of_word(uint64_t word) const { return word / words(); }
+    constexpr uint64_t word_of_line(uint64_t line) const { return line * words(); }
+};
+
+/**
+ * @brief Llama a @p fn con la geometría de línea más rápida para @p line_size.
+ *
+ * Los tamaños comunes (16, 32 y 64 bytes) usan FixedLineGeometry; el resto
+ * cae en LineGeometry.
+ *
+ * @return Lo que devuelva @p fn.
+ */
+template <typename Fn>
+decltype(auto) with_line_geometry(uint32_t line_size, Fn&& fn) {
+    switch (line_size) {
+        case 16: return fn(FixedLineGeometry<16>{});
+        case 32: return fn(FixedLineGeometry<32>{});
+        case 64: return fn(FixedLineGeometry<64>{});
+        default: return fn(LineGeometry{line_size});
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif // GEOMETRY_H
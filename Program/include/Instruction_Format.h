@@ -0,0 +1,232 @@
+#ifndef INSTRUCTION_FORMAT_H
+#define INSTRUCTION_FORMAT_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "Geometry.h"
+#include "Message.h"
+
+/**
+ * @struct BitField
+ * @brief Campo de bits de una instrucción: posición del bit menos significativo y ancho.
+ *
+ * Un campo de ancho 0 extrae siempre 0; la tabla de decodificación lo usa
+ * para los campos que una operación no tiene, sin ramas.
+ */
+struct BitField {
+    uint32_t shift{0};  /**< Bit menos significativo */
+    uint32_t bits{0};   /**< Ancho en bits */
+
+    constexpr uint64_t mask() const { return (uint64_t{1} << bits) - 1; }
+    constexpr uint64_t extract(uint64_t word) const { return (word >> shift) & mask(); }
+    constexpr uint64_t insert(uint64_t word, uint64_t value) const { return word | ((value & mask()) << shift); }
+};
+
+/**
+ * @enum Operand
+ * @brief Operandos del ensamblador; cada uno se valida a su manera y va a un campo del Message.
+ *
+ * El valor es también el índice del operando en DecodedInstruction::values.
+ */
+enum class Operand : uint8_t {
+    SRC,            /**< PE origen */
+    ADDRESS,        /**< Dirección en palabras, alineada a bloque */
+    READ_SIZE,      /**< Bytes de un READ_MEM */
+    LINE_COUNT,     /**< Bloques de caché de un WRITE_MEM */
+    START_LINE,     /**< Primer bloque de caché de un WRITE_MEM */
+    CACHE_LINE,     /**< Bloque de caché a invalidar */
+    QOS,            /**< QoS codificado (el PE usa el suyo, de config/qos.txt) */
+    COUNT           /**< Cantidad de operandos */
+};
+
+/** @brief Operando del ensamblador y el campo de bits donde se codifica. */
+struct OperandSlot {
+    Operand  operand;
+    BitField field;
+};
+
+/**
+ * @struct InstructionLayout
+ * @brief Formato de una instrucción: mnemónico, opcode y operandos en orden de ensamblador.
+ */
+struct InstructionLayout {
+    static constexpr size_t MAX_OPERANDS = 5;
+
+    std::string_view                          mnemonic;         /**< Nombre en el ensamblador */
+    Operation                                 operation;        /**< Operación del Message */
+    uint32_t                                  opcode;           /**< Valor del campo OPCODE */
+    size_t                                    operand_count;    /**< Operandos usados de @ref operands */
+    std::array<OperandSlot, MAX_OPERANDS>     operands;         /**< En el orden en que se escriben */
+};
+
+/**
+ * @struct DecodedInstruction
+ * @brief Instrucción decodificada: la operación y el valor de cada operando (0 si no lo tiene).
+ */
+struct DecodedInstruction {
+    Operation                                                   operation{Operation::UNDEFINED};
+    std::array<uint64_t, static_cast<size_t>(Operand::COUNT)>   values{};
+
+    constexpr uint64_t get(Operand operand) const { return values[static_cast<size_t>(operand)]; }
+};
+
+/**
+ * @struct InstructionFormat
+ * @brief Única tabla de campos de la ISA; de ella salen el codificador y el decodificador.
+ *
+ * Las instrucciones ocupan 64 bits:
+ *
+ *     63-62   61-57   56-20         19-12         11-4          3-0
+ *     OPCODE  SRC     ADDR          LINES/SIZE    START_LINE    QOS
+ *
+ * BROADCAST_INVALIDATE lleva CACHE_LINE en 27-20 y deja en cero el resto
+ * de ADDR, LINES y START_LINE.
+ *
+ * Compiler::assemble_line codifica con encode() y PE::convert_to_message
+ * decodifica con decode(), que indexa por opcode una tabla armada en tiempo
+ * de compilación y extrae todos los campos sin ramas. Los static_assert del
+ * final comprueban que los campos no se pisan y que decode(encode(x)) == x.
+ * Compiler/python/compiler.py copia esta tabla.
+ */
+struct InstructionFormat {
+    static constexpr uint32_t BITS = 64;                    /**< Bits de una instrucción */
+
+    static constexpr BitField OPCODE    {62, 2};
+    static constexpr BitField SRC       {57, 5};
+    static constexpr BitField ADDR      {20, Geometry::ADDRESS_FIELD_BITS};
+    static constexpr BitField LINES     {12, Geometry::LINE_FIELD_BITS};   /**< LINE_COUNT o READ_SIZE */
+    static constexpr BitField START     {4,  Geometry::LINE_FIELD_BITS};
+    static constexpr BitField CACHE_LINE{20, Geometry::LINE_FIELD_BITS};
+    static constexpr BitField QOS       {0,  4};
+
+    /** @brief Formatos de la ISA, uno por opcode. */
+    static constexpr std::array<InstructionLayout, 3> LAYOUTS{{
+        {"WRITE_MEM", Operation::WRITE_MEM, 0b00, 5,
+            {{{Operand::SRC, SRC}, {Operand::ADDRESS, ADDR}, {Operand::LINE_COUNT, LINES},
+              {Operand::START_LINE, START}, {Operand::QOS, QOS}}}},
+        {"READ_MEM", Operation::READ_MEM, 0b01, 4,
+            {{{Operand::SRC, SRC}, {Operand::ADDRESS, ADDR}, {Operand::READ_SIZE, LINES},
+              {Operand::QOS, QOS}}}},
+        {"BROADCAST_INVALIDATE", Operation::BROADCAST_INVALIDATE, 0b10, 3,
+            {{{Operand::SRC, SRC}, {Operand::CACHE_LINE, CACHE_LINE}, {Operand::QOS, QOS}}}},
+    }};
+
+    /** @brief Formato del mnemónico, o nullptr si no existe. */
+    static constexpr const InstructionLayout* find(std::string_view mnemonic) {
+        for (const auto& layout : LAYOUTS) {
+            if (layout.mnemonic == mnemonic) return &layout;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Codifica una instrucción; los valores ya deben estar validados.
+     * @param layout Formato de la instrucción.
+     * @param values Un valor por operando, en el orden de layout.operands.
+     */
+    static constexpr uint64_t encode(const InstructionLayout& layout,
+                                     const std::array<uint64_t, InstructionLayout::MAX_OPERANDS>& values) {
+        uint64_t word = OPCODE.insert(0, layout.opcode);
+        for (size_t i = 0; i < layout.operand_count; ++i) {
+            word = layout.operands[i].field.insert(word, values[i]);
+        }
+        return word;
+    }
+
+    /** @brief true si @p word no usa bits por encima de BITS. */
+    static constexpr bool fits(uint64_t word) {
+        return BITS >= 64 || (word >> (BITS % 64)) == 0;
+    }
+
+    /** @brief Opcodes posibles (tamaño de la tabla de decodificación). */
+    static constexpr size_t OPCODES = size_t{1} << OPCODE.bits;
+
+    /** @brief Decodifica una instrucción: una consulta a la tabla y un shift+mask por operando. */
+    static constexpr DecodedInstruction decode(uint64_t word);
+};
+
+/**
+ * @struct DecodeEntry
+ * @brief Fila de la tabla de decodificación: operación y campo de cada operando.
+ */
+struct DecodeEntry {
+    Operation                                                   operation{Operation::UNDEFINED};
+    std::array<BitField, static_cast<size_t>(Operand::COUNT)>   fields{};
+};
+
+/** @brief Arma, desde InstructionFormat::LAYOUTS, la fila de cada opcode. */
+constexpr std::array<DecodeEntry, InstructionFormat::OPCODES> build_decode_table() {
+    std::array<DecodeEntry, InstructionFormat::OPCODES> table{};
+    // Los opcodes sin formato decodifican como UNDEFINED, conservando SRC
+    for (auto& entry : table) {
+        entry.fields[static_cast<size_t>(Operand::SRC)] = InstructionFormat::SRC;
+    }
+    for (const auto& layout : InstructionFormat::LAYOUTS) {
+        DecodeEntry& entry = table[layout.opcode];
+        entry.operation = layout.operation;
+        for (size_t i = 0; i < layout.operand_count; ++i) {
+            entry.fields[static_cast<size_t>(layout.operands[i].operand)] = layout.operands[i].field;
+        }
+    }
+    return table;
+}
+
+/** @brief Tabla de decodificación, indexada por opcode. */
+inline constexpr std::array<DecodeEntry, InstructionFormat::OPCODES> DECODE_TABLE = build_decode_table();
+
+constexpr DecodedInstruction InstructionFormat::decode(uint64_t word) {
+    const DecodeEntry& entry = DECODE_TABLE[OPCODE.extract(word)];
+    DecodedInstruction decoded;
+    decoded.operation = entry.operation;
+    for (size_t i = 0; i < decoded.values.size(); ++i) {
+        decoded.values[i] = entry.fields[i].extract(word);
+    }
+    return decoded;
+}
+
+/* ------------------------------------ Compile-time checks ------------------------------------ */
+
+/** @brief Cada formato cabe en BITS, sus campos no se pisan y sus opcodes son distintos. */
+constexpr bool instruction_layouts_valid() {
+    using F = InstructionFormat;
+    if (F::OPCODE.shift + F::OPCODE.bits != F::BITS) return false;
+    for (size_t a = 0; a < F::LAYOUTS.size(); ++a) {
+        const InstructionLayout& layout = F::LAYOUTS[a];
+        if (layout.opcode >= F::OPCODES || layout.operand_count > InstructionLayout::MAX_OPERANDS) return false;
+        for (size_t b = a + 1; b < F::LAYOUTS.size(); ++b) {
+            if (F::LAYOUTS[b].opcode == layout.opcode) return false;
+        }
+        uint64_t used = F::OPCODE.mask() << F::OPCODE.shift;
+        for (size_t i = 0; i < layout.operand_count; ++i) {
+            const BitField& f = layout.operands[i].field;
+            uint64_t bits = f.mask() << f.shift;
+            if (f.bits == 0 || f.shift + f.bits > F::BITS || (used & bits) != 0) return false;
+            used |= bits;
+        }
+    }
+    return true;
+}
+
+/** @brief decode(encode(x)) devuelve la operación y los operandos de x, con valores cerca del máximo. */
+constexpr bool instruction_round_trips() {
+    for (const auto& layout : InstructionFormat::LAYOUTS) {
+        std::array<uint64_t, InstructionLayout::MAX_OPERANDS> values{};
+        for (size_t i = 0; i < layout.operand_count; ++i) {
+            values[i] = layout.operands[i].field.mask() - i;
+        }
+        DecodedInstruction decoded = InstructionFormat::decode(InstructionFormat::encode(layout, values));
+        if (decoded.operation != layout.operation) return false;
+        for (size_t i = 0; i < layout.operand_count; ++i) {
+            if (decoded.get(layout.operands[i].operand) != values[i]) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(instruction_layouts_valid(), "InstructionFormat: campos solapados o fuera de BITS");
+static_assert(instruction_round_trips(), "InstructionFormat: decode(encode(x)) no devuelve x");
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif // INSTRUCTION_FORMAT_H
@@ -3,19 +3,20 @@
 
 #include <string>
 #include <random>
+#include "Geometry.h"
 
 class InstructionGenerator {
 public:
-    InstructionGenerator(int num_pes, int instructions_per_file = 10);
+    InstructionGenerator(int num_pes, int instructions_per_file = 10,
+                         const Geometry& geometry = Geometry{});
     void generate() const;
 
 private:
-    static constexpr int MEM_SIZE = 4096;
-    static constexpr int CACHE_LINES = 128;
     static constexpr int MAX_QOS = 3;
 
     int num_pes_;
     int instructions_per_file_;
+    Geometry geometry_;
     std::random_device rd_;
     mutable std::mt19937 rng_;
 
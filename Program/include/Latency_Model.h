@@ -0,0 +1,149 @@
+#ifndef LATENCY_MODEL_H
+#define LATENCY_MODEL_H
+
+#include <cstdint>
+#include <string>
+#include "Message.h"
+#include "components/Interconnect.h"
+
+/**
+ * @struct LatencyParams
+ * @brief Parámetros (en ciclos) del modelo de latencias del simulador.
+ *
+ * Los valores por defecto son los que el simulador usaba fijos en System.cpp;
+ * config/times.txt puede sobrescribir cualquiera de ellos por nombre.
+ */
+struct LatencyParams {
+    uint32_t fetch{3};                  /**< PE: fetch + decode de una instrucción */
+    uint32_t cache_read_per_line{4};    /**< PE: leer una línea de caché para WRITE_MEM */
+    uint32_t send{5};                   /**< PE: enviar el mensaje al Interconnect */
+    uint32_t queue_wait_per_unit{5};    /**< IC: espera en in_queue por (num_lines + size) */
+    double   response_scale{0.01};      /**< IC: fracción de la latencia de la petición que hereda la respuesta */
+    uint32_t read_mem_base{6};          /**< Memoria: READ cuesta (read_mem_base + size) * size */
+    uint32_t write_mem_base{8};         /**< Memoria: WRITE cuesta (write_mem_base + num_lines) * num_lines */
+    uint32_t inv_line{6};               /**< IC: generar un INV_LINE */
+    uint32_t inv_complete_per_pe{5};    /**< IC: recolectar el ACK de cada PE */
+    uint32_t inv_complete{5};           /**< IC: generar el INV_COMPLETE */
+    uint32_t response_receive{10};      /**< PE: sacar una respuesta del Interconnect */
+    uint32_t inv_ack{13};               /**< PE: invalidar la línea y enviar el INV_ACK */
+    uint32_t read_resp_per_byte{4};     /**< PE: escribir en caché cada byte de un READ_RESP */
+    uint32_t write_resp{5};             /**< PE: procesar un WRITE_RESP */
+    uint32_t inv_complete_resp{5};      /**< PE: procesar un INV_COMPLETE */
+    uint32_t snoop_per_pe{1};           /**< IC: consultar el estado de un caché */
+    uint32_t coherence_upgrade{3};      /**< IC: pasar la copia S del escritor a exclusiva */
+    uint32_t coherence_invalidate{4};   /**< IC: invalidar la copia de otro caché */
+    uint32_t coherence_downgrade{6};    /**< IC: bajar a S la copia E/M de otro caché */
+    uint32_t c2c_base{8};               /**< IC: reenviar un READ_MEM al caché de otro PE */
+    uint32_t c2c_per_line{4};           /**< IC: transferir cada línea desde ese caché */
+};
+
+/**
+ * @class LatencyModel
+ * @brief Calcula las latencias de cada etapa del camino de un mensaje.
+ *
+ * Reúne en un solo lugar las fórmulas de latencia del simulador. Los parámetros
+ * se cargan de config/times.txt al inicializar el System, por lo que se pueden
+ * calibrar contra hardware real sin recompilar.
+ */
+class LatencyModel {
+public:
+    /** @brief Construye el modelo con los parámetros por defecto. */
+    LatencyModel() = default;
+
+    /** @brief Construye el modelo con parámetros explícitos. */
+    explicit LatencyModel(const LatencyParams& params);
+
+    /**
+     * @brief Carga los parámetros desde un archivo "clave: valor".
+     *
+     * Las claves ausentes conservan su valor por defecto. Si el archivo no se
+     * puede abrir se avisa por consola y se usan todos los valores por defecto.
+     *
+     * @param filename Ruta al archivo (normalmente config/times.txt).
+     * @return Modelo configurado.
+     * @throws std::invalid_argument si algún valor no es numérico.
+     */
+    static LatencyModel load_from_file(const std::string& filename);
+
+    /** @brief Parámetros en uso. */
+    const LatencyParams& params() const;
+
+/* ------------------------------------------- PE ---------------------------------------------- */
+
+    /** @brief Latencia de fetch + decode de una instrucción. */
+    uint32_t instruction_fetch() const;
+
+    /** @brief Latencia de leer @p num_lines líneas de caché para un WRITE_MEM. */
+    uint32_t cache_read(uint32_t num_lines) const;
+
+    /** @brief Latencia de enviar un mensaje al Interconnect. */
+    uint32_t send_to_interconnect() const;
+
+    /** @brief Latencia de sacar una respuesta del Interconnect. */
+    uint32_t response_receive() const;
+
+    /** @brief Latencia de procesar un INV_LINE y devolver el INV_ACK. */
+    uint32_t inv_ack() const;
+
+    /** @brief Latencia de escribir en caché los datos de un READ_RESP de @p size bytes. */
+    uint32_t read_resp(uint32_t size) const;
+
+    /** @brief Latencia de procesar un WRITE_RESP. */
+    uint32_t write_resp() const;
+
+    /** @brief Latencia de procesar un INV_COMPLETE. */
+    uint32_t inv_complete_resp() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* --------------------------------------- Interconnect ---------------------------------------- */
+
+    /**
+     * @brief Latencia de espera en in_queue de una petición.
+     *
+     * Con FIFO es queue_wait_per_unit * (num_lines + size). Con PRIORITY ese valor
+     * se divide entre el QoS del mensaje (QoS 0 se trata como 1), en punto flotante.
+     *
+     * @param msg    Petición que sale de in_queue.
+     * @param scheme Esquema de arbitraje en uso.
+     */
+    uint32_t queue_wait(const Message& msg, ArbitScheme scheme) const;
+
+    /** @brief Parte de la latencia de una petición que hereda su respuesta. */
+    uint32_t response_share(uint32_t request_latency) const;
+
+    /** @brief Latencia de leer @p size bytes de SharedMemory (servicio de un banco). */
+    uint32_t memory_read(uint32_t size) const;
+
+    /** @brief Latencia de escribir @p num_lines líneas en SharedMemory (servicio de un banco). */
+    uint32_t memory_write(uint32_t num_lines) const;
+
+    /** @brief Latencia de generar un INV_LINE. */
+    uint32_t inv_line() const;
+
+    /** @brief Latencia base del INV_COMPLETE tras recolectar @p total_pes ACKs. */
+    uint32_t inv_complete_collect(uint32_t total_pes) const;
+
+    /** @brief Latencia de generar el INV_COMPLETE. */
+    uint32_t inv_complete() const;
+
+    /** @brief Latencia de las transacciones de coherencia (snoops, upgrades, etc.) de una petición. */
+    uint32_t coherence(const CoherenceStats& transactions) const;
+
+    /** @brief Latencia de servir @p num_lines líneas desde el caché de otro PE. */
+    uint32_t cache_to_cache(uint32_t num_lines) const;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ---------------------------------------- Testing -------------------------------------------- */
+
+    /** @brief Imprime en consola los parámetros en uso. */
+    void debug_print() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
+private:
+    LatencyParams params_;  /**< Parámetros del modelo. */
+};
+
+#endif // LATENCY_MODEL_H
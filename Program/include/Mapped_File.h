@@ -0,0 +1,109 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum Storage
+ * @brief Dónde viven los datos de SharedMemory y de los LocalCache.
+ */
+enum class Storage {
+    HEAP,   /**< En memoria del proceso; se vuelcan a disco al terminar */
+    MMAP    /**< Directamente sobre su archivo .bin mapeado con MappedFile */
+};
+
+/**
+ * @enum InitMode
+ * @brief Cómo se obtiene el contenido inicial de SharedMemory y de los LocalCache.
+ */
+enum class InitMode {
+    RANDOM, /**< Semilla de std::random_device; se vuelca el estado inicial */
+    SEED,   /**< Semilla fija de la configuración: corridas reproducibles */
+    IMAGE   /**< Imagen .bin guardada por la corrida anterior (si no existe, como SEED) */
+};
+
+/**
+ * @class MappedFile
+ * @brief Archivo binario mapeado en memoria (mmap compartido, lectura y escritura).
+ *
+ * Si el archivo ya existe con el tamaño pedido se reutiliza tal cual
+ * (arranque en caliente); si no, se crea con ese tamaño y su contenido
+ * queda en cero. Un archivo existente de otro tamaño nunca se trunca: se
+ * renombra a <path>.bak con un aviso antes de crear el nuevo. Los cambios sobre data() llegan al archivo sin
+ * copias: el sistema operativo los escribe por su cuenta y sync() fuerza la
+ * escritura. El archivo se desmapea y se cierra en el destructor.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Abre (o crea) @p path con @p size bytes y lo mapea.
+     * @throws std::runtime_error si no se puede apartar, abrir, redimensionar o mapear.
+     */
+    MappedFile(const std::string& path, size_t size);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /** @brief Inicio de la región mapeada (nullptr si no hay archivo). */
+    uint8_t* data() const { return data_; }
+
+    /** @brief Bytes mapeados. */
+    size_t size() const { return size_; }
+
+    /** @brief true si hay un archivo mapeado. */
+    bool is_open() const { return data_ != nullptr; }
+
+    /** @brief true si el archivo ya existía con este tamaño (su contenido es de una corrida anterior). */
+    bool reused() const { return reused_; }
+
+    /** @brief Ruta del archivo. */
+    const std::string& path() const { return path_; }
+
+    /**
+     * @brief Convierte "heap" o "mmap" en Storage.
+     * @throws std::invalid_argument si el nombre no es válido.
+     */
+    static Storage parse_storage(const std::string& name);
+
+    /** @brief Nombre de un Storage para logs y estadísticas. */
+    static const char* storage_to_string(Storage storage);
+
+    /**
+     * @brief Convierte "random", "seed" o "image" en InitMode.
+     * @throws std::invalid_argument si el nombre no es válido.
+     */
+    static InitMode parse_init(const std::string& name);
+
+    /**
+     * @brief Escribe a disco las páginas modificadas (msync síncrono).
+     * @throws std::runtime_error si msync falla.
+     */
+    void sync() const;
+
+    /**
+     * @brief Descarta el contenido del archivo: queda disperso y en cero, con
+     *        el mismo tamaño y el mismo mapeo. reused() pasa a ser false.
+     * @throws std::runtime_error si ftruncate falla.
+     */
+    void discard();
+
+private:
+    /** @brief Desmapea y cierra el archivo, si lo hay. */
+    void close();
+
+    std::string path_;              /**< Ruta del archivo. */
+    uint8_t*    data_{nullptr};     /**< Región mapeada. */
+    size_t      size_{0};           /**< Bytes mapeados. */
+    int         fd_{-1};            /**< Descriptor del archivo. */
+    bool        reused_{false};     /**< El archivo ya tenía el tamaño pedido. */
+};
+
+#endif // MAPPED_FILE_H
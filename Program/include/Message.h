@@ -17,10 +17,16 @@ enum class Operation {
     INV_COMPLETE,           /**< Confirmación de finalización de todas las invalidaciones */
     READ_RESP,              /**< Respuesta con datos de lectura */
     WRITE_RESP,             /**< Respuesta con estado de escritura */
+    WRITEBACK,              /**< PE devuelve a memoria una línea sucia desalojada (sin respuesta) */
     END,                    /**< Fin de ejecucion de instrucciones por PE */
     UNDEFINED               /**< Operación no definida */
 };
 
+/* Bits del campo status de las respuestas */
+constexpr uint32_t STATUS_OK     = 0x1;     /**< La operación se completó */
+constexpr uint32_t STATUS_SHARED = 0x2;     /**< READ_RESP: otro caché tiene copia, se instala en S */
+constexpr uint32_t STATUS_C2C    = 0x4;     /**< READ_RESP: los datos vinieron del caché de otro PE */
+
 /**
  * @class Message
  * @brief Representa un paquete de comunicación entre un PE y el Interconnect.
@@ -41,7 +47,7 @@ public:
      * @param num_lines  Número de líneas de caché involucradas.
      * @param start_line Índice de la línea de caché inicial.
      * @param cache_line Línea de caché específica (para invalidación).
-     * @param status     Código de estado de escritura (0x1 OK, 0x0 NOT_OK).
+     * @param status     Código de estado (STATUS_OK, STATUS_SHARED, STATUS_C2C; 0x0 NOT_OK).
      * @param data       Vector de datos (palabras de 32 bits) para transferencias.
      */
     Message(Operation operation,
@@ -79,6 +85,15 @@ public:
 
     /** @brief Devuelve el ID de broadcast asociado o 0 si no aplica. */
     uint32_t get_broadcast_id() const;
+
+    /** @brief Devuelve el tag de la petición en el PE origen (0 si no aplica). */
+    uint32_t get_tag() const;
+
+    /** @brief true si es un READ_MEM de prefetch (o su READ_RESP). */
+    bool is_prefetch() const;
+
+    /** @brief true si es una escritura combinada posted (o su WRITE_RESP). */
+    bool is_posted() const;
     
     // Setters
     void set_operation(Operation op);
@@ -105,6 +120,30 @@ public:
 
     /** @brief Asigna un ID de broadcast para correlacionar INV_LINE/INV_ACK. */
     void set_broadcast_id(uint32_t id);
+
+    /**
+     * @brief Asigna el tag con el que el PE origen sigue esta petición.
+     *
+     * Las respuestas copian el tag de su petición, así el PE puede retirarla
+     * de su tabla de peticiones en vuelo aunque lleguen fuera de orden.
+     */
+    void set_tag(uint32_t tag);
+
+    /**
+     * @brief Marca el mensaje como prefetch.
+     *
+     * Un prefetch no ocupa la ventana de peticiones del PE; su READ_RESP
+     * conserva la marca para que el PE lo entregue al prefetcher.
+     */
+    void set_prefetch(bool prefetch);
+
+    /**
+     * @brief Marca el mensaje como escritura posted del write-combining buffer.
+     *
+     * No ocupa la ventana de peticiones del PE; su WRITE_RESP conserva la
+     * marca para que el PE la entregue al buffer.
+     */
+    void set_posted(bool posted);
     
 /* --------------------------------------------------------------------------------------------- */
 
@@ -173,6 +212,9 @@ private:
     uint32_t full_latency_{0};      /**< Latencia total de la instruccion */
 
     uint32_t broadcast_id_{0};      /**< ID del Broadcast, si es un Message de esos. */
+    uint32_t tag_{0};               /**< Tag de la petición en el PE origen. */
+    bool prefetch_{false};          /**< true si es un prefetch. */
+    bool posted_{false};            /**< true si es una escritura posted. */
 };
 
 /* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,91 @@
+#ifndef OBJECT_FORMAT_H
+#define OBJECT_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum ObjectEncoding
+ * @brief Cómo escribe el compilador las instrucciones ensambladas.
+ */
+enum class ObjectEncoding {
+    PACKED,     /**< Objeto binario: cabecera y 8 bytes little-endian por instrucción */
+    TEXT        /**< Una línea de '0'/'1' por instrucción (formato anterior) */
+};
+
+/**
+ * @struct ObjectHeader
+ * @brief Cabecera de un objeto compilado (config/binaries/pe_<n>.bin).
+ */
+struct ObjectHeader {
+    uint16_t version{0};    /**< Versión del formato */
+    uint16_t bits{0};       /**< Bits por instrucción (InstructionFormat::BITS) */
+    uint32_t pe_id{0};      /**< PE para el que se compiló, o ObjectFormat::ANY_PE */
+    uint64_t count{0};      /**< Instrucciones que siguen a la cabecera */
+};
+
+/**
+ * @struct ObjectFormat
+ * @brief Formato binario de los programas compilados.
+ *
+ * Todos los campos son little-endian, sin importar la máquina:
+ *
+ *     0-3     4-5      6-7    8-11    12-15      16-23
+ *     MAGIC   VERSION  BITS   PE_ID   reservado  COUNT
+ *
+ * y a partir del byte 24, COUNT instrucciones de 8 bytes. Con la cabecera de
+ * 24 bytes las instrucciones quedan alineadas a 8, así que el cargador las
+ * lee de una vez directo a su vector. Un archivo que no empieza con MAGIC se
+ * toma como el formato de texto anterior.
+ */
+struct ObjectFormat {
+    static constexpr std::array<uint8_t, 4> MAGIC{'I', 'C', 'O', 'B'};  /**< "ICOB" */
+    static constexpr uint16_t VERSION           = 1;                    /**< Versión que se escribe y se acepta */
+    static constexpr size_t   HEADER_BYTES      = 24;                   /**< Bytes de la cabecera */
+    static constexpr size_t   INSTRUCTION_BYTES = 8;                    /**< Bytes por instrucción */
+    static constexpr uint32_t ANY_PE            = 0xFFFFFFFF;           /**< Objeto sin PE asociado */
+
+    /** @brief Escribe los @p bytes menos significativos de @p value en little-endian. */
+    static constexpr void store_le(uint8_t* dst, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    /** @brief Lee @p bytes bytes little-endian. */
+    static constexpr uint64_t load_le(const uint8_t* src, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(src[i]) << (8 * i);
+        return value;
+    }
+
+    /** @brief true si los primeros @p size bytes de @p src empiezan con MAGIC. */
+    static constexpr bool has_magic(const uint8_t* src, size_t size) {
+        if (size < MAGIC.size()) return false;
+        for (size_t i = 0; i < MAGIC.size(); ++i) {
+            if (src[i] != MAGIC[i]) return false;
+        }
+        return true;
+    }
+
+    /** @brief Escribe la cabecera (HEADER_BYTES bytes) en @p dst. */
+    static constexpr void encode_header(uint8_t* dst, const ObjectHeader& header) {
+        for (size_t i = 0; i < MAGIC.size(); ++i) dst[i] = MAGIC[i];
+        store_le(dst + 4,  header.version, 2);
+        store_le(dst + 6,  header.bits,    2);
+        store_le(dst + 8,  header.pe_id,   4);
+        store_le(dst + 12, 0,              4);
+        store_le(dst + 16, header.count,   8);
+    }
+
+    /** @brief Lee la cabecera de @p src; MAGIC ya debe estar comprobado. */
+    static constexpr ObjectHeader decode_header(const uint8_t* src) {
+        ObjectHeader header;
+        header.version = static_cast<uint16_t>(load_le(src + 4, 2));
+        header.bits    = static_cast<uint16_t>(load_le(src + 6, 2));
+        header.pe_id   = static_cast<uint32_t>(load_le(src + 8, 4));
+        header.count   = load_le(src + 16, 8);
+        return header;
+    }
+};
+
+#endif // OBJECT_FORMAT_H
@@ -0,0 +1,39 @@
+#ifndef SEEDED_FILL_H
+#define SEEDED_FILL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Siguiente valor de un generador splitmix64 (avanza @p state).
+ */
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Llena @p bytes bytes de @p out con el flujo @p stream de la semilla @p seed.
+ *
+ * Cada flujo (una página de memoria, el caché de un PE) es independiente de
+ * los demás, así que pueden generarse en cualquier orden o en paralelo y el
+ * resultado con la misma semilla es siempre el mismo.
+ */
+inline void seeded_fill(uint64_t seed, uint64_t stream, void* out, size_t bytes) {
+    uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    auto* dst = static_cast<uint8_t*>(out);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+        uint64_t value = splitmix64(state);
+        std::memcpy(dst + i, &value, sizeof(value));
+    }
+    if (i < bytes) {
+        uint64_t value = splitmix64(state);
+        std::memcpy(dst + i, &value, bytes - i);
+    }
+}
+
+#endif // SEEDED_FILL_H
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -10,6 +11,11 @@
 #include "components/Interconnect.h"
 #include "components/Local_Cache.h"
 #include "components/Shared_Memory.h"
+#include "components/Shared_Cache.h"
+#include "components/Memory_Controller.h"
+#include "components/Write_Combining_Buffer.h"
+#include "components/Directory.h"
+#include "Latency_Model.h"
 
 /**
  * @class System
@@ -79,6 +85,12 @@ public:
     /** @brief Imprime en consola el ID y QoS de cada PE para depuración. */
     void debug_print() const;
 
+    /**
+     * @brief Vuelca el estado MESI de cada caché a config/caches/inv_cache_<id>.txt.
+     * @throws std::runtime_error si no se puede escribir algún archivo.
+     */
+    void dump_cache_state() const;
+
     void system_test_G(const std::string& file_path);
     void system_test_R();
 
@@ -86,11 +98,17 @@ public:
 
 private:
     int                             total_pes_;             /**< Número de PEs configurados. */
+    size_t                          max_outstanding_{1};    /**< Peticiones en vuelo por PE (config/pe.txt). */
     std::vector<PE>                 pes_;                   /**< Vector de PEs del sistema. */
     ArbitScheme                     scheme_;                /**< Esquema de arbitraje seleccionado. */
     std::unique_ptr<Interconnect>   interconnect_;          /**< Interconnect para enrutar mensajes. */
-    std::vector<LocalCache>         caches_;                /**< Caches Locales L1 para cada PE. */
+    std::deque<LocalCache>          caches_;                /**< Caches Locales L1 para cada PE (deque: LocalCache no es movible). */
+    std::vector<WriteCombiningBuffer> write_buffers_;       /**< Write-combining buffer de cada PE (wc_entries: 0 = apagado). */
     std::unique_ptr<SharedMemory>   shared_memory_;         /**< Interconnect para enrutar mensajes. */
+    std::unique_ptr<SharedCache>    shared_cache_;          /**< L2 compartido (nullptr si l2: off). */
+    std::unique_ptr<MemoryController> memory_controller_;   /**< Colas y planificación de memoria (nullptr si mc_policy: off). */
+    std::unique_ptr<Directory>      directory_;             /**< Sharers/owner por línea (nullptr si cache_to_cache: off). */
+    LatencyModel                    latency_;               /**< Latencias de cada etapa (config/times.txt). */
 
     // --------------------------------------------------
     // Stepping control
@@ -99,6 +117,7 @@ private:
     std::mutex                      step_mtx_;              /**< Protege current_step_. */
     std::condition_variable         step_cv_;               /**< Despierta hilos en cada step. */
     int                             current_step_{0};       /**< Contador de pasos completados. */
+    std::atomic<int>                drained_pes_{0};        /**< PEs sin instrucciones ni peticiones en vuelo. */
 
     std::vector<std::thread>        pe_threads_;            /**< Hilos que ejecutan cada PE. */
     std::thread                     interconnect_thread_;   /**< Hilo para el Interconnect. */
@@ -158,6 +177,123 @@ private:
     /** @brief Espera a que el hilo del Interconnect termine. */
     void join_interconnect_thread();
 
+    /**
+     * @brief Snoop MESI de un READ_MEM en los caches de los demás PEs.
+     *
+     * Las copias E/M ajenas bajan a S; los datos sucios de las copias M y de
+     * los buffers de writeback (también el del lector) se escriben antes en
+     * memoria, así que se llama antes de leerla. Registra las transacciones
+     * en el Interconnect y devuelve su latencia.
+     *
+     * @param req    Petición de lectura.
+     * @param shared [out] true si algún otro caché tiene copia del rango.
+     * @return Latencia de coherencia a sumar a la respuesta.
+     */
+    uint32_t snoop_read_coherence(const Message& req, bool& shared);
+
+    /**
+     * @brief Snoop MESI de un WRITE_MEM: invalida copias ajenas y actualiza la del escritor.
+     *
+     * Los datos sucios del rango se escriben en memoria primero, así que se
+     * llama antes de la escritura.
+     *
+     * @param req Petición de escritura (con sus datos).
+     * @return Latencia de coherencia a sumar a la respuesta.
+     */
+    uint32_t snoop_write_coherence(const Message& req);
+
+    /**
+     * @brief Entrena el prefetcher del PE con un READ_MEM y emite sus prefetches.
+     *
+     * Los READ_MEM de prefetch salen con el QoS del prefetcher, tag 0 y la
+     * marca de prefetch: no ocupan la ventana del PE. Se omiten las líneas ya
+     * presentes en el caché o que el prefetcher no puede emitir.
+     *
+     * @param pe_id  PE dueño del caché.
+     * @param cache  Caché local del PE.
+     * @param lookup Resultado de la búsqueda por demanda.
+     */
+    /**
+     * @brief Intenta servir un READ_MEM desde el caché de otro PE.
+     *
+     * Busca en el directorio quién tiene todas las líneas (primero el owner),
+     * comprueba su caché y, si responde, encola el READ_RESP con la latencia
+     * cache-to-cache en vez de ir a memoria. Las entradas viejas se borran.
+     *
+     * @param req Petición de lectura.
+     * @return true si se respondió; false si hay que ir a memoria.
+     */
+    bool serve_cache_to_cache(const Message& req);
+
+    /** @brief Primera línea de caché que toca una lectura. */
+    uint64_t first_line_of(const Message& req) const;
+
+    /** @brief Última línea de caché que toca una lectura. */
+    uint64_t last_line_of(const Message& req) const;
+
+    void issue_prefetches(int pe_id, LocalCache& cache, const CacheLookup& lookup);
+
+    /** @brief Servicio de un banco que lee @p words palabras: memory_read de sus bytes. */
+    uint64_t bank_read_cycles(uint64_t words) const;
+
+    /** @brief Servicio de un banco que escribe @p words palabras: memory_write de sus líneas. */
+    uint64_t bank_write_cycles(uint64_t words) const;
+
+    /**
+     * @brief Latencia de un acceso que pasó por el L2.
+     *
+     * Reserva los bancos del L2 y, tras ellos, los bancos de SharedMemory
+     * para las líneas traídas (en el camino crítico) y las víctimas sucias
+     * (fuera del camino crítico, pero ocupan su banco).
+     *
+     * @param first_word Primera palabra del acceso.
+     * @param words      Palabras del acceso.
+     * @param access     Resultado de SharedCache::read / write.
+     * @return Ciclos hasta que el acceso termina.
+     */
+    uint32_t schedule_shared_cache_access(uint64_t first_word, uint64_t words,
+                                          const SharedCacheAccess& access);
+
+    /**
+     * @brief Entrega un acceso a memoria con sus respuestas ya armadas.
+     *
+     * Con controlador de memoria el acceso espera en su cola hasta que se
+     * despacha; sin él reserva los bancos en este mismo ciclo. En ambos casos
+     * las respuestas pasan a mid_processing con la latencia del servicio.
+     */
+    void submit_memory_access(MemoryRequest request);
+
+    /**
+     * @brief Escribe en memoria (o en el L2) líneas sucias de los caches locales.
+     *
+     * Ocupan sus bancos de inmediato, sin pasar por el controlador: son parte
+     * de la transacción de coherencia que las provocó.
+     *
+     * @return Ciclos hasta que la última queda escrita.
+     */
+    uint32_t write_back_lines(const std::vector<Writeback>& lines);
+
+    /** @brief Envía al Interconnect un WRITEBACK por cada línea que el caché del PE desalojó sucia. */
+    void send_writebacks(PE& pe, LocalCache& cache);
+
+    /** @brief Envía al Interconnect, como escrituras posted, las que salieron del write-combining buffer. */
+    void send_posted_writes(PE& pe, const std::vector<Message>& writes);
+
+    /**
+     * @brief true si el próximo mensaje de in_queue puede procesarse este ciclo.
+     *
+     * READ_MEM y WRITE_MEM ocupan una cola del controlador de memoria; si la
+     * suya está llena el Interconnect lo deja en in_queue y cuenta el ciclo
+     * perdido. Un BROADCAST_INVALIDATE espera igual si la tabla de broadcasts
+     * no tiene slot libre, pero deja pasar a los INV_ACK que vienen detrás.
+     *
+     * @param ack_first [out] true si hay que extraer el primer INV_ACK en vez de la cabeza.
+     */
+    bool in_queue_head_accepted(bool& ack_first);
+
+    /** @brief true si no quedan mensajes en el Interconnect ni accesos en el controlador. */
+    bool pipeline_empty() const;
+
 /* --- */
 
     /** @brief Devuelve true si TODOS los PEs están en estado FINISHED. */
@@ -0,0 +1,68 @@
+#ifndef DIRECTORY_H
+#define DIRECTORY_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+/**
+ * @class Directory
+ * @brief Directorio de sharers/owner por línea de caché, del lado del Interconnect.
+ *
+ * Registra qué PEs recibieron cada línea y cuál la tiene en exclusiva, para
+ * reenviar un READ_MEM al caché que ya tiene los datos. Los caches desalojan
+ * e invalidan (INV_LINE) sin avisar, así que una entrada es solo una pista:
+ * quien la usa comprueba el caché y borra al PE con remove() si ya no la tiene.
+ * Solo lo usa el hilo del Interconnect.
+ */
+class Directory {
+public:
+    static constexpr int MAX_PES = 64;     /**< Un bit de sharer por PE en 64 bits. */
+
+    /**
+     * @brief Crea un directorio vacío.
+     * @throws std::invalid_argument si @p total_pes no cabe en la máscara.
+     */
+    explicit Directory(int total_pes);
+
+    /**
+     * @brief @p pe recibió las líneas [first_line, last_line].
+     * @param exclusive true si las instaló en E (pasa a owner); si no, queda como sharer
+     *                  y las líneas dejan de tener owner (el snoop bajó su copia a S).
+     */
+    void record_read(uint64_t first_line, uint64_t last_line, int pe, bool exclusive);
+
+    /**
+     * @brief @p pe escribió las líneas: las demás copias quedaron invalidadas.
+     * @param present true si el escritor tiene las líneas en su caché (queda owner).
+     */
+    void record_write(uint64_t first_line, uint64_t last_line, int pe, bool present);
+
+    /** @brief Quita a @p pe de las líneas (entrada vieja). */
+    void remove(uint64_t first_line, uint64_t last_line, int pe);
+
+    /**
+     * @brief PEs que según el directorio tienen todas las líneas, sin @p requester.
+     * @return Primero el owner de la primera línea (si lo hay), luego los sharers por id.
+     */
+    std::vector<int> holders(uint64_t first_line, uint64_t last_line, int requester) const;
+
+    /** @brief Líneas con alguna copia registrada. */
+    size_t size() const;
+
+private:
+    /**
+     * @struct Entry
+     * @brief Copias de una línea.
+     */
+    struct Entry {
+        uint64_t sharers{0};    /**< Bit i = el PE i tiene copia. */
+        int      owner{-1};     /**< PE con la copia en E/M, -1 si ninguno. */
+    };
+
+    int                                  total_pes_;    /**< PEs del sistema. */
+    std::unordered_map<uint64_t, Entry>  entries_;      /**< Línea -> copias. */
+};
+
+#endif // DIRECTORY_H
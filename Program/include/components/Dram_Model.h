@@ -0,0 +1,120 @@
+#ifndef DRAM_MODEL_H
+#define DRAM_MODEL_H
+
+#include <vector>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum PagePolicy
+ * @brief Qué hace un banco DRAM con su fila al terminar un acceso.
+ */
+enum class PagePolicy {
+    OPEN,   /**< La fila queda abierta: el siguiente acceso a ella es un row hit */
+    CLOSE   /**< Se hace precharge al terminar: cada acceso paga tRCD, nunca tRP */
+};
+
+/**
+ * @struct DramConfig
+ * @brief Tiempos del backend DRAM (config/dram.txt), en ciclos del Interconnect.
+ */
+struct DramConfig {
+    bool       enabled{false};              /**< Sin DRAM la memoria usa la fórmula de LatencyModel */
+    uint32_t   row_size{1024};              /**< Bytes por fila de un banco (múltiplo de 16) */
+    PagePolicy page_policy{PagePolicy::OPEN};   /**< Política de página */
+    uint32_t   t_rcd{14};                   /**< ACTIVATE -> READ/WRITE */
+    uint32_t   t_cas{14};                   /**< READ/WRITE -> primer dato */
+    uint32_t   t_rp{14};                    /**< PRECHARGE -> ACTIVATE */
+    uint32_t   t_ras{33};                   /**< ACTIVATE -> PRECHARGE mínimo */
+    uint32_t   t_wr{15};                    /**< Último dato escrito -> PRECHARGE */
+    uint32_t   t_burst{4};                  /**< Transferir una línea de 16 bytes */
+    uint32_t   t_refi{7800};                /**< Intervalo entre refrescos (0 = sin refresco) */
+    uint32_t   t_rfc{350};                  /**< Duración de un refresco */
+
+    /** @brief Líneas de 16 bytes por fila. */
+    uint32_t row_lines() const { return row_size / 16; }
+
+    /**
+     * @brief Carga la configuración desde un archivo "clave: valor".
+     *
+     * Claves: dram (on|off), row_size, page_policy (open|close), t_rcd, t_cas,
+     * t_rp, t_ras, t_wr, t_burst, t_refi y t_rfc. Las ausentes conservan su
+     * valor por defecto; si el archivo no existe la DRAM queda apagada.
+     *
+     * @throws std::invalid_argument si algún valor es inválido.
+     */
+    static DramConfig load_from_file(const std::string& filename);
+};
+
+/**
+ * @struct DramStats
+ * @brief Contadores de filas del backend DRAM.
+ */
+struct DramStats {
+    uint64_t row_hits{0};       /**< Líneas servidas con su fila ya abierta */
+    uint64_t row_misses{0};     /**< Líneas que abrieron fila en un banco cerrado */
+    uint64_t row_conflicts{0};  /**< Líneas que tuvieron que cerrar otra fila primero */
+    uint64_t refreshes{0};      /**< Refrescos que retrasaron un acceso */
+};
+
+/**
+ * @struct DramBank
+ * @brief Estado de la fila de un banco DRAM.
+ */
+struct DramBank {
+    int64_t  open_row{-1};          /**< Fila abierta (-1 = banco en precharge) */
+    uint64_t activate_ready{0};     /**< Primer ciclo en que se puede hacer ACTIVATE (tRP de un cierre) */
+    uint64_t precharge_ready{0};    /**< Primer ciclo en que se puede hacer PRECHARGE (tRAS/tWR) */
+    uint64_t next_refresh{0};       /**< Ciclo del próximo refresco */
+};
+
+/**
+ * @class DramModel
+ * @brief Temporización de los bancos de SharedMemory como DRAM con row buffers.
+ *
+ * Cada banco tiene una fila abierta. Un acceso a la fila abierta cuesta tCAS
+ * (más tBURST por línea); a un banco cerrado, tRCD + tCAS; a otra fila,
+ * además un PRECHARGE (tRP) que no puede empezar antes de tRAS desde el
+ * ACTIVATE ni de tWR tras una escritura. Cada tREFI ciclos el banco se
+ * refresca durante tRFC y pierde su fila. SharedMemory sigue decidiendo qué
+ * banco atiende cada línea y cuándo queda libre; este modelo solo calcula
+ * cuánto tarda.
+ */
+class DramModel {
+public:
+    /**
+     * @param config Tiempos y política de página.
+     * @param banks  Bancos de SharedMemory.
+     */
+    DramModel(const DramConfig& config, uint32_t banks);
+
+    /**
+     * @brief Atiende en un banco una secuencia de líneas y devuelve cuándo termina.
+     *
+     * @param bank  Banco que atiende.
+     * @param rows  Fila (dentro del banco) de cada línea, en orden de acceso.
+     * @param start Ciclo en que el banco empieza (ya libre).
+     * @param write true para escrituras (aplican tWR antes del siguiente PRECHARGE).
+     * @return Ciclo en que el último dato queda transferido.
+     */
+    uint64_t service(uint32_t bank, const std::vector<uint64_t>& rows, uint64_t start, bool write);
+
+    /** @brief true si @p row es la fila abierta de @p bank. */
+    bool is_open(uint32_t bank, uint64_t row) const;
+
+    /** @brief Configuración en uso. */
+    const DramConfig& get_config() const { return config_; }
+
+    /** @brief Contadores de filas. */
+    const DramStats& get_stats() const { return stats_; }
+
+private:
+    /** @brief Aplica los refrescos vencidos antes de @p now; devuelve el nuevo ciclo de inicio. */
+    uint64_t refresh(DramBank& bank, uint64_t now);
+
+    DramConfig            config_;      /**< Tiempos y política de página. */
+    std::vector<DramBank> banks_;       /**< Fila abierta de cada banco. */
+    DramStats             stats_;       /**< Contadores de filas. */
+};
+
+#endif // DRAM_MODEL_H
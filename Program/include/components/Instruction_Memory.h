@@ -4,13 +4,16 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <fstream>
+#include "../Object_Format.h"
 
 /**
  * @class InstructionMemory
  * @brief Gestiona la memoria de instrucciones de un PE.
  *
  * Cada instancia está asociada a un PE mediante un identificador. Permite
- * cargar instrucciones de 64 bits desde un archivo de texto (hex o binario),
+ * cargar instrucciones de 64 bits desde el objeto que genera el compilador
+ * (ObjectFormat) o desde un archivo de texto (hex o binario),
  * obtener instrucciones por índice y volcar la memoria a un archivo.
  */
 class InstructionMemory {
@@ -33,15 +36,17 @@ public:
     void initialize();
 
     /**
-     * @brief Carga instrucciones desde un archivo de texto.
+     * @brief Carga instrucciones desde un objeto compilado o un archivo de texto.
      *
-     * Cada línea no vacía se interpreta como:
+     * Si el archivo empieza con ObjectFormat::MAGIC se lee como objeto (ver
+     * load_object). Si no, se toma como el formato de texto anterior y cada
+     * línea no vacía se interpreta como:
      * - Hexadecimal con prefijo "0x".
-     * - Binario (solo '0' y '1'), máximo 64 caracteres.
-     * Instrucciones que excedan 43 bits lanzan excepción.
+     * - Binario (solo '0' y '1'), exactamente InstructionFormat::BITS caracteres.
+     * Instrucciones que excedan InstructionFormat::BITS lanzan excepción.
      *
-     * @param filename Ruta al archivo de texto.
-     * @throws std::runtime_error si no puede abrir el archivo.
+     * @param filename Ruta al archivo.
+     * @throws std::runtime_error si no puede abrir el archivo o el objeto es inválido.
      * @throws std::invalid_argument o std::overflow_error según parseo.
      */
     void load_from_file(const std::string& filename);
@@ -107,6 +112,22 @@ private:
      * @throws std::invalid_argument o std::overflow_error según el formato.
      */
     uint64_t parse_instruction(const std::string& text);
+
+    /**
+     * @brief Lee las instrucciones de un objeto cuya cabecera ya se leyó.
+     *
+     * Comprueba versión, ancho de instrucción, PE y que el tamaño del archivo
+     * coincida con COUNT, y lee todas las instrucciones con una sola lectura.
+     *
+     * @param file      Archivo posicionado al final de la cabecera.
+     * @param filename  Ruta, para los mensajes de error.
+     * @param file_size Bytes del archivo.
+     * @param header    Cabecera decodificada.
+     * @throws std::runtime_error si la cabecera no corresponde a este PE o al archivo.
+     * @throws std::overflow_error si una instrucción supera InstructionFormat::BITS.
+     */
+    void load_object(std::ifstream& file, const std::string& filename,
+                     uint64_t file_size, const ObjectHeader& header);
 };
 
 #endif // INSTRUCTION_MEMORY_H
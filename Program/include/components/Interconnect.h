@@ -4,7 +4,8 @@
 #include <deque>
 #include <mutex>
 #include <atomic>
-#include <unordered_map>
+#include <array>
+#include <memory>
 #include "Message.h"
 
 /**
@@ -22,9 +23,52 @@ enum class ICState {
     FINISHED        /**< No entrarán mas mensajes y se han respondido todos */
 };
 
-struct PendingBroadcast {
-    int origin_pe;       /**< Quién lanzó el broadcast */
-    int pending_acks;    /**< Cuántos ACK faltan */
+/**
+ * @struct BroadcastSlot
+ * @brief Entrada de la tabla de broadcasts pendientes.
+ *
+ * El slot de un broadcast es broadcast_id % capacidad de la tabla. La generación
+ * guarda broadcast_id + 1 mientras el slot está ocupado (0 = libre), así un ACK
+ * con un ID viejo o inválido no toca el contador de otro broadcast.
+ */
+struct BroadcastSlot {
+    std::atomic<uint32_t> generation{0};    /**< broadcast_id + 1 del dueño, 0 si está libre */
+    std::atomic<int>      origin_pe{-1};    /**< Quién lanzó el broadcast */
+    std::atomic<uint32_t> origin_tag{0};    /**< Tag de la petición en el PE origen */
+    std::atomic<int>      pending_acks{0};  /**< Cuántos ACK faltan */
+};
+
+/**
+ * @enum AckResult
+ * @brief Resultado de contabilizar un INV_ACK en la tabla de broadcasts.
+ */
+enum class AckResult {
+    PENDING,    /**< Aún faltan ACKs para este broadcast. */
+    COMPLETE,   /**< Este ACK cerró el broadcast; el slot quedó libre. */
+    INVALID     /**< El broadcast_id no corresponde a ningún broadcast pendiente. */
+};
+
+/**
+ * @struct CoalescingStats
+ * @brief Contadores de coalescing de READ_MEM en el Interconnect.
+ */
+struct CoalescingStats {
+    uint64_t read_requests{0};      /**< READ_MEM atendidos en total */
+    uint64_t coalesced_reads{0};    /**< READ_MEM servidos con el acceso de otra lectura */
+    uint64_t memory_reads{0};       /**< Accesos reales a SharedMemory por lecturas */
+    uint64_t cache_to_cache{0};     /**< READ_MEM servidos desde el caché de otro PE */
+    uint64_t directory_stale{0};    /**< PEs del directorio que ya no tenían las líneas */
+};
+
+/**
+ * @struct CoherenceStats
+ * @brief Transacciones de coherencia MESI generadas por el Interconnect.
+ */
+struct CoherenceStats {
+    uint64_t snoops{0};         /**< Caches consultados por READ_MEM y WRITE_MEM */
+    uint64_t upgrades{0};       /**< Líneas S del escritor que pasaron a exclusivas */
+    uint64_t invalidations{0};  /**< Copias ajenas invalidadas por una escritura */
+    uint64_t downgrades{0};     /**< Copias E/M ajenas que bajaron a S por una lectura */
 };
 
 /**
@@ -35,28 +79,50 @@ struct PendingBroadcast {
  */
 class Interconnect {
 public:
-    std::atomic<uint32_t> next_broadcast_id_{0}; /**< Para generar IDs únicos de PendingBroadcasts. */
-    // Mapa: broadcast_id → info de esa emisión
-    std::unordered_map<uint32_t, PendingBroadcast>  pending_broadcasts_;
-    mutable std::mutex                              broadcast_mtx_;
-
     /**
      * @brief Construye un Interconnect para un número de PEs y un esquema de arbitraje.
+     *
+     * La tabla de broadcasts se redondea a potencia de dos para que
+     * broadcast_id % capacidad no cambie cuando el contador de IDs da la vuelta.
+     *
      * @param num_pes Cantidad de PEs conectados.
      * @param scheme Esquema de arbitraje a utilizar.
+     * @param max_broadcasts Broadcasts que pueden estar en vuelo a la vez
+     *        (num_pes × max_outstanding alcanza para cualquier carga).
+     */
+    Interconnect(int num_pes, ArbitScheme scheme, size_t max_broadcasts);
+
+    /**
+     * @brief Registra un nuevo BROADCAST_INVALIDATE si queda un slot libre.
+     *
+     * Busca un slot libre y lo reclama con un CAS sobre su generación; el
+     * broadcast_id se elige para que caiga en ese slot. Después guarda el PE
+     * origen y el conteo inicial de ACKs (igual a num_pes_). No reserva memoria.
+     *
+     * @param origin_pe  Identificador del PE que origina el broadcast.
+     * @param origin_tag Tag de la petición en el PE origen, para su INV_COMPLETE.
+     * @param bid        [out] El broadcast_id asignado.
+     * @return false si la tabla está llena; el broadcast debe esperar en in_queue.
      */
-    Interconnect(int num_pes, ArbitScheme scheme);
+    bool try_register_broadcast(int origin_pe, uint32_t origin_tag, uint32_t& bid);
+
+    /** @brief true si queda al menos un slot libre en la tabla de broadcasts. */
+    bool has_free_broadcast_slot() const;
 
     /**
-     * @brief Registra un nuevo BROADCAST_INVALIDATE.
+     * @brief Contabiliza un INV_ACK para el broadcast dado sin tomar locks.
      *
-     * Genera un broadcast_id único, guarda en pending_broadcasts_
-     * el PE origen y el conteo inicial de ACKs (igual a num_pes_).
+     * Valida la generación del slot, resta un ACK de forma atómica y, si era
+     * el último, libera el slot.
      *
-     * @param origin_pe Identificador del PE que origina el broadcast.
-     * @return El broadcast_id asignado.
+     * @param broadcast_id ID que trae el INV_ACK.
+     * @param origin_pe    [out] PE que originó el broadcast (-1 si es inválido).
+     * @param origin_tag   [out] Tag de la petición en el PE origen.
+     * @param remaining    [out] ACKs que faltan tras este (-1 si es inválido).
+     * @return PENDING, COMPLETE o INVALID.
      */
-    uint32_t register_broadcast(int origin_pe);
+    AckResult acknowledge_broadcast(uint32_t broadcast_id, int& origin_pe,
+                                    uint32_t& origin_tag, int& remaining);
 
     /**
      * @brief Devuelve true si hay al menos una respuesta pendiente para el PE dado.
@@ -112,9 +178,55 @@ public:
      */
     Message pop_next();
 
+    /**
+     * @brief Operación del mensaje que devolvería pop_next(), sin extraerlo.
+     * @throws std::out_of_range si la cola está vacía.
+     */
+    Operation next_operation() const;
+
+    /** @brief true si hay algún INV_ACK esperando en in_queue. */
+    bool has_pending_ack() const;
+
+    /**
+     * @brief Extrae el primer INV_ACK de in_queue, adelantándolo al resto.
+     *
+     * Lo usa System cuando un BROADCAST_INVALIDATE espera slot: los ACKs son
+     * los que liberan slots y no pueden quedar detrás de él.
+     *
+     * @throws std::out_of_range si no hay ningún INV_ACK.
+     */
+    Message pop_next_ack();
+
     /** @brief Devuelve true si la cola de entrada está vacía. */
     bool in_queue_empty() const;
 
+    /**
+     * @brief Extrae de in_queue_ los READ_MEM que se solapan con un rango de palabras.
+     *
+     * El rango [first_word, end_word) se amplía con cada lectura extraída, así las
+     * lecturas encadenadas también quedan agrupadas y se sirven con un solo acceso
+     * a SharedMemory.
+     *
+     * La cola se recorre en el orden de pop_next(). Una lectura no se adelanta a
+     * un WRITE_MEM o WRITEBACK anterior que toque sus palabras, y la búsqueda se
+     * corta en el primer BROADCAST_INVALIDATE.
+     *
+     * @param first_word [in/out] Primera palabra del rango agrupado.
+     * @param end_word   [in/out] Palabra siguiente a la última del rango agrupado.
+     * @return READ_MEM extraídos, en el orden que tenían en la cola.
+     */
+    std::vector<Message> take_overlapping_reads(uint64_t& first_word, uint64_t& end_word);
+
+    /**
+     * @brief Palabras de 32 bits que cubre un READ_MEM de @p size_bytes.
+     *
+     * SharedMemory responde en bloques de 16 bytes, así que se redondea hacia arriba.
+     */
+    static uint64_t read_span_words(uint32_t size_bytes);
+
+    /** @brief Palabras de 32 bits que escribe un WRITE_MEM o WRITEBACK en cola. */
+    static uint64_t write_span_words(const Message& m);
+
 /* ------------------------------------ */
 /*                                      */
 /*         mid_processing_queue         */
@@ -192,6 +304,34 @@ public:
 /* --------------------------------------------------------------------------------------------- */
 
 
+/* ---------------------------------------- Statistics ----------------------------------------- */
+
+    /**
+     * @brief Registra un acceso a SharedMemory que sirvió @p requests_served lecturas.
+     * @param requests_served READ_MEM atendidos por ese acceso (1 si no hubo coalescing).
+     */
+    void record_memory_read(size_t requests_served);
+
+    /** @brief Registra un READ_MEM servido desde el caché de otro PE. */
+    void record_cache_to_cache();
+
+    /** @brief Registra @p holders PEs del directorio que ya no tenían las líneas. */
+    void record_directory_stale(size_t holders);
+
+    /** @brief Devuelve una copia de los contadores de coalescing. */
+    CoalescingStats get_coalescing_stats() const;
+
+    /**
+     * @brief Suma las transacciones de coherencia de una petición.
+     * @param stats Transacciones generadas al atender la petición.
+     */
+    void record_coherence(const CoherenceStats& stats);
+
+    /** @brief Devuelve una copia de los contadores de coherencia. */
+    CoherenceStats get_coherence_stats() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
 /* ----------------------------------- Getters & Setters --------------------------------------- */
 
     /** @brief Lee el estado actual del Interconnect. */
@@ -200,6 +340,12 @@ public:
     /** @brief Fuerza un nuevo estado (interno). */
     void set_state(ICState s);
 
+    /** @brief Avanza un ciclo el reloj del Interconnect. */
+    void advance_cycle();
+
+    /** @brief Ciclo actual del Interconnect (pasos procesados por su hilo). */
+    uint64_t get_cycle() const;
+
     /**
      * @brief Obtiene la cola de mensajes entrantes.
      * @return Referencia constante a la deque interna de mensajes entrantes.
@@ -254,6 +400,7 @@ private:
     int                 num_pes_;               /**< Número de PEs conectados */
     ArbitScheme         scheme_;                /**< Esquema de arbitraje */
     ICState             state_{ICState::IDLE};  /**< Estado del Interconnect */
+    std::atomic<uint64_t> cycle_{0};            /**< Reloj del Interconnect, base de tiempo de la memoria */
     
     std::deque<Message> in_queue_;              /**< Cola de Messages entrantes */
     mutable std::mutex  in_queue_mtx_;          /**< Protege in_queue_ contra accesos concurrentes. */
@@ -263,4 +410,19 @@ private:
 
     std::deque<Message> out_queue_;             /**< Cola de respuestas salientes */
     mutable std::mutex  out_queue_mtx_;         /**< Protege out_queue_ */
+
+    size_t                           broadcast_capacity_;       /**< Slots de la tabla (potencia de dos). */
+    std::unique_ptr<BroadcastSlot[]> broadcasts_;               /**< Tabla de broadcasts pendientes. */
+    std::atomic<uint32_t>            next_broadcast_round_{0};  /**< Vuelta de IDs: bid = vuelta × capacidad + slot. */
+
+    std::atomic<uint64_t> read_requests_{0};    /**< READ_MEM atendidos. */
+    std::atomic<uint64_t> coalesced_reads_{0};  /**< READ_MEM servidos por coalescing. */
+    std::atomic<uint64_t> memory_reads_{0};     /**< Accesos a SharedMemory por lecturas. */
+    std::atomic<uint64_t> c2c_reads_{0};        /**< READ_MEM servidos desde otro caché. */
+    std::atomic<uint64_t> directory_stale_{0};  /**< Pistas viejas del directorio. */
+
+    std::atomic<uint64_t> snoops_{0};           /**< Caches consultados. */
+    std::atomic<uint64_t> upgrades_{0};         /**< Upgrades S -> E/M. */
+    std::atomic<uint64_t> invalidations_{0};    /**< Copias invalidadas por escrituras. */
+    std::atomic<uint64_t> downgrades_{0};       /**< Downgrades E/M -> S. */
 };
@@ -5,39 +5,167 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <map>
+#include "../Geometry.h"
+#include "../Mapped_File.h"
+#include "Tag_Store.h"
+#include "Prefetcher.h"
+#include "Mesi_State_Array.h"
+
+/**
+ * @enum WritePolicy
+ * @brief Qué hace el caché local con un WRITE_MEM de su PE.
+ */
+enum class WritePolicy {
+    WRITE_THROUGH,  /**< Toda escritura viaja por el Interconnect hasta la memoria */
+    WRITE_BACK      /**< Si el PE tiene las líneas en E/M la escritura se queda en el caché (M) */
+};
+
+/**
+ * @struct CacheConfig
+ * @brief Geometría del caché local de cada PE (config/cache.txt).
+ *
+ * Los valores por defecto son los de Geometry y dan la misma capacidad que el
+ * caché original: 32 conjuntos x 4 vías x 16 bytes = 128 líneas de 16 bytes.
+ */
+struct CacheConfig {
+    uint32_t    sets{Geometry::DEFAULT_SETS};           /**< Número de conjuntos (potencia de 2) */
+    uint32_t    ways{Geometry::DEFAULT_WAYS};           /**< Vías por conjunto */
+    uint32_t    line_size{Geometry::DEFAULT_LINE_SIZE}; /**< Bytes por línea (múltiplo de 16, potencia de 2) */
+    Replacement replacement{Replacement::LRU};  /**< Política de reemplazo */
+    PrefetchConfig prefetch;                    /**< Prefetcher (apagado por defecto) */
+    bool        cache_to_cache{false};          /**< Un READ_MEM puede servirse desde el caché de otro PE */
+    Storage     storage{Storage::HEAP};         /**< heap o mmap sobre cache_<id>.bin */
+    InitMode    init{InitMode::RANDOM};         /**< Origen de los datos iniciales */
+    uint64_t    seed{0};                        /**< Semilla con InitMode::SEED; cada PE usa su propio flujo */
+    WritePolicy write_policy{WritePolicy::WRITE_THROUGH};  /**< write-through o write-back */
+
+    /**
+     * @brief Carga la configuración desde un archivo "clave: valor".
+     *
+     * Claves: sets, ways, line_size, replacement (lru|plru|random),
+     * cache_to_cache (on|off), write_policy (through|back) y las del prefetcher (prefetch, prefetch_degree,
+     * ...). Las ausentes conservan su valor por defecto.
+     *
+     * @throws std::invalid_argument si algún valor es inválido.
+     */
+    static CacheConfig load_from_file(const std::string& filename);
+};
+
+/**
+ * @struct CacheLookup
+ * @brief Resultado de buscar un READ_MEM en el caché local.
+ */
+struct CacheLookup {
+    bool     hit{false};        /**< true si todas las líneas del rango están en el caché */
+    uint32_t lines{0};          /**< Líneas que cubre el rango pedido */
+    uint64_t first_line{0};     /**< Primera línea del rango */
+    uint64_t last_line{0};      /**< Última línea del rango */
+    uint64_t miss_first_line{0};/**< Primera línea ausente */
+    uint64_t miss_last_line{0}; /**< Última línea ausente */
+    uint64_t miss_address{0};   /**< Dirección (palabras) alineada a línea a pedir al Interconnect */
+    uint32_t miss_size{0};      /**< Bytes a pedir: de la primera a la última línea ausente */
+};
+
+/**
+ * @struct Writeback
+ * @brief Línea sucia que debe escribirse en memoria.
+ */
+struct Writeback {
+    uint64_t                          address{0};   /**< Dirección (palabras) donde empieza la línea */
+    std::vector<std::vector<uint8_t>> blocks;       /**< Datos de la línea en bloques de 16 bytes */
+};
+
+/**
+ * @struct SnoopResult
+ * @brief Efecto de una consulta de coherencia sobre un rango de direcciones.
+ */
+struct SnoopResult {
+    uint32_t present{0};        /**< Líneas del rango con copia válida */
+    uint32_t upgraded{0};       /**< S -> E (copia del propio escritor) */
+    uint32_t invalidated{0};    /**< Copias que pasaron a I */
+    uint32_t downgraded{0};     /**< Copias E/M que pasaron a S */
+    std::vector<Writeback> dirty;   /**< Datos sucios (M o en el buffer de writeback) a escribir antes */
+};
+
+/**
+ * @struct CacheStats
+ * @brief Contadores de uso del caché local.
+ */
+struct CacheStats {
+    uint64_t read_hits{0};      /**< READ_MEM servidos por el caché */
+    uint64_t read_misses{0};    /**< READ_MEM que tuvieron que ir al Interconnect */
+    uint64_t fills{0};          /**< Líneas instaladas desde un READ_RESP */
+    uint64_t evictions{0};      /**< Líneas válidas reemplazadas por un fill */
+    uint64_t invalidations{0};  /**< Líneas invalidadas por INV_LINE */
+    uint64_t writes_absorbed{0};        /**< WRITE_MEM que se quedaron en el caché (write-back) */
+    uint64_t writes_sent{0};            /**< WRITE_MEM enviados al Interconnect */
+    uint64_t write_bytes_absorbed{0};   /**< Bytes de los WRITE_MEM absorbidos */
+    uint64_t write_bytes_sent{0};       /**< Bytes de los WRITE_MEM enviados */
+    uint64_t writebacks{0};             /**< Líneas sucias devueltas a memoria */
+};
 
 /**
  * @class LocalCache
  * @brief Representa un caché privado de un Processing Element (PE).
  *
- * Este caché consta de un número fijo de bloques (BLOCKS),
- * cada uno de un tamaño fijo en bytes (BLOCK_SIZE). Proporciona
- * métodos para inicializar su contenido con datos aleatorios y
- * volcar su estado a un archivo de texto para depuración.
+ * Caché asociativo por conjuntos con tags y política de reemplazo
+ * configurables. Las direcciones de memoria (en palabras de 32 bits) se
+ * mapean a línea = (addr * 4) / line_size, set = línea % sets y
+ * tag = línea / sets. Los datos viven en RAM, en frames de line_size bytes
+ * indexados por set * ways + way; las instrucciones WRITE_MEM y
+ * BROADCAST_INVALIDATE siguen refiriéndose a esas posiciones.
+ *
+ * Con Storage::MMAP los bloques viven en config/caches/cache_<id>.bin,
+ * mapeado con MappedFile, y persist() solo hace msync. Con InitMode::IMAGE
+ * el caché arranca con los datos de ese archivo en lugar de generarlos. Los
+ * tags y el estado MESI no se guardan; el caché arranca frío igual.
+ *
+ * Cada frame lleva su estado MESI en un MesiStateArray (2 bits atómicos por
+ * frame); una línea solo es válida si su tag coincide y su estado no es I.
+ * El Interconnect consulta (snoop) los caches desde su hilo, por lo que las
+ * operaciones que tocan tags o datos toman el mutex del caché; un INV_LINE
+ * solo cambia el estado y no lo necesita.
+ *
+ * Con WritePolicy::WRITE_BACK un WRITE_MEM cuyas líneas están todas en E o M
+ * se escribe solo en el caché y las deja en M, que hace de bit de suciedad.
+ * Una línea M que se desaloja (o que invalida un INV_LINE) pasa a un buffer
+ * de writeback hasta que el Interconnect atiende su WRITEBACK; los snoops
+ * entregan los datos sucios del rango (de los frames M o del buffer) para que
+ * lleguen a memoria antes que el acceso que los provocó.
  */
 class LocalCache {
 public:
-    static constexpr size_t BLOCKS = 128;       /**< Numero de bloques en el cache. */
-    static constexpr size_t BLOCK_SIZE = 16;    /**< Tamaño de cada bloque en bytes. */
+    static constexpr size_t BLOCK_SIZE = Geometry::BLOCK_SIZE;    /**< Bytes por bloque de datos de un Message. */
 
     /**
-     * @brief Construye un caché vacío con el número de bloques definido.
+     * @brief Construye el caché del PE; sus datos se llenan con initialize().
+     * @param id     ID del PE al que pertenece.
+     * @param config Geometría y política de reemplazo.
      */
-    LocalCache(int id);
+    LocalCache(int id, const CacheConfig& config = CacheConfig{});
 
 /* ---------------------------------------- Initializing --------------------------------------- */
 
     /**
-     * @brief Inicializa el cache llenandolo de forma aleatoria y lo vuelca.
+     * @brief Llena el caché según CacheConfig::init.
+     *
+     * Solo con InitMode::RANDOM (y Storage::HEAP) se vuelca el estado inicial.
+     * Toca únicamente los datos y archivos de este caché, así que los caches
+     * de varios PEs pueden inicializarse en paralelo.
      */
     void initialize();
 
     /**
-     * @brief Rellena el caché con datos aleatorios.
+     * @brief Rellena el caché con datos pseudoaleatorios (splitmix64).
      *
-     * Genera valores aleatorios de 0 a 255 para cada byte
-     * de cada bloque en el caché, usando un generador
-     * Mersenne Twister para asegurar calidad de entropía.
+     * Con InitMode::RANDOM la semilla sale de std::random_device; si no, es
+     * CacheConfig::seed con un flujo propio por PE, de modo que el contenido
+     * es reproducible y no depende del orden en que se inicialicen los caches.
      */
     void fill_random();
 
@@ -53,77 +181,215 @@ public:
      */
     void dump_to_text_file() const;
 
+    /**
+     * @brief Vuelca los bloques del caché, en crudo, a cache_<id>.bin.
+     * @throws std::runtime_error Si no se puede crear o escribir en el archivo.
+     */
+    void dump_to_binary_file() const;
+
+    /**
+     * @brief Guarda los datos del caché al terminar una simulación.
+     *
+     * Con Storage::MMAP fuerza la escritura de cache_<id>.bin; con
+     * Storage::HEAP escribe el volcado de texto y la imagen binaria.
+     */
+    void persist() const;
+
 /* --------------------------------------------------------------------------------------------- */
 
 /* --------------------------------------- Data Handling --------------------------------------- */ 
 
     /**
-     * @brief Lee un bloque de líneas de caché desde el fichero de volcado.
+     * @brief Busca en el caché las líneas que cubre un READ_MEM.
+     *
+     * En un hit actualiza el estado de reemplazo de cada línea. En un miss
+     * devuelve el rango alineado a línea que hay que pedir al Interconnect,
+     * desde la primera hasta la última línea ausente.
      *
-     * Abre el archivo de texto correspondiente al caché del PE indicado
-     * (../config/caches/cache_<id>.txt), salta hasta la línea de inicio
-     * especificada y lee el número de líneas indicado, parseando cada línea
-     * como bytes en notación hexadecimal.
+     * @param address Dirección en palabras de 32 bits.
+     * @param size    Bytes pedidos (0 se trata como 1).
+     * @return Resultado de la búsqueda.
+     */
+    CacheLookup lookup_read(uint64_t address, uint32_t size);
+
+    /**
+     * @brief Instala en el caché los datos de un READ_RESP.
      *
-     * Admite dos formatos de línea:
-     *  - Tokens hexadecimales separados por espacios (p. ej. "ab cd ef …").
-     *  - Cadena continua de dígitos hexadecimales (p. ej. "c80b…").
+     * @param address Dirección (palabras) alineada a línea de la respuesta.
+     * @param blocks  Bloques de BLOCK_SIZE bytes, line_size / BLOCK_SIZE por línea.
+     * @param shared  true si otro caché tiene copia (se instala en S, si no en E).
      *
-     * @param id         Identificador del PE (se corresponde con el nombre de fichero).
-     * @param start_line Índice (0-based) de la primera línea de caché a leer.
-     * @param num_lines  Número de líneas consecutivas que se desean leer.
-     * @return Vector de tamaño `num_lines`, donde cada entrada es un vector de
-     *         `BLOCK_SIZE` bytes leídos del caché.
+     * Una línea que ya está en M conserva sus datos: son más nuevos que los de
+     * la respuesta. Una víctima en M pasa al buffer de writeback.
      *
-     * @throws std::runtime_error   Si no se puede abrir el archivo o si el formato
-     *                              de alguna línea es inválido.
-     * @throws std::out_of_range    Si `start_line + ln` excede el número de líneas
-     *                              disponibles en el fichero.
+     * @throws std::invalid_argument si la dirección no está alineada o algún bloque
+     *                               no tiene BLOCK_SIZE bytes.
      */
-    static std::vector<std::vector<uint8_t>> read_cache_from_file(uint32_t id, 
-                                                                  uint32_t start_line, 
-                                                                  uint32_t num_lines);
+    void fill_lines(uint64_t address, const std::vector<std::vector<uint8_t>>& blocks,
+                    bool shared);
 
     /**
-     * @brief Sobrescribe una o más líneas en el fichero de caché del PE.
+     * @brief Lee bloques de datos del caché por posición, para un WRITE_MEM.
      *
-     * Lee todo el archivo de volcado de caché correspondiente al PE indicado,
-     * reemplaza las líneas a partir de `start_line` con los bytes proporcionados
-     * en `lines`, y luego escribe de nuevo todo el contenido al disco.
+     * @param start_line Primer bloque de BLOCK_SIZE bytes (igual al frame si line_size es 16).
+     * @param num_lines  Número de bloques consecutivos.
+     * @return Vector de `num_lines` bloques de BLOCK_SIZE bytes.
+     * @throws std::out_of_range si el rango excede la capacidad del caché.
+     */
+    std::vector<std::vector<uint8_t>> read_lines(uint32_t start_line, uint32_t num_lines) const;
+
+    /**
+     * @brief Invalida un frame del caché por un INV_LINE.
      *
-     * @param id          Identificador del PE (se usa para construir el nombre
-     *                    de fichero "cache_<id>.txt").
-     * @param start_line  Índice (0-based) de la primera línea a sobrescribir.
-     * @param lines       Vector de vectores de bytes, donde cada sub-vector
-     *                    representa exactamente BLOCK_SIZE bytes que reemplazarán
-     *                    a la línea correspondiente en el fichero.
+     * El frame pasa a I con una sola operación atómica (sin mutex ni disco),
+     * de modo que el próximo READ_MEM a esa dirección vuelve a ir al Interconnect.
+     * Con write-back toma el mutex: si el frame estaba en M sus datos pasan al
+     * buffer de writeback.
      *
-     * @throws std::runtime_error      Si no se puede abrir o escribir el fichero.
-     * @throws std::out_of_range      Si `start_line` o `start_line + lines.size()`
-     *                                exceden el número de líneas existentes.
-     * @throws std::invalid_argument  Si alguna de las entradas en `lines` no tiene
-     *                                exactamente BLOCK_SIZE bytes.
+     * @param line_index Frame (set * ways + way) a invalidar.
+     * @param pe_id      Identificador del Processing Element (PE), para el log.
+     *
+     * @note Si @p line_index está fuera de rango se imprime un mensaje de error
+     *       por std::cerr y la función retorna sin lanzar excepciones.
      */
-    static void write_cache_lines(uint32_t id, uint32_t start_line,
-                                    const std::vector<std::vector<uint8_t>>& lines);
+    void invalidate_line(uint32_t line_index, int pe_id);
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ---------------------------------------- Coherence ------------------------------------------ */
 
     /**
-     * @brief Invalida una línea específica en el archivo de estado de caché de un PE.
+     * @brief Snoop de una lectura de otro PE: las copias E/M del rango bajan a S.
+     * @param address Dirección en palabras.
+     * @param size    Bytes leídos.
+     */
+    SnoopResult snoop_read(uint64_t address, uint32_t size);
+
+    /**
+     * @brief Copia los datos de un rango para responder el READ_MEM de otro PE.
      *
-     * Esta función abre el fichero de invalidación correspondiente al PE
-     * ("config/caches/inv_cache_<pe_id>.txt"), marca la línea indicada
-     * escribiendo "1" en esa posición y reescribe todo el archivo con la
-     * modificación. Sirve para reflejar que esa línea de caché ha sido invalidada.
+     * Solo responde si tiene válidas todas las líneas del rango; no cambia el
+     * estado MESI (eso lo hace snoop_read).
      *
-     * @param line_index Índice (0-based) de la línea a invalidar en el fichero.
-     * @param pe_id      Identificador del Processing Element (PE) cuyo fichero
-     *                   de invalidaciones se va a modificar.
+     * @param address Dirección en palabras, alineada a bloque de 16 bytes.
+     * @param size    Bytes pedidos.
+     * @param blocks  [out] Bloques de 16 bytes desde @p address.
+     * @return true si pudo responder.
+     */
+    bool supply_lines(uint64_t address, uint32_t size,
+                      std::vector<std::vector<uint8_t>>& blocks) const;
+
+    /**
+     * @brief Snoop de una escritura de otro PE: las copias del rango pasan a I.
+     * @param address Dirección en palabras.
+     * @param size    Bytes escritos.
+     */
+    SnoopResult snoop_write(uint64_t address, uint32_t size);
+
+    /**
+     * @brief Aplica al caché del escritor un WRITE_MEM propio.
+     *
+     * Las líneas del rango que tenga se actualizan con los datos escritos y,
+     * si estaban en S, suben a E (upgrade); las que no tiene no se asignan.
      *
-     * @note En caso de no poder abrir el fichero o si @p line_index está fuera
-     *       de rango, se imprime un mensaje de error por std::cerr y la función
-     *       retorna sin lanzar excepciones.
+     * @param address Dirección en palabras del WRITE_MEM.
+     * @param blocks  Bloques de BLOCK_SIZE bytes escritos en memoria.
      */
-    void invalidate_line(uint32_t line_index, int pe_id);
+    SnoopResult apply_write(uint64_t address, const std::vector<std::vector<uint8_t>>& blocks);
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ---------------------------------------- Write-back ----------------------------------------- */
+
+    /**
+     * @brief Intenta completar un WRITE_MEM dentro del caché.
+     *
+     * Solo con WritePolicy::WRITE_BACK, con la dirección alineada a bloque y
+     * con todas las líneas del rango en E o M: copia los bloques y deja las
+     * líneas en M. En cualquier otro caso no toca nada y el PE debe enviar el
+     * WRITE_MEM al Interconnect. Cuenta la escritura como absorbida o enviada.
+     *
+     * @param address Dirección en palabras del WRITE_MEM.
+     * @param blocks  Bloques de BLOCK_SIZE bytes a escribir.
+     * @return true si la escritura quedó en el caché.
+     */
+    bool absorb_write(uint64_t address, const std::vector<std::vector<uint8_t>>& blocks);
+
+    /**
+     * @brief Líneas que entraron al buffer de writeback desde la última llamada.
+     *
+     * El PE envía un WRITEBACK por cada una; los datos se quedan en el buffer
+     * hasta que el Interconnect los pide con take_writeback().
+     * @return Dirección (palabras) de cada línea.
+     */
+    std::vector<uint64_t> take_evicted();
+
+    /**
+     * @brief Saca del buffer de writeback la línea que empieza en @p address.
+     * @param blocks [out] Datos de la línea.
+     * @return false si un snoop ya la escribió en memoria.
+     */
+    bool take_writeback(uint64_t address, std::vector<std::vector<uint8_t>>& blocks);
+
+    /**
+     * @brief Saca del buffer de writeback las líneas de un rango.
+     *
+     * Para el propio PE, que no se consulta con snoop_read: su lectura no
+     * debe adelantarse a sus propios writebacks pendientes.
+     */
+    std::vector<Writeback> take_buffered(uint64_t address, uint32_t size);
+
+    /**
+     * @brief Entrega todos los datos sucios al terminar la simulación.
+     *
+     * Las líneas M pasan a E y el buffer de writeback queda vacío.
+     */
+    std::vector<Writeback> flush_dirty();
+
+    /** @brief Estado MESI de un frame (set * ways + way). */
+    MesiState get_state(uint32_t frame) const;
+
+    /** @brief Letra del estado (M, E, S, I). */
+    static char state_to_char(MesiState state);
+
+    /**
+     * @brief Vuelca el estado MESI de cada frame a config/caches/inv_cache_<id>.txt.
+     *
+     * Solo se usa para depuración (opción del menú); la simulación nunca
+     * escribe este archivo por sí sola.
+     *
+     * @throws std::runtime_error Si no se puede crear el archivo.
+     */
+    void dump_state_to_text_file() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ----------------------------------- Getters & Setters --------------------------------------- */
+
+    /** @brief Geometría del caché. */
+    const CacheConfig& get_config() const;
+
+    /** @brief Copia de los contadores de hits, misses, fills, evictions e invalidaciones. */
+    CacheStats get_stats() const;
+
+    /** @brief Número de frames (sets * ways). */
+    uint32_t frames() const;
+
+    /** @brief Número de bloques de BLOCK_SIZE bytes (capacidad / 16). */
+    uint32_t blocks() const;
+
+    /** @brief true si la línea @p line tiene copia válida en el caché. */
+    bool contains_line(uint64_t line) const;
+
+    /** @brief Dirección (palabras) en la que empieza la línea @p line. */
+    uint64_t line_address(uint64_t line) const;
+
+    /** @brief Línea que contiene la dirección @p address (palabras). */
+    uint64_t line_of(uint64_t address) const;
+
+    /** @brief Prefetcher del caché, o nullptr si está apagado. */
+    Prefetcher* get_prefetcher();
+    const Prefetcher* get_prefetcher() const;
 
 /* --------------------------------------------------------------------------------------------- */
 
@@ -137,7 +403,7 @@ public:
      *
      * @param start_line Índice de la primera línea a leer (0-based).
      * @param num_of_lines Cantidad de líneas a leer.
-     * @throws std::out_of_range Si el rango excede BLOCKS.
+     * @throws std::out_of_range Si el rango excede blocks().
      */
     void read_test(uint32_t start_line, uint32_t num_lines) const;
 
@@ -146,9 +412,68 @@ public:
 private:
     int id_;                            /**< ID del PE al que pertenece. */
     std::string dump_path;              /**< Directorio donde se volcara el cache. */
+    std::string image_path;             /**< Imagen binaria del caché (cache_<id>.bin). */
     std::string inv_path;
 
-    std::vector<std::array<uint8_t, BLOCK_SIZE>> cache_data; /**< vector de bloques, cada uno es un array de bytes. */
+    CacheConfig config_;                /**< Geometría del caché. */
+    TagStore    tags_;                  /**< Tags, validez y reemplazo por frame. */
+    CacheStats  stats_;                 /**< Contadores de uso. */
+    uint32_t    blocks_per_line_;       /**< line_size / BLOCK_SIZE. */
+
+    std::vector<std::array<uint8_t, BLOCK_SIZE>> heap_data_;  /**< Bloques con Storage::HEAP. */
+    MappedFile image_;                  /**< cache_<id>.bin mapeado con Storage::MMAP. */
+    std::span<std::array<uint8_t, BLOCK_SIZE>> cache_data;   /**< Bloques en uso (heap_data_ o image_), cada uno es un array de bytes. */
+    MesiStateArray         state_;      /**< Estado MESI por frame, 2 bits atómicos. */
+    std::unique_ptr<Prefetcher> prefetcher_; /**< Prefetcher (nullptr si prefetch: off). */
+    std::atomic<uint64_t>  invalidations_{0}; /**< Copias perdidas por INV_LINE o snoop de escritura. */
+    std::map<uint64_t, std::vector<std::vector<uint8_t>>> writeback_buffer_;  /**< Línea -> datos sucios desalojados. */
+    std::vector<uint64_t>  evicted_;    /**< Líneas del buffer sin WRITEBACK enviado. */
+    mutable std::mutex     mtx_;        /**< Protege datos y tags (PE vs snoops del IC). */
+
+    /**
+     * @brief Carga cache_<id>.bin como datos iniciales.
+     * @return false (con un aviso) si no hay una imagen del tamaño del caché.
+     */
+    bool load_image();
+
+    /** @brief Rango [first, last] de líneas que cubre un acceso. */
+    void line_range(uint64_t address, uint32_t size, uint64_t& first, uint64_t& last) const;
+
+    /** @brief Busca una línea; devuelve el frame o -1 si no hay copia válida. */
+    int64_t find_frame(uint64_t line) const;
+
+    /** @brief Pasa un frame a I y cuenta la invalidación si tenía copia. */
+    void invalidate_frame(size_t frame);
+
+    /**
+     * @brief Vía de @p set donde instalar una línea nueva.
+     *
+     * Prefiere un frame en I, aunque su tag siga válido tras un INV_LINE; solo
+     * si todas las vías tienen copia decide la política de reemplazo.
+     */
+    uint32_t replacement_way(uint32_t set);
+
+    /** @brief Línea guardada en un frame (según su tag). */
+    uint64_t line_of_frame(size_t frame) const;
+
+    /** @brief Copia los datos de un frame para escribirlos en memoria. */
+    Writeback frame_writeback(size_t frame) const;
+
+    /** @brief Mueve al buffer de writeback una línea M que deja el caché. */
+    void buffer_victim(size_t frame);
+
+    /** @brief Agrega a @p out las líneas del buffer en [first, last] y las quita del buffer. */
+    void take_buffered_lines(uint64_t first, uint64_t last, std::vector<Writeback>& out);
+
+    /** @brief Cuerpo de fill_lines para una geometría de línea (fija o en tiempo de ejecución). */
+    template <typename LineGeo>
+    void fill_lines_with(const LineGeo& geo, uint64_t address,
+                         const std::vector<std::vector<uint8_t>>& blocks, bool shared);
+
+    /** @brief Cuerpo de supply_lines para una geometría de línea. */
+    template <typename LineGeo>
+    bool supply_lines_with(const LineGeo& geo, uint64_t address, uint32_t size,
+                           std::vector<std::vector<uint8_t>>& blocks) const;
 };
 
 #endif // LOCAL_CACHE_H
@@ -0,0 +1,156 @@
+#ifndef MEMORY_CONTROLLER_H
+#define MEMORY_CONTROLLER_H
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include "../Message.h"
+#include "Shared_Memory.h"
+
+/**
+ * @enum SchedulePolicy
+ * @brief Orden en que el controlador de memoria despacha las peticiones en cola.
+ */
+enum class SchedulePolicy {
+    FCFS,           /**< En orden de llegada: la más antigua bloquea a las demás */
+    FR_FCFS,        /**< First-ready: primero las que aciertan en la fila abierta, luego la más antigua */
+    QOS_FR_FCFS     /**< Como FR_FCFS, pero antes que nada el QoS más alto */
+};
+
+/**
+ * @struct ControllerConfig
+ * @brief Colas y política del controlador de memoria, claves mc_* de config/memory.txt.
+ */
+struct ControllerConfig {
+    bool           enabled{false};                  /**< Sin controlador cada acceso reserva sus bancos al llegar */
+    SchedulePolicy policy{SchedulePolicy::FR_FCFS}; /**< Política de despacho */
+    uint32_t       read_queue{32};                  /**< Entradas de la cola de lecturas */
+    uint32_t       write_queue{32};                 /**< Entradas de la cola de escrituras */
+    uint32_t       write_high{24};                  /**< Escrituras en cola que disparan un drenado */
+    uint32_t       write_low{8};                    /**< Escrituras en cola con las que el drenado termina */
+    uint32_t       max_age{1000};                   /**< Ciclos de espera que pasan por delante de todo (0 = nunca) */
+
+    /**
+     * @brief Carga la configuración desde un archivo "clave: valor".
+     *
+     * Claves: mc_policy (off|fcfs|frfcfs|qos_frfcfs), mc_read_queue,
+     * mc_write_queue, mc_write_high, mc_write_low y mc_max_age. Las ausentes
+     * conservan su valor por defecto.
+     *
+     * @throws std::invalid_argument si algún valor es inválido.
+     */
+    static ControllerConfig load_from_file(const std::string& filename);
+
+    /** @brief Nombre de la política ("fcfs", "frfcfs" o "qos_frfcfs"). */
+    static std::string policy_to_string(SchedulePolicy policy);
+};
+
+/**
+ * @struct MemoryRequest
+ * @brief Acceso a memoria esperando en una cola del controlador.
+ *
+ * Los datos ya se leyeron o escribieron al encolarse (en el orden del
+ * Interconnect); el controlador solo decide cuándo ocupa los bancos.
+ */
+struct MemoryRequest {
+    uint64_t                                first_word{0};  /**< Primera palabra del acceso */
+    uint64_t                                words{0};       /**< Palabras del acceso */
+    bool                                    write{false};   /**< Cola de escrituras o de lecturas */
+    uint8_t                                 qos{0};         /**< QoS del PE que lo originó */
+    uint64_t                                arrival{0};     /**< Ciclo en que entró a la cola */
+    std::function<std::vector<uint32_t>()>  issue;          /**< Reserva los bancos y devuelve el servicio de cada respuesta */
+    std::vector<Message>                    responses;      /**< Respuestas que salen cuando el acceso termina */
+};
+
+/**
+ * @struct ControllerStats
+ * @brief Contadores del controlador de memoria.
+ */
+struct ControllerStats {
+    uint64_t reads{0};              /**< Lecturas despachadas */
+    uint64_t writes{0};             /**< Escrituras despachadas */
+    uint64_t read_wait{0};          /**< Ciclos acumulados en la cola de lecturas */
+    uint64_t write_wait{0};         /**< Ciclos acumulados en la cola de escrituras */
+    uint64_t row_hit_issues{0};     /**< Despachos que encontraron todas sus filas abiertas */
+    uint64_t aged_issues{0};        /**< Despachos adelantados por superar max_age */
+    uint64_t drains{0};             /**< Lotes de escrituras drenados */
+    uint64_t full_stalls{0};        /**< Ciclos en que el Interconnect esperó por una cola llena */
+    size_t   max_reads{0};          /**< Ocupación máxima de la cola de lecturas */
+    size_t   max_writes{0};         /**< Ocupación máxima de la cola de escrituras */
+    std::map<uint8_t, std::pair<uint64_t, uint64_t>> qos_wait;  /**< QoS -> (despachos, ciclos de espera) */
+};
+
+/**
+ * @class MemoryController
+ * @brief Etapa de planificación entre el Interconnect y los bancos de SharedMemory.
+ *
+ * Las lecturas y escrituras esperan en colas separadas y de tamaño fijo;
+ * cuando una se llena el Interconnect deja de sacar peticiones de ese tipo.
+ * Una petición solo se despacha cuando todos sus bancos están libres, a lo
+ * sumo una por ciclo (el bus de comandos). Las escrituras se acumulan y se
+ * drenan en lotes: al llegar a write_high el controlador atiende solo
+ * escrituras hasta bajar a write_low, y también las drena si no hay lecturas.
+ *
+ * Con FCFS solo puede salir la petición más antigua de la cola activa. Con
+ * FR_FCFS sale, entre las que tienen sus bancos libres, la que acierta en las
+ * filas abiertas de la DRAM y, a igualdad, la más antigua (sin DRAM no hay
+ * filas abiertas y queda en first-ready). QOS_FR_FCFS antepone el QoS más alto.
+ * En ambas, una petición que lleva max_age ciclos esperando pasa primero.
+ */
+class MemoryController {
+public:
+    /**
+     * @param config Colas y política.
+     * @param memory Memoria cuyos bancos y filas se consultan para elegir.
+     */
+    MemoryController(const ControllerConfig& config, const SharedMemory& memory);
+
+    /** @brief true si la cola de escrituras (o de lecturas) admite otra petición. */
+    bool can_accept(bool write) const;
+
+    /** @brief Encola una petición; la cola correspondiente no debe estar llena. */
+    void enqueue(MemoryRequest request);
+
+    /**
+     * @brief Elige la petición a despachar en el ciclo @p now, si hay alguna.
+     *
+     * La petición elegida sale de su cola y llama a su callback issue(); a cada
+     * respuesta se le suma la espera en cola y su propio servicio.
+     *
+     * @param now    Ciclo actual del Interconnect.
+     * @param issued [out] Petición despachada, con sus respuestas listas.
+     * @return false si ninguna petición puede salir en este ciclo.
+     */
+    bool dispatch(uint64_t now, MemoryRequest& issued);
+
+    /** @brief Cuenta un ciclo en que el Interconnect no pudo encolar. */
+    void record_full_stall();
+
+    /** @brief true si no queda ninguna petición en cola. */
+    bool empty() const;
+
+    /** @brief Configuración en uso. */
+    const ControllerConfig& get_config() const { return config_; }
+
+    /** @brief Contadores acumulados. */
+    const ControllerStats& get_stats() const { return stats_; }
+
+private:
+    /** @brief Entra o sale del modo de drenado de escrituras según las colas. */
+    void update_drain_mode();
+
+    /** @brief Índice de la petición a despachar en @p queue, o -1 si ninguna está lista. */
+    long select(const std::deque<MemoryRequest>& queue, uint64_t now, bool& row_hit, bool& aged) const;
+
+    ControllerConfig            config_;            /**< Colas y política. */
+    const SharedMemory&         memory_;            /**< Bancos y filas a consultar. */
+    std::deque<MemoryRequest>   reads_;             /**< Cola de lecturas, en orden de llegada. */
+    std::deque<MemoryRequest>   writes_;            /**< Cola de escrituras, en orden de llegada. */
+    bool                        draining_{false};   /**< Atendiendo un lote de escrituras. */
+    ControllerStats             stats_;             /**< Contadores acumulados. */
+};
+
+#endif // MEMORY_CONTROLLER_H
@@ -0,0 +1,94 @@
+#ifndef MESI_STATE_ARRAY_H
+#define MESI_STATE_ARRAY_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @enum MesiState
+ * @brief Estado de coherencia MESI de un frame del caché.
+ *
+ * Los valores son los 2 bits que se guardan en MesiStateArray.
+ */
+enum class MesiState : uint8_t {
+    INVALID   = 0,  /**< Sin copia válida: el próximo acceso es un miss */
+    SHARED    = 1,  /**< Copia limpia que otros caches pueden tener */
+    EXCLUSIVE = 2,  /**< Única copia, limpia */
+    MODIFIED  = 3   /**< Única copia, distinta de la memoria */
+};
+
+/**
+ * @class MesiStateArray
+ * @brief Estados MESI empaquetados a 2 bits por frame en palabras atómicas de 64 bits.
+ *
+ * Cada palabra guarda 32 frames. Invalidar es un solo fetch_and, de modo que
+ * un INV_LINE no necesita tomar el mutex del caché ni tocar disco; las
+ * transiciones que dependen del estado previo (downgrade, upgrade, store) usan
+ * compare_exchange sobre la palabra.
+ */
+class MesiStateArray {
+public:
+    static constexpr size_t STATES_PER_WORD = 32;   /**< Frames por palabra de 64 bits. */
+
+    /**
+     * @brief Crea el arreglo con todos los frames en INVALID.
+     * @param frames Número de frames.
+     */
+    explicit MesiStateArray(size_t frames);
+
+    /** @brief Lee el estado de un frame. */
+    MesiState load(size_t frame) const;
+
+    /** @brief Escribe el estado de un frame. */
+    void store(size_t frame, MesiState state);
+
+    /**
+     * @brief Pasa un frame a INVALID con un fetch_and.
+     * @return Estado que tenía antes.
+     */
+    MesiState invalidate(size_t frame);
+
+    /**
+     * @brief E/M -> S.
+     * @return true si el frame estaba en E o M.
+     */
+    bool downgrade(size_t frame);
+
+    /**
+     * @brief S -> E.
+     * @return true si el frame estaba en S.
+     */
+    bool upgrade(size_t frame);
+
+    /**
+     * @brief E/M -> M, para una escritura que se queda en el caché.
+     * @return true si el frame estaba en E o M.
+     */
+    bool modify(size_t frame);
+
+    /**
+     * @brief M -> E, cuando los datos sucios ya se escribieron en memoria.
+     * @return true si el frame estaba en M.
+     */
+    bool clean(size_t frame);
+
+    /** @brief Número de frames. */
+    size_t size() const;
+
+private:
+    size_t                                   frames_;   /**< Número de frames. */
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;    /**< 2 bits por frame. */
+
+    /**
+     * @brief Cambia el estado con CAS si el actual cumple @p from.
+     * @param from Predicado sobre el estado actual.
+     * @param to   Estado nuevo.
+     * @return true si se hizo el cambio.
+     */
+    template <typename Pred>
+    bool transition(size_t frame, Pred from, MesiState to);
+};
+
+#endif // MESI_STATE_ARRAY_H
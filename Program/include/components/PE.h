@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <deque>
 #include "Instruction_Memory.h"
 #include "../Message.h"
 
@@ -23,6 +24,28 @@ enum class PEResponseState {
     COMPLETED    /**< Procesó la respuesta y está listo para avanzar. */
 };
 
+/**
+ * @struct MSHREntry
+ * @brief Entrada de la tabla de peticiones en vuelo (miss-status table) de un PE.
+ */
+struct MSHREntry {
+    uint32_t    tag;            /**< Tag de la petición, único dentro del PE. */
+    Operation   operation;      /**< Operación emitida. */
+    uint64_t    address;        /**< Dirección (o línea de caché en un broadcast). */
+};
+
+/**
+ * @struct MSHRStats
+ * @brief Contadores de la ventana de peticiones en vuelo de un PE.
+ */
+struct MSHRStats {
+    uint64_t    issued{0};              /**< Peticiones emitidas. */
+    uint64_t    completed{0};           /**< Peticiones retiradas con su respuesta. */
+    uint64_t    out_of_order{0};        /**< Respuestas que llegaron antes que una petición más vieja. */
+    uint64_t    window_full_steps{0};   /**< Pasos en los que no se pudo emitir por ventana llena. */
+    size_t      max_outstanding{0};     /**< Máximo de peticiones en vuelo a la vez. */
+};
+
 /**
  * @class PE
  * @brief Processing Element con QoS, contador de programa, instrucción actual
@@ -34,10 +57,11 @@ public:
 
     /**
      * @brief Construye un PE con identificador y QoS.
-     * @param id  Identificador único del PE.
-     * @param qos Calidad de servicio (0x00–0xFF).
+     * @param id              Identificador único del PE.
+     * @param qos             Calidad de servicio (0x00–0xFF).
+     * @param max_outstanding Peticiones que puede tener en vuelo a la vez (1 = bloqueante).
      */
-    PE(int id, uint8_t qos);
+    PE(int id, uint8_t qos, size_t max_outstanding = 1);
 
     /** @brief Incrementa el Program Counter en 1. */
     void pc_plus_4();
@@ -45,20 +69,56 @@ public:
     /**
      * @brief Convierte una instrucción alojada en InstructionMemory en un Message.
      *
-     * Recupera la cadena binaria de 64 bits almacenada en la posición
-     * `instruction_index` de la InstructionMemory, la interpreta como un
-     * entero de 64 bits, extrae los distintos campos (opcode, src, addr,
-     * tamaño, líneas de caché, QoS, etc.) según el formato definido en la
-     * especificación, y construye el Message correspondiente con la
-     * operación adecuada (WRITE_MEM, READ_MEM, BROADCAST_INVALIDATE…).
+     * Toma la instrucción de 64 bits en la posición `instruction_index` de la
+     * InstructionMemory y la decodifica con InstructionFormat::decode (la misma
+     * tabla con la que codifica el Compiler) para construir el Message con la
+     * operación adecuada (WRITE_MEM, READ_MEM, BROADCAST_INVALIDATE…). Un
+     * opcode sin formato da un Message UNDEFINED que solo conserva el SRC.
      *
      * @param instruction_index Índice (0-based) de la instrucción a convertir.
      * @return Message completo con todos los campos decodificados.
      * @throws std::out_of_range Si instruction_index está fuera del rango válido.
-     * @throws std::invalid_argument Si la instrucción no cumple el formato esperado.
      */
     Message convert_to_message(int instruction_index);
 
+/* ------------------------------------ Outstanding Requests ----------------------------------- */
+
+    /** @brief Devuelve true si queda espacio en la ventana para emitir otra petición. */
+    bool can_issue() const;
+
+    /**
+     * @brief Registra una petición en la tabla de peticiones en vuelo.
+     *
+     * Asigna un tag nuevo al mensaje; la respuesta del Interconnect lo trae de
+     * vuelta y con él se retira la entrada, sin importar el orden de llegada.
+     *
+     * @param msg Petición a emitir (se le asigna el tag).
+     * @return Tag asignado.
+     * @throws std::runtime_error si la ventana ya está llena.
+     */
+    uint32_t track_request(Message& msg);
+
+    /**
+     * @brief Retira de la tabla la petición con el tag indicado.
+     * @param tag Tag que trae la respuesta.
+     * @return true si el tag estaba en vuelo.
+     */
+    bool complete_request(uint32_t tag);
+
+    /** @brief Cantidad de peticiones en vuelo. */
+    size_t outstanding() const;
+
+    /** @brief Tamaño de la ventana de peticiones en vuelo. */
+    size_t get_max_outstanding() const;
+
+    /** @brief Cuenta un paso en el que el PE no pudo emitir por tener la ventana llena. */
+    void record_window_full();
+
+    /** @brief Contadores de la ventana de peticiones. */
+    const MSHRStats& get_mshr_stats() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
 /* ----------------------------------- Getters & Setters --------------------------------------- */
 
     /** @brief Devuelve el identificador del PE. */
@@ -128,4 +188,9 @@ private:
     uint64_t            pc_;                    /**< Program Counter. */
     uint64_t            actual_instruction_;    /**< Instrucción de 64 bits. */
     Message             actual_message_;        /**< Mensaje de prueba para debug. */
+
+    size_t                  max_outstanding_;   /**< Tamaño de la ventana de peticiones. */
+    std::deque<MSHREntry>   mshr_;              /**< Peticiones en vuelo, en orden de emisión. */
+    uint32_t                next_tag_{1};       /**< Próximo tag (0 = sin tag). */
+    MSHRStats               mshr_stats_;        /**< Contadores de la ventana. */
 };
@@ -0,0 +1,111 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+class ConfigFile;
+
+/**
+ * @enum PrefetchMode
+ * @brief Tipo de prefetch del caché local.
+ */
+enum class PrefetchMode {
+    OFF,        /**< Solo lecturas por demanda */
+    NEXT_LINE,  /**< Siempre las N líneas siguientes */
+    STRIDE      /**< Stride detectado por PE; sin stride estable, las N siguientes */
+};
+
+/**
+ * @struct PrefetchConfig
+ * @brief Parámetros del prefetcher (claves prefetch* de config/cache.txt).
+ */
+struct PrefetchConfig {
+    PrefetchMode mode{PrefetchMode::OFF};   /**< Tipo de prefetch */
+    uint32_t     degree{2};                 /**< Líneas a adelantar por acceso */
+    uint32_t     max_inflight{4};           /**< Prefetches en vuelo como máximo */
+    uint8_t      qos{0};                    /**< QoS de los READ_MEM de prefetch */
+
+    /**
+     * @brief Lee las claves prefetch, prefetch_degree, prefetch_max_inflight y prefetch_qos.
+     * @throws std::invalid_argument si algún valor es inválido.
+     */
+    static PrefetchConfig from_config(const ConfigFile& cfg);
+};
+
+/**
+ * @struct PrefetchStats
+ * @brief Contadores para medir si el prefetch compensa.
+ */
+struct PrefetchStats {
+    uint64_t issued{0};         /**< Líneas pedidas por prefetch */
+    uint64_t useful{0};         /**< Líneas de prefetch que luego usó una lectura por demanda */
+    uint64_t late{0};           /**< Misses por demanda a una línea con prefetch aún en vuelo */
+    uint64_t bytes{0};          /**< Bytes pedidos al Interconnect por prefetch */
+};
+
+/**
+ * @class Prefetcher
+ * @brief Motor de prefetch next-N-line / stride asociado al caché local de un PE.
+ *
+ * Se entrena con cada READ_MEM por demanda (la primera línea que toca) y
+ * propone líneas a pedir por adelantado. Lleva las líneas en vuelo y las ya
+ * instaladas sin usar, para calcular exactitud y cobertura. Solo lo usa el
+ * hilo de su PE.
+ */
+class Prefetcher {
+public:
+    /** @brief Repeticiones seguidas del mismo stride para empezar a usarlo. */
+    static constexpr uint32_t STRIDE_CONFIDENCE = 2;
+
+    explicit Prefetcher(const PrefetchConfig& config);
+
+    /**
+     * @brief Registra un READ_MEM por demanda y devuelve las líneas a prefetchear.
+     *
+     * Cuenta como útiles las líneas del acceso que habían llegado por prefetch
+     * y como tardíos los misses a líneas con prefetch en vuelo.
+     *
+     * @param first_line Primera línea del acceso.
+     * @param last_line  Última línea del acceso.
+     * @param miss_first Primera línea ausente (si @p miss).
+     * @param miss_last  Última línea ausente (si @p miss).
+     * @param miss       true si el acceso no se sirvió del caché.
+     * @return Líneas candidatas (sin filtrar contra el contenido del caché).
+     */
+    std::vector<uint64_t> on_demand_access(uint64_t first_line, uint64_t last_line,
+                                           uint64_t miss_first, uint64_t miss_last, bool miss);
+
+    /** @brief true si se puede emitir otro prefetch y la línea no está ya pendiente. */
+    bool can_issue(uint64_t line) const;
+
+    /** @brief Registra un prefetch emitido de @p bytes bytes. */
+    void on_issue(uint64_t line, uint32_t bytes);
+
+    /** @brief La respuesta del prefetch llegó y la línea quedó instalada. */
+    void on_fill(uint64_t line);
+
+    /** @brief Prefetches en vuelo. */
+    size_t inflight() const;
+
+    const PrefetchConfig& get_config() const;
+    const PrefetchStats&  get_stats() const;
+
+    /** @brief Nombre del modo, para reportes. */
+    static const char* mode_to_string(PrefetchMode mode);
+
+private:
+    PrefetchConfig               config_;           /**< Parámetros. */
+    PrefetchStats                stats_;            /**< Contadores. */
+    std::unordered_set<uint64_t> inflight_;         /**< Líneas pedidas sin respuesta aún. */
+    std::unordered_set<uint64_t> unused_;           /**< Líneas instaladas por prefetch sin usar. */
+
+    bool     has_last_{false};      /**< Ya hubo un acceso anterior. */
+    uint64_t last_line_{0};         /**< Primera línea del acceso anterior. */
+    int64_t  stride_{0};            /**< Último stride observado (en líneas). */
+    uint32_t confidence_{0};        /**< Veces seguidas que se repitió el stride. */
+};
+
+#endif // PREFETCHER_H
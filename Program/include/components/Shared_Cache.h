@@ -0,0 +1,163 @@
+#ifndef SHARED_CACHE_H
+#define SHARED_CACHE_H
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include "Tag_Store.h"
+#include "Shared_Memory.h"
+
+/**
+ * @struct SharedCacheConfig
+ * @brief Geometría del caché compartido (L2), claves l2* de config/memory.txt.
+ */
+struct SharedCacheConfig {
+    bool        enabled{false};                 /**< Sin L2 el Interconnect va directo a SharedMemory */
+    uint32_t    size{4096};                     /**< Capacidad en bytes */
+    uint32_t    ways{8};                        /**< Vías por conjunto */
+    uint32_t    banks{4};                       /**< Bancos (interleaving por conjunto) */
+    uint32_t    hit_latency{4};                 /**< Ciclos de un acierto en un banco */
+    Replacement replacement{Replacement::LRU};  /**< Política de reemplazo */
+
+    /** @brief Conjuntos: size / (16 * ways). */
+    uint32_t sets() const;
+
+    /**
+     * @brief Carga la configuración desde un archivo "clave: valor".
+     *
+     * Claves: l2 (on|off), l2_size, l2_ways, l2_banks, l2_hit_latency y
+     * l2_replacement (lru|plru|random). Las ausentes conservan su valor por
+     * defecto.
+     *
+     * @throws std::invalid_argument si la geometría no es válida.
+     */
+    static SharedCacheConfig load_from_file(const std::string& filename);
+};
+
+/**
+ * @struct SharedCacheAccess
+ * @brief Efecto de un acceso al L2, para calcular su latencia.
+ */
+struct SharedCacheAccess {
+    uint32_t              hits{0};          /**< Líneas encontradas en el L2 */
+    uint32_t              misses{0};        /**< Líneas ausentes */
+    std::vector<uint64_t> fill_lines;       /**< Líneas que hubo que leer de SharedMemory */
+    std::vector<uint64_t> writeback_lines;  /**< Víctimas sucias escritas en SharedMemory */
+};
+
+/**
+ * @struct SharedCacheStats
+ * @brief Contadores acumulados del L2.
+ */
+struct SharedCacheStats {
+    uint64_t read_hits{0};          /**< Líneas leídas desde el L2 */
+    uint64_t read_misses{0};        /**< Líneas leídas que no estaban */
+    uint64_t write_hits{0};         /**< Líneas escritas que estaban */
+    uint64_t write_misses{0};       /**< Líneas escritas que no estaban */
+    uint64_t fills{0};              /**< Líneas traídas de SharedMemory */
+    uint64_t writebacks{0};         /**< Líneas sucias devueltas a SharedMemory (incluye flush) */
+    uint64_t bypassed{0};           /**< Líneas fuera de la memoria, servidas sin cachear */
+};
+
+/**
+ * @struct SharedCacheBank
+ * @brief Ocupación de un banco del L2.
+ */
+struct SharedCacheBank {
+    uint64_t busy_until{0};         /**< Ciclo en el que el banco queda libre */
+    uint64_t accesses{0};           /**< Accesos atendidos */
+    uint64_t conflicts{0};          /**< Accesos que encontraron el banco ocupado */
+};
+
+/**
+ * @class SharedCache
+ * @brief Caché compartido de último nivel entre el Interconnect y SharedMemory.
+ *
+ * Asociativo por conjuntos con líneas de 16 bytes (las de SharedMemory) y
+ * write-back: las escrituras quedan sucias en el L2 y solo llegan a memoria al
+ * desalojarse o con flush(). Un miss de escritura que no cubre la línea
+ * completa la trae primero de memoria. Los conjuntos se reparten entre bancos
+ * que atienden en paralelo. Solo lo usa el hilo del Interconnect.
+ */
+class SharedCache {
+public:
+    static constexpr uint32_t LINE_SIZE = SharedMemory::LINE_WORDS * 4;    /**< Bytes por línea. */
+
+    /**
+     * @brief Construye un L2 vacío sobre @p memory.
+     * @throws std::invalid_argument si la geometría no es válida.
+     */
+    SharedCache(const SharedCacheConfig& config, SharedMemory& memory);
+
+/* --------------------------------------- Data Handling --------------------------------------- */
+
+    /**
+     * @brief Lee como SharedMemory::read_shared_memory, pasando por el L2.
+     * @param address    Palabra inicial (0-based).
+     * @param size_bytes Bytes a leer; se redondea a bloques de 16.
+     * @param access     [out] Hits, misses, fills y writebacks del acceso.
+     * @return Bloques de 16 bytes a partir de @p address.
+     */
+    std::vector<std::vector<uint8_t>> read(size_t address, size_t size_bytes,
+                                           SharedCacheAccess& access);
+
+    /**
+     * @brief Escribe como SharedMemory::write_shared_memory_lines, dejando las líneas sucias.
+     * @param blocks  Bloques de 16 bytes.
+     * @param address Palabra inicial (0-based).
+     * @param access  [out] Hits, misses, fills y writebacks del acceso.
+     * @throws Lo mismo que SharedMemory::check_write(); en ese caso el L2 no cambia.
+     */
+    void write(const std::vector<std::vector<uint8_t>>& blocks, size_t address,
+               SharedCacheAccess& access);
+
+    /**
+     * @brief Escribe en memoria todas las líneas sucias (quedan limpias y válidas).
+     * @return Líneas escritas.
+     */
+    uint64_t flush();
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ------------------------------------------- Banks ------------------------------------------- */
+
+    /** @brief Banco que atiende una línea. */
+    uint32_t bank_of(uint64_t line) const;
+
+    /**
+     * @brief Reserva los bancos del L2 que toca un acceso.
+     *
+     * Cada banco sirve sus líneas en hit_latency + (líneas - 1) ciclos y
+     * empieza cuando queda libre; el acceso termina con el último banco.
+     *
+     * @return Ciclos desde @p now hasta que termina el acceso al L2.
+     */
+    uint64_t schedule_access(uint64_t first_word, uint64_t words, uint64_t now);
+
+/* --------------------------------------------------------------------------------------------- */
+
+    const SharedCacheConfig&            get_config() const;
+    const SharedCacheStats&             get_stats() const;
+    const std::vector<SharedCacheBank>& get_banks() const;
+
+private:
+    SharedCacheConfig                 config_;  /**< Geometría. */
+    SharedMemory&                     memory_;  /**< Memoria de respaldo. */
+    TagStore                          tags_;    /**< Tags y reemplazo. */
+    std::vector<std::vector<uint8_t>> data_;    /**< Un bloque de 16 bytes por frame. */
+    std::vector<uint8_t>              dirty_;   /**< 1 si el frame difiere de la memoria. */
+    std::vector<SharedCacheBank>      banks_;   /**< Ocupación de cada banco. */
+    SharedCacheStats                  stats_;   /**< Contadores. */
+
+    /** @brief true si la línea cae dentro de SharedMemory. */
+    bool in_memory(uint64_t line) const;
+
+    /**
+     * @brief Frame de la línea, instalándola si falta.
+     * @param fetch  true si hay que traer su contenido de memoria (si no, se sobrescribe entera).
+     * @param hit    [out] true si ya estaba.
+     */
+    size_t find_or_allocate(uint64_t line, bool fetch, bool& hit, SharedCacheAccess& access);
+};
+
+#endif // SHARED_CACHE_H
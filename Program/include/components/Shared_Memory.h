@@ -2,123 +2,315 @@
 #define SHARED_MEMORY_H
 
 #include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
 #include <cstdint>
 #include <string>
 #include <stdexcept>
+#include <functional>
+#include "../Geometry.h"
+#include "../Mapped_File.h"
+#include "Dram_Model.h"
+
+/**
+ * @enum Interleave
+ * @brief Granularidad con la que se reparten las direcciones entre bancos.
+ */
+enum class Interleave {
+    LINE,   /**< Líneas consecutivas de 16 bytes van a bancos consecutivos */
+    PAGE    /**< Páginas consecutivas (page_lines líneas) van a bancos consecutivos */
+};
+
+/**
+ * @struct MemoryConfig
+ * @brief Geometría de la memoria compartida (config/memory.txt).
+ */
+struct MemoryConfig {
+    uint64_t   words{Geometry::DEFAULT_MEMORY_WORDS};   /**< Palabras de 32 bits (memory_words) */
+    uint32_t   page_words{1024};                /**< Palabras por página de datos (potencia de 2) */
+    InitMode   init{InitMode::RANDOM};          /**< Origen del contenido inicial */
+    uint64_t   seed{0};                         /**< Semilla con InitMode::SEED (o IMAGE sin imagen) */
+    Storage    storage{Storage::HEAP};          /**< heap o mmap sobre shared_memory.bin */
+    uint32_t   banks{8};                        /**< Número de bancos */
+    Interleave interleave{Interleave::LINE};    /**< Granularidad del interleaving */
+    uint32_t   page_lines{16};                  /**< Líneas por página con Interleave::PAGE */
+    DramConfig dram;                            /**< Backend DRAM (config/dram.txt, apagado por defecto) */
+
+    /**
+     * @brief Carga la configuración desde un archivo "clave: valor".
+     *
+     * Claves: memory_words, page_words, init (random|seed|image), seed,
+     * storage (heap|mmap), banks,
+     * interleave (line|page), page_lines. Las ausentes conservan su valor por
+     * defecto.
+     *
+     * @throws std::invalid_argument si algún valor es inválido.
+     */
+    static MemoryConfig load_from_file(const std::string& filename);
+};
+
+/**
+ * @struct MemoryBank
+ * @brief Estado de ocupación de un banco de la memoria compartida.
+ *
+ * El banco no guarda peticiones: cada acceso se reserva de una vez con
+ * busy_until. in_flight solo recuerda cuándo terminan los accesos ya
+ * reservados, para medir cuántos se llegaron a acumular sobre el banco.
+ */
+struct MemoryBank {
+    uint64_t             busy_until{0};     /**< Ciclo en el que el banco queda libre */
+    std::deque<uint64_t> in_flight;         /**< Ciclos de fin de los accesos reservados que no han terminado */
+    uint64_t             accesses{0};       /**< Accesos atendidos */
+    uint64_t             conflicts{0};      /**< Accesos que encontraron el banco ocupado */
+    uint64_t             busy_cycles{0};    /**< Ciclos de servicio acumulados */
+    size_t               max_in_flight{0};  /**< Máximo de accesos reservados a la vez */
+};
+
+/**
+ * @struct BankWindow
+ * @brief Ciclos que un acceso reservó en un banco: [start, finish).
+ */
+struct BankWindow {
+    uint64_t start{0};      /**< Ciclo en que el banco empezó a servir el acceso */
+    uint64_t finish{0};     /**< Ciclo en que el banco terminó (0 si el acceso no lo tocó) */
+};
 
 /**
  * @class SharedMemory
  * @brief Simula la memoria principal compartida de un sistema multiprocesador.
  *
- * Cada palabra de memoria tiene 32 bits, y la memoria completa consta de un
- * número fijo de posiciones (MEMORY_SIZE). Se proveen métodos para lectura
+ * Cada palabra de memoria tiene 32 bits, y la memoria completa consta de
+ * MemoryConfig::words posiciones (la misma cifra que usan el generador y el
+ * compilador vía Geometry). Se proveen métodos para lectura
  * y escritura, inicialización aleatoria y volcado de contenido a archivos
- * tanto binarios como de texto (representación en bits).
+ * tanto binarios como de texto.
+ *
+ * El espacio de direcciones es disperso: se divide en páginas de page_words
+ * palabras que solo se reservan la primera vez que se leen o escriben. Cada
+ * página se llena con valores pseudoaleatorios derivados de la semilla y de su
+ * número, así que su contenido no depende del orden en que se toquen y una
+ * memoria de varios GB cuesta solo lo que el programa realmente usa. Los
+ * volcados incluyen únicamente las páginas tocadas.
+ *
+ * Con Storage::MMAP las páginas viven directamente en shared_memory.bin,
+ * mapeado como una imagen plana de todas las palabras, y el volcado binario
+ * se reduce a un msync. Con InitMode::IMAGE la memoria arranca con el
+ * shared_memory.bin de la corrida anterior (en cualquiera de los dos modos)
+ * en lugar de generar contenido nuevo.
+ *
+ * La memoria está dividida en bancos con interleaving por línea o por página.
+ * Cada banco lleva su ciclo de ocupación y su cola, de modo que accesos a bancos
+ * distintos avanzan en paralelo y los conflictos en un mismo banco se serializan.
+ * Con el backend DRAM encendido, el tiempo de servicio de cada banco lo calcula
+ * DramModel a partir de su fila abierta en lugar de la fórmula de LatencyModel.
  */
 class SharedMemory {
 public:
+    static constexpr size_t LINE_WORDS = Geometry::BLOCK_WORDS;    /**< Palabras de 32 bits por línea de 16 bytes. */
+
     /**
-     * @brief Construye la memoria e inicializa todas las posiciones a cero.
+     * @brief Construye la memoria sin reservar ninguna página.
+     * @param config Geometría de la memoria y de sus bancos.
      */
-    SharedMemory();
+    explicit SharedMemory(const MemoryConfig& config = MemoryConfig{});
 
 /* ---------------------------------------- Initializing --------------------------------------- */
 
     /**
-     * @brief Inicializa el shared memory llenandolo de forma aleatoria y lo vuelca.
+     * @brief Inicializa el shared memory según MemoryConfig::init.
+     *
+     * Solo con InitMode::RANDOM se vuelca el estado inicial, que es el único
+     * registro de una corrida no reproducible.
      */
     void initialize();
 
     /**
      * @brief Devuelve la capacidad total de la memoria en palabras de 32 bits.
-     * @return Número total de posiciones (MEMORY_SIZE).
+     * @return Número total de posiciones (MemoryConfig::words).
      */
-    size_t size() const;
+    uint64_t size() const;
 
     /**
-     * @brief Rellena toda la memoria con valores aleatorios de 32 bits.
+     * @brief Elige la semilla del contenido inicial y descarta las páginas tocadas.
      *
-     * Se utiliza un motor Mersenne Twister y una distribución uniforme
-     * en el rango [0, UINT32_MAX].
+     * Con InitMode::RANDOM la semilla sale de std::random_device; si no, es
+     * MemoryConfig::seed y el contenido es reproducible entre corridas. Las
+     * páginas se regeneran a partir de esta semilla cuando se vuelvan a tocar.
      */
     void fill_random();
 
     /**
-     * @brief Vuelca el contenido de la memoria a un archivo binario.
+     * @brief Vuelca las páginas tocadas a un archivo binario.
      *
-     * Escribe directamente el array de memoria como datos binarios.
-     * @param output_filename Ruta al archivo binario de salida.
+     * Por cada página, en orden de dirección: la primera palabra de la página
+     * (uint64_t), la cantidad de palabras (uint32_t) y las palabras, todo en el
+     * orden de bytes nativo. Con Storage::MMAP el archivo ya es la memoria y
+     * solo se fuerza su escritura a disco.
      * @throws std::runtime_error Si no se puede crear o escribir en el archivo.
      */
     void dump_to_binary_file() const;
 
     /**
-     * @brief Vuelca el contenido de la memoria a un archivo de texto.
+     * @brief Vuelca las páginas tocadas a un archivo de texto.
      *
-     * Cada línea del archivo contendrá la representación en 32 bits
-     * ('0'/'1') de cada palabra de memoria.
-     * @param output_filename Ruta al archivo de texto de salida.
+     * Cada página empieza con una línea "@<dirección>" (primera palabra, en
+     * hexadecimal) seguida de una palabra hexadecimal de 8 dígitos por línea.
      * @throws std::runtime_error Si no se puede crear o escribir en el archivo.
      */
     void dump_to_text_file() const;
 
+    /** @brief Páginas reservadas hasta ahora. */
+    size_t touched_pages() const;
+
 /* --------------------------------------------------------------------------------------------- */
 
 /* --------------------------------------- Data Handling --------------------------------------- */ 
 
     /**
-     * @brief Sobrescribe múltiples bloques en la representación de texto de la memoria compartida.
+     * @brief Sobrescribe múltiples bloques de la memoria compartida.
      *
-     * Lee el fichero de volcado de memoria compartida (dump_path_txt), reemplaza las líneas
-     * correspondientes comenzando en la dirección de palabra @p address y luego escribe de nuevo
-     * todo el contenido al disco. Cada bloque en @p blocks debe contener exactamente 16 bytes
-     * (4 palabras de 4 bytes), y se mapea a 4 líneas consecutivas en el fichero, cada línea
-     * representando una palabra en notación hexadecimal de 8 dígitos.
+     * Cada bloque en @p blocks debe contener exactamente 16 bytes (4 palabras de
+     * 4 bytes en big-endian) y se escribe en 4 palabras consecutivas a partir de
+     * la dirección de palabra @p address. Los volcados a disco se regeneran con
+     * dump_to_text_file() / dump_to_binary_file().
      *
      * @param blocks  Vector de bloques a escribir; cada bloque es un vector de 16 bytes.
-     * @param address Índice de palabra (0-based) desde el cual comenzar la escritura. Cada
-     *                bloque ocupa cuatro líneas, por lo que se sobrescriben las líneas
-     *                @p address ... @p address + 4*blocks.size() - 1.
+     * @param address Índice de palabra (0-based) desde el cual comenzar la escritura. Se
+     *                sobrescriben las palabras @p address ... @p address + 4*blocks.size() - 1.
      *
-     * @note En caso de fallo al abrir el fichero, bloque de tamaño incorrecto o
-     *       dirección fuera de rango, se imprimirá un mensaje de error a std::cerr
-     *       y la función retornará prematuramente sin lanzar excepciones.
+     * @throws Lo mismo que check_write(); en ese caso no se escribe ningún bloque.
      */
     void write_shared_memory_lines(const std::vector<std::vector<uint8_t>>& blocks,
-                                size_t address);
+                                uint64_t address);
+
+    /**
+     * @brief Comprueba que write_shared_memory_lines(@p blocks, @p address) se pueda hacer entera.
+     * @throws std::invalid_argument si algún bloque no tiene 16 bytes.
+     * @throws std::out_of_range si la escritura pasa del final de la memoria.
+     */
+    void check_write(const std::vector<std::vector<uint8_t>>& blocks, uint64_t address) const;
     
     /*
-    * @brief Lee bloques de palabra desde la representación de texto de la memoria compartida.
+    * @brief Lee bloques de 16 bytes de la memoria compartida.
     *
-    * Abre el fichero de volcado de memoria compartida (dump_path_txt) y retorna las líneas
-    * correspondientes al rango especificado por @p address y @p size_bytes. Cada línea en
-    * el fichero representa una palabra de 4 bytes en hexadecimal de 8 dígitos.
-    *
-    * La función agrupa las palabras en bloques de 4 líneas (128 bits):  
-    * - Calcula cuántas líneas (palabras) son necesarias para cubrir @p size_bytes.  
-    * - Agrupa esas líneas en sub-vectores de longitud 4 (padding con "00000000" si el fichero \ 
-    *   no tiene suficientes líneas).  
+    * La función agrupa las palabras en bloques de 4 palabras (128 bits):  
+    * - Calcula cuántas palabras son necesarias para cubrir @p size_bytes.  
+    * - Agrupa esas palabras en bloques de 16 bytes en big-endian (padding con 0 si \ 
+    *   la lectura excede el final de la memoria).  
     *
     * @param address    Índice de palabra (0-based) desde el cual iniciar la lectura.  
     * @param size_bytes Número total de bytes a leer; redondea hacia arriba al siguiente \ 
-    *                   múltiplo de 4.  
-    * @return Vector de bloques, donde cada bloque es un vector de cuatro cadenas de 8 dígitos \ 
-    *         hexadecimales. Si la lectura excede el final del fichero, las palabras faltantes \ 
-    *         se rellenan con "00000000".  
-    *
-    * @note En caso de error al abrir el fichero, se imprime un mensaje de error y se retorna \ 
-    *       un vector vacío.
+    *                   múltiplo de 16.  
+    * @return Vector de bloques, donde cada bloque es un vector de 16 bytes.
     */
-std::vector<std::vector<std::uint8_t>> read_shared_memory(size_t address,
+std::vector<std::vector<std::uint8_t>> read_shared_memory(uint64_t address,
                                                             size_t size_bytes);
 
 /* --------------------------------------------------------------------------------------------- */
 
+/* ------------------------------------------- Banks ------------------------------------------- */
+
+    /**
+     * @brief Devuelve el banco al que pertenece una dirección de palabra.
+     * @param word_address Índice de palabra (0-based).
+     */
+    uint32_t bank_of(uint64_t word_address) const;
+
+    /**
+     * @brief Reserva los bancos que toca un acceso y calcula cuándo termina.
+     *
+     * El acceso se reparte por líneas entre los bancos según el interleaving.
+     * Cada banco empieza cuando queda libre (o en @p now si ya lo está) y queda
+     * ocupado @p service_cycles(palabras del acceso en ese banco) ciclos, o lo
+     * que diga DramModel si el backend DRAM está encendido. Los bancos trabajan
+     * en paralelo, así que el acceso termina cuando termina el último.
+     *
+     * @param first_word     Primera palabra del acceso.
+     * @param words          Número de palabras del acceso.
+     * @param now            Ciclo actual del Interconnect.
+     * @param service_cycles Ciclos de servicio de un banco en función de sus palabras.
+     * @param write          true si es una escritura (solo importa para la DRAM).
+     * @param windows        [out] Opcional: ventana reservada en cada banco.
+     * @return Ciclos desde @p now hasta que el acceso completo termina.
+     */
+    uint64_t schedule_access(uint64_t first_word, uint64_t words, uint64_t now,
+                             const std::function<uint64_t(uint64_t)>& service_cycles,
+                             bool write = false, std::vector<BankWindow>* windows = nullptr);
+
+    /**
+     * @brief Ciclos hasta que una parte de un acceso ya reservado tiene sus palabras.
+     *
+     * Lo usan las lecturas agrupadas: el acceso reserva los bancos una vez y
+     * cada lectura espera solo @p service_cycles(sus palabras en el banco)
+     * desde que el banco empezó, sin pasar del fin del acceso completo.
+     *
+     * @param windows Ventanas que devolvió schedule_access para el acceso.
+     * @param first_word Primera palabra de la parte.
+     * @param words Palabras de la parte.
+     * @param now Ciclo en que se reservó el acceso.
+     * @param service_cycles La misma función que recibió schedule_access.
+     * @return Ciclos desde @p now hasta que la parte termina.
+     */
+    uint64_t part_cycles(const std::vector<BankWindow>& windows, uint64_t first_word,
+                         uint64_t words, uint64_t now,
+                         const std::function<uint64_t(uint64_t)>& service_cycles) const;
+
+    /**
+     * @brief Fila DRAM (dentro de su banco) de una línea de 16 bytes.
+     * @param line Índice global de la línea (palabra / LINE_WORDS).
+     */
+    uint64_t row_of(uint64_t line) const;
+
+    /** @brief true si todos los bancos que toca el acceso están libres en @p now. */
+    bool banks_free(uint64_t first_word, uint64_t words, uint64_t now) const;
+
+    /** @brief true si todas las líneas del acceso caen en la fila abierta de su banco (false sin DRAM). */
+    bool rows_open(uint64_t first_word, uint64_t words) const;
+
+    /** @brief Backend DRAM, o nullptr si está apagado. */
+    const DramModel* get_dram() const;
+
+    /** @brief Configuración de bancos en uso. */
+    const MemoryConfig& get_config() const;
+
+    /** @brief Estado y contadores de cada banco. */
+    const std::vector<MemoryBank>& get_banks() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
 private:
-    static constexpr size_t     MEMORY_SIZE = 4096; /**< Número de palabras de 32 bits en la memoria. */
-    std::vector<uint32_t>       data;               /**< Contenedor interno de las palabras de memoria. */
+    /** @brief Cuántas de las palabras [first_word, first_word + words) caen en cada banco. */
+    std::vector<uint64_t> words_per_bank(uint64_t first_word, uint64_t words) const;
+
+    /**
+     * @brief Devuelve la página @p page, reservándola e inicializándola si hace falta.
+     * @return Puntero a las page_words palabras de la página.
+     */
+    uint32_t* touch_page(uint64_t page);
+
+    /** @brief Llena las page_words palabras de @p words con el contenido inicial de la página @p page. */
+    void init_page(uint64_t page, uint32_t* words) const;
+
+    /**
+     * @brief Carga shared_memory.bin como contenido inicial.
+     * @return false (con un aviso) si no hay una imagen utilizable.
+     */
+    bool load_image();
+
+    std::unordered_map<uint64_t, uint32_t*> pages_;     /**< Páginas tocadas, por número. */
+    std::vector<std::unique_ptr<uint32_t[]>> heap_pages_;  /**< Almacenamiento de las páginas con Storage::HEAP. */
+    MappedFile                  image_;             /**< shared_memory.img mapeado con Storage::MMAP. */
+    std::unique_ptr<DramModel>  dram_;              /**< Backend DRAM (nullptr si dram: off). */
+    uint64_t                    seed_{0};           /**< Semilla efectiva del contenido inicial. */
+    bool                        warm_{false};       /**< image_ trae el contenido de la corrida anterior. */
+    uint32_t                    page_shift_{0};     /**< log2(page_words). */
     std::string dump_path_txt;                      /**< Directorio donde se volcara el shared memory. */
     std::string dump_path_bin;                      /**< Directorio donde se volcara el shared memory. */
+    std::string image_path;                         /**< Imagen plana que se mapea con Storage::MMAP. */
+
+    MemoryConfig                config_;            /**< Geometría de bancos. */
+    std::vector<MemoryBank>     banks_;             /**< Estado de cada banco. */
 };
 
 #endif // SHARED_MEMORY_H
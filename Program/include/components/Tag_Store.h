@@ -0,0 +1,103 @@
+#ifndef TAG_STORE_H
+#define TAG_STORE_H
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <random>
+
+/**
+ * @enum Replacement
+ * @brief Política de reemplazo de un conjunto asociativo.
+ */
+enum class Replacement {
+    LRU,    /**< Menos recientemente usado (marca de tiempo por vía) */
+    PLRU,   /**< Pseudo-LRU de árbol binario (ways potencia de 2) */
+    RANDOM  /**< Vía aleatoria entre las válidas */
+};
+
+/**
+ * @class TagStore
+ * @brief Directorio de tags de un caché asociativo por conjuntos.
+ *
+ * Guarda solo tags, bits de validez y el estado de reemplazo; los datos los
+ * maneja quien lo usa. El frame de una línea es set * ways + way, así un
+ * caché puede indexar sus datos por frame sin conocer la política.
+ */
+class TagStore {
+public:
+    /**
+     * @brief Construye un directorio vacío (todas las vías inválidas).
+     * @param sets   Número de conjuntos.
+     * @param ways   Vías por conjunto (potencia de 2 y <= 64 con PLRU).
+     * @param policy Política de reemplazo.
+     * @param seed   Semilla del generador para RANDOM.
+     * @throws std::invalid_argument si la geometría no es válida para la política.
+     */
+    TagStore(uint32_t sets, uint32_t ways, Replacement policy, uint32_t seed = 0);
+
+    /**
+     * @brief Convierte "lru" | "plru" | "random" a Replacement.
+     * @throws std::invalid_argument si el nombre no es válido.
+     */
+    static Replacement parse_replacement(const std::string& name);
+
+    /** @brief Nombre de la política, para reportes. */
+    static const char* replacement_to_string(Replacement policy);
+
+/* ------------------------------------------ Lookup ------------------------------------------- */
+
+    /**
+     * @brief Busca un tag en un conjunto.
+     * @return Vía donde está el tag, o -1 si no está (o la vía es inválida).
+     */
+    int lookup(uint32_t set, uint64_t tag) const;
+
+    /** @brief Marca la vía como recién usada para la política de reemplazo. */
+    void touch(uint32_t set, uint32_t way);
+
+    /**
+     * @brief Elige la vía a reemplazar en un conjunto.
+     *
+     * Siempre prefiere una vía inválida; si todas son válidas decide la política.
+     */
+    uint32_t victim(uint32_t set);
+
+    /** @brief Instala @p tag en la vía indicada, la valida y la marca como usada. */
+    void fill(uint32_t set, uint32_t way, uint64_t tag);
+
+    /** @brief Invalida una vía. */
+    void invalidate(uint32_t set, uint32_t way);
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ----------------------------------- Getters & Setters --------------------------------------- */
+
+    /** @brief Devuelve true si la vía tiene una línea válida. */
+    bool is_valid(uint32_t set, uint32_t way) const;
+
+    /** @brief Tag guardado en la vía (sin significado si es inválida). */
+    uint64_t get_tag(uint32_t set, uint32_t way) const;
+
+    uint32_t    get_sets() const;
+    uint32_t    get_ways() const;
+    Replacement get_policy() const;
+
+/* --------------------------------------------------------------------------------------------- */
+
+private:
+    uint32_t                sets_;          /**< Número de conjuntos. */
+    uint32_t                ways_;          /**< Vías por conjunto. */
+    Replacement             policy_;        /**< Política de reemplazo. */
+    std::vector<uint64_t>   tags_;          /**< Tag por frame (set * ways + way). */
+    std::vector<uint8_t>    valid_;         /**< Bit de validez por frame. */
+    std::vector<uint64_t>   last_use_;      /**< LRU: marca de último uso por frame. */
+    std::vector<uint64_t>   plru_bits_;     /**< PLRU: bits del árbol por conjunto (nodo i = bit i). */
+    uint64_t                clock_{0};      /**< LRU: reloj de accesos. */
+    std::mt19937            rng_;           /**< RANDOM: generador de víctimas. */
+
+    /** @brief Índice plano del frame. */
+    size_t frame(uint32_t set, uint32_t way) const;
+};
+
+#endif // TAG_STORE_H
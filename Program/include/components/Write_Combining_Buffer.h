@@ -0,0 +1,136 @@
+#ifndef WRITE_COMBINING_BUFFER_H
+#define WRITE_COMBINING_BUFFER_H
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include "../Message.h"
+
+class ConfigFile;
+
+/**
+ * @enum FlushReason
+ * @brief Por qué una entrada del write-combining buffer salió al Interconnect.
+ */
+enum class FlushReason {
+    CAPACITY,   /**< Buffer lleno: sale la entrada más vieja */
+    CONFLICT,   /**< Un READ_MEM o una escritura no combinable toca su rango */
+    FENCE,      /**< BROADCAST_INVALIDATE: todas las escrituras previas salen antes */
+    TIMEOUT,    /**< Esperó la ventana completa sin cerrarse */
+    DRAIN       /**< El PE terminó su programa */
+};
+
+/**
+ * @struct WriteCombineConfig
+ * @brief Parámetros del write-combining buffer (claves wc_* de config/pe.txt).
+ */
+struct WriteCombineConfig {
+    uint32_t entries{0};        /**< Escrituras combinadas pendientes por PE (0 = desactivado) */
+    uint32_t window{8};         /**< Pasos que una entrada espera antes de salir */
+    uint32_t max_blocks{8};     /**< Bloques de 16 bytes por escritura combinada */
+
+    /**
+     * @brief Lee las claves wc_entries, wc_window y wc_max_blocks.
+     * @throws std::invalid_argument si algún valor es inválido.
+     */
+    static WriteCombineConfig from_config(const ConfigFile& cfg);
+};
+
+/**
+ * @struct WriteCombineStats
+ * @brief Contadores para medir cuántas peticiones ahorra el buffer.
+ */
+struct WriteCombineStats {
+    uint64_t writes{0};             /**< WRITE_MEM que entraron al buffer */
+    uint64_t merged{0};             /**< De ellas, las que se combinaron con una entrada existente */
+    uint64_t flushed{0};            /**< Escrituras combinadas enviadas al Interconnect */
+    uint64_t bytes_in{0};           /**< Bytes de los WRITE_MEM que entraron */
+    uint64_t bytes_out{0};          /**< Bytes enviados (los solapados se envían una sola vez) */
+    uint64_t capacity_flushes{0};   /**< Salidas por buffer lleno */
+    uint64_t conflict_flushes{0};   /**< Salidas por un acceso que tocaba su rango */
+    uint64_t fence_flushes{0};      /**< Salidas por un BROADCAST_INVALIDATE */
+    uint64_t timeout_flushes{0};    /**< Salidas por vencer la ventana */
+    uint64_t drain_flushes{0};      /**< Salidas al terminar el programa */
+};
+
+/**
+ * @class WriteCombiningBuffer
+ * @brief Buffer por PE que junta WRITE_MEM contiguos o solapados antes de emitirlos.
+ *
+ * Una escritura se combina con una entrada pendiente si sus rangos se tocan
+ * o se solapan, están alineados al mismo bloque de 16 bytes y la unión no
+ * pasa de max_blocks bloques; en el solapamiento gana la más nueva. Si no,
+ * ocupa una entrada libre y, con el buffer lleno, la más vieja sale primero.
+ * Las entradas que una escritura solapa sin poder combinarse también salen
+ * antes, así el orden entre escrituras al mismo rango se conserva.
+ *
+ * Las escrituras del buffer son posted: el PE no las espera en su ventana;
+ * el buffer solo lleva cuántas siguen en vuelo para saber cuándo el PE quedó
+ * drenado. Solo lo usa el hilo de su PE.
+ */
+class WriteCombiningBuffer {
+public:
+    explicit WriteCombiningBuffer(const WriteCombineConfig& config);
+
+    /** @brief true si wc_entries > 0. */
+    bool enabled() const;
+
+    /**
+     * @brief Agrega un WRITE_MEM (con sus datos) al buffer.
+     *
+     * @param write Escritura decodificada por el PE.
+     * @param step  Paso actual del sistema.
+     * @return Entradas que deben salir al Interconnect antes que esta escritura, en orden.
+     */
+    std::vector<Message> insert(const Message& write, uint64_t step);
+
+    /**
+     * @brief Saca las entradas que tocan el rango de un READ_MEM.
+     * @param address Primera palabra leída.
+     * @param words   Palabras leídas.
+     */
+    std::vector<Message> take_overlapping(uint64_t address, uint64_t words);
+
+    /** @brief Saca las entradas que ya esperaron la ventana completa en el paso @p step. */
+    std::vector<Message> take_expired(uint64_t step);
+
+    /** @brief Saca todas las entradas, de la más vieja a la más nueva. */
+    std::vector<Message> take_all(FlushReason reason);
+
+    /** @brief La respuesta de una escritura combinada llegó. */
+    void on_complete();
+
+    /** @brief true si no hay entradas pendientes. */
+    bool empty() const;
+
+    /** @brief Escrituras combinadas enviadas sin respuesta aún. */
+    size_t inflight() const;
+
+    const WriteCombineConfig& get_config() const;
+    const WriteCombineStats&  get_stats() const;
+
+private:
+    /** @brief Escritura combinada pendiente. */
+    struct Entry {
+        Message  msg;           /**< Mensaje a emitir (dirección y bloques de la unión). */
+        uint64_t first_word;    /**< Primera palabra escrita. */
+        uint64_t words;         /**< Palabras escritas (múltiplo de 4). */
+        uint64_t allocated;     /**< Paso en que se abrió la entrada. */
+    };
+
+    /** @brief true si el rango [@p first, @p first + @p words) se puede unir a @p entry. */
+    bool can_merge(const Entry& entry, uint64_t first, uint64_t words) const;
+
+    /** @brief Une @p write a @p entry; can_merge() ya lo debe haber aceptado. */
+    void merge(Entry& entry, const Message& write, uint64_t first, uint64_t words) const;
+
+    /** @brief Saca la entrada @p index y la cuenta como enviada. */
+    Message release(size_t index, FlushReason reason);
+
+    WriteCombineConfig  config_;            /**< Parámetros. */
+    WriteCombineStats   stats_;             /**< Contadores. */
+    std::deque<Entry>   entries_;           /**< Entradas pendientes, de la más vieja a la más nueva. */
+    size_t              inflight_{0};       /**< Escrituras enviadas sin respuesta. */
+};
+
+#endif // WRITE_COMBINING_BUFFER_H
@@ -0,0 +1,85 @@
+#include "../include/Byte_Swap.h"
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BYTE_SWAP_X86 1
+#endif
+
+using Kernel = void (*)(const uint8_t*, uint8_t*, size_t);
+
+/* -------------------------------------------- Kernels ---------------------------------------- */
+
+static void bswap32_scalar(const uint8_t* src, uint8_t* dst, size_t words) {
+    // En una máquina big-endian el orden nativo ya es el de los Message
+    if constexpr (std::endian::native != std::endian::little) {
+        std::memcpy(dst, src, words * 4);
+        return;
+    }
+    for (size_t i = 0; i < words; ++i) {
+        uint32_t word;
+        std::memcpy(&word, src + i * 4, sizeof(word));
+        word = __builtin_bswap32(word);
+        std::memcpy(dst + i * 4, &word, sizeof(word));
+    }
+}
+
+#ifdef BYTE_SWAP_X86
+
+__attribute__((target("ssse3")))
+static void bswap32_ssse3(const uint8_t* src, uint8_t* dst, size_t words) {
+    const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    // Un bloque de 16 bytes (4 palabras) por shuffle
+    for (; i + 4 <= words; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(v, mask));
+    }
+    bswap32_scalar(src + i * 4, dst + i * 4, words - i);
+}
+
+__attribute__((target("avx2")))
+static void bswap32_avx2(const uint8_t* src, uint8_t* dst, size_t words) {
+    const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    // Dos bloques de 16 bytes por shuffle; el resto con SSSE3 (AVX2 lo implica)
+    for (; i + 8 <= words; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(v, mask));
+    }
+    bswap32_ssse3(src + i * 4, dst + i * 4, words - i);
+}
+
+#endif
+
+/* ------------------------------------------- Dispatch ---------------------------------------- */
+
+/** @brief Kernel elegido para la CPU y su nombre. */
+struct Dispatch {
+    Kernel      kernel;
+    const char* name;
+};
+
+static Dispatch select_kernel() {
+#ifdef BYTE_SWAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))  return {bswap32_avx2, "avx2"};
+    if (__builtin_cpu_supports("ssse3")) return {bswap32_ssse3, "ssse3"};
+#endif
+    return {bswap32_scalar, "scalar"};
+}
+
+static const Dispatch& dispatch() {
+    static const Dispatch selected = select_kernel();
+    return selected;
+}
+
+void bswap32_copy(const void* src, void* dst, size_t words) {
+    dispatch().kernel(static_cast<const uint8_t*>(src), static_cast<uint8_t*>(dst), words);
+}
+
+const char* bswap32_kernel_name() {
+    return dispatch().name;
+}
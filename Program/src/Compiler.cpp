@@ -1,123 +1,713 @@
 #include "../include/Compiler.h"
 #include <filesystem>
-#include <bitset>
-#include <sstream>
-#include <regex>
-#include <map>
+#include <charconv>
+#include <cstdint>
+#include <array>
 #include <vector>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <exception>
 
-// Tamaños de campo en bits
-constexpr int ADDR_SIZE = 16;
-constexpr int CACHE_LINE_SIZE = 8;
-constexpr int QOS_SIZE = 4;
-constexpr int SRC_SIZE = 5;
-
-// Límites de validación
-constexpr int MAX_ADDR = 4096 * 4;
-constexpr int MAX_CACHE_LINE = 512;
-constexpr int MAX_QOS = 15;
-constexpr int MAX_SRC = 31;
-
-// ISA con sus respectivos opcodes de 2 bits
-const std::map<std::string, std::string> isa = {
-    {"WRITE_MEM", "00"},
-    {"READ_MEM", "01"},
-    {"BROADCAST_INVALIDATE", "10"}
+// Límites de validación (direcciones y líneas salen de Compiler::geometry_)
+constexpr int64_t MAX_QOS = static_cast<int64_t>(InstructionFormat::QOS.mask());
+constexpr int64_t MAX_SRC = static_cast<int64_t>(InstructionFormat::SRC.mask());
+
+Geometry Compiler::geometry_{};
+
+void Compiler::set_geometry(const Geometry& geometry) {
+    geometry.validate();
+    geometry_ = geometry;
+}
+
+/* ----------------------------------------- Operands ------------------------------------------ */
+
+int64_t Compiler::parse_number(std::string_view value) {
+    const char* first = value.data();
+    const char* last  = value.data() + value.size();
+    bool negative = false;
+    if (first != last && (*first == '-' || *first == '+')) {
+        negative = *first == '-';
+        ++first;
+    }
+
+    // Mismas bases que std::stoi(value, nullptr, 0): 0x hexadecimal, 0 octal, si no decimal
+    int base = 10;
+    if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+        base = 16;
+        first += 2;
+    } else if (last - first > 1 && first[0] == '0') {
+        base = 8;
+        ++first;
+    }
+
+    // Sin signo: from_chars no acepta un segundo '-' después del que ya se consumió
+    uint64_t num = 0;
+    auto [end, ec] = std::from_chars(first, last, num, base);
+    if (first == last || ec == std::errc::invalid_argument || end != last) {
+        throw std::invalid_argument("Número inválido: " + std::string(value));
+    }
+    if (ec == std::errc::result_out_of_range || num > static_cast<uint64_t>(INT64_MAX)) {
+        throw std::invalid_argument("Número fuera de rango: " + std::string(value));
+    }
+    return negative ? -static_cast<int64_t>(num) : static_cast<int64_t>(num);
+}
+
+static bool is_symbol_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_symbol_char(char c) {
+    return is_symbol_start(c) || (c >= '0' && c <= '9');
+}
+
+/** @brief true si @p text es un número solo, sin símbolos ni operadores. */
+static bool is_plain_number(std::string_view text) {
+    return !text.empty() && text[0] >= '0' && text[0] <= '9'
+        && std::all_of(text.begin(), text.end(), is_symbol_char);
+}
+
+/** @brief Operando para un mensaje de error: el texto y, si era una expresión, su valor. */
+static std::string describe(int64_t value, std::string_view text) {
+    std::string out(text);
+    std::string shown = std::to_string(value);
+    if (!is_plain_number(text) && text != shown) out += " (= " + shown + ")";
+    return out;
+}
+
+uint64_t Compiler::validate_src(int64_t value, std::string_view text) {
+    if (value < 0 || value > MAX_SRC) throw std::invalid_argument("SRC inválido: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_addr(int64_t value, std::string_view text) {
+    if (value % Geometry::BLOCK_WORDS != 0) throw std::invalid_argument("Dirección no alineada a 4 palabras: " + describe(value, text));
+    if (value < 0 || value >= static_cast<int64_t>(geometry_.address_limit())) throw std::invalid_argument("Dirección fuera de rango: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_start_line(int64_t value, std::string_view text) {
+    if (value < 0 || value >= static_cast<int64_t>(geometry_.cache_block_limit())) throw std::invalid_argument("Línea de caché fuera de rango: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_cache_line(int64_t value, std::string_view text) {
+    if (value < 0 || value >= static_cast<int64_t>(geometry_.cache_frame_limit())) throw std::invalid_argument("Frame de caché fuera de rango: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_line_count(int64_t value, std::string_view text) {
+    int64_t limit = static_cast<int64_t>(std::min(geometry_.cache_block_limit(), Geometry::max_field_value()));
+    if (value < 0 || value > limit) throw std::invalid_argument("Cantidad de líneas fuera de rango: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_size(int64_t value, std::string_view text) {
+    if (value < 0 || value > static_cast<int64_t>(Geometry::max_field_value())) throw std::invalid_argument("Tamaño de lectura fuera de rango: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_qos(int64_t value, std::string_view text) {
+    if (value < 0 || value > MAX_QOS) throw std::invalid_argument("QoS fuera de rango: " + describe(value, text));
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t Compiler::validate_operand(Operand operand, int64_t value, std::string_view text) {
+    switch (operand) {
+        case Operand::SRC:          return validate_src(value, text);
+        case Operand::ADDRESS:      return validate_addr(value, text);
+        case Operand::READ_SIZE:    return validate_size(value, text);
+        case Operand::LINE_COUNT:   return validate_line_count(value, text);
+        case Operand::START_LINE:   return validate_start_line(value, text);
+        case Operand::CACHE_LINE:   return validate_cache_line(value, text);
+        case Operand::QOS:          return validate_qos(value, text);
+        case Operand::COUNT:        break;
+    }
+    throw std::invalid_argument("Operando desconocido: " + std::string(text));
+}
+
+void Compiler::validate_range(const InstructionLayout& layout,
+                              const std::array<uint64_t, InstructionLayout::MAX_OPERANDS>& values) {
+    bool     has_address = false;
+    uint64_t address = 0, bytes = 0;
+    for (size_t i = 0; i < layout.operand_count; ++i) {
+        switch (layout.operands[i].operand) {
+            case Operand::ADDRESS:    address = values[i]; has_address = true;      break;
+            case Operand::LINE_COUNT: bytes = values[i] * Geometry::BLOCK_SIZE;     break;
+            case Operand::READ_SIZE:  bytes = values[i];                            break;
+            default:                                                                break;
+        }
+    }
+    if (!has_address) return;
+
+    // En bytes: un READ_MEM de tamaño no múltiplo de 4 igual ocupa su última palabra
+    uint64_t limit = geometry_.address_limit() * Geometry::WORD_BYTES;
+    if (address * Geometry::WORD_BYTES + bytes > limit) {
+        throw std::invalid_argument("Acceso fuera de rango: " + std::to_string(bytes) + " bytes desde la palabra "
+                                    + std::to_string(address) + " pasan de memory_words ("
+                                    + std::to_string(geometry_.address_limit()) + ")");
+    }
+}
+
+/* ---------------------------------------- Expressions ---------------------------------------- */
+
+/**
+ * @class ExpressionParser
+ * @brief Descenso recursivo sobre una expresión entera.
+ *
+ *     expr    := term (('+' | '-') term)*
+ *     term    := unary (('*' | '/' | '%') unary)*
+ *     unary   := ('-' | '+') unary | primary
+ *     primary := número | símbolo | '(' expr ')'
+ */
+class ExpressionParser {
+public:
+    ExpressionParser(std::string_view text, const SymbolTable& symbols)
+        : text_(text), symbols_(symbols) {}
+
+    int64_t parse() {
+        int64_t value = expression();
+        skip_spaces();
+        if (pos_ != text_.size()) fail(std::string("sobra '") + text_[pos_] + "'");
+        return value;
+    }
+
+private:
+    void skip_spaces() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t')) ++pos_;
+    }
+
+    bool accept(char c) {
+        skip_spaces();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    int64_t expression() {
+        int64_t value = term();
+        for (;;) {
+            int64_t rhs;
+            if (accept('+')) {
+                rhs = term();
+                if (__builtin_add_overflow(value, rhs, &value)) fail("desborde");
+            } else if (accept('-')) {
+                rhs = term();
+                if (__builtin_sub_overflow(value, rhs, &value)) fail("desborde");
+            } else {
+                return value;
+            }
+        }
+    }
+
+    int64_t term() {
+        int64_t value = unary();
+        for (;;) {
+            if (accept('*')) {
+                int64_t rhs = unary();
+                if (__builtin_mul_overflow(value, rhs, &value)) fail("desborde");
+            } else if (accept('/')) {
+                value = divide(value, unary(), false);
+            } else if (accept('%')) {
+                value = divide(value, unary(), true);
+            } else {
+                return value;
+            }
+        }
+    }
+
+    int64_t divide(int64_t lhs, int64_t rhs, bool modulo) const {
+        if (rhs == 0) fail("división por cero");
+        if (rhs == -1 && lhs == INT64_MIN) fail("desborde");
+        return modulo ? lhs % rhs : lhs / rhs;
+    }
+
+    int64_t unary() {
+        if (accept('-')) {
+            int64_t value = unary();
+            if (value == INT64_MIN) fail("desborde");
+            return -value;
+        }
+        if (accept('+')) return unary();
+        return primary();
+    }
+
+    int64_t primary() {
+        if (accept('(')) {
+            int64_t value = expression();
+            if (!accept(')')) fail("falta ')'");
+            return value;
+        }
+
+        size_t start = pos_;
+        if (pos_ < text_.size() && is_symbol_start(text_[pos_])) {
+            while (pos_ < text_.size() && is_symbol_char(text_[pos_])) ++pos_;
+            std::string_view name = text_.substr(start, pos_ - start);
+            // Desde el final: la variable del .repeat más interno tapa a las de afuera
+            for (auto it = symbols_.rbegin(); it != symbols_.rend(); ++it) {
+                if (it->name == name) return it->value;
+            }
+            fail("símbolo no definido: " + std::string(name));
+        }
+
+        // Un número: dígitos y, para 0x..., letras
+        while (pos_ < text_.size() && is_symbol_char(text_[pos_])) ++pos_;
+        if (pos_ == start) fail("se esperaba un número o un símbolo");
+        return Compiler::parse_number(text_.substr(start, pos_ - start));
+    }
+
+    [[noreturn]] void fail(const std::string& why) const {
+        throw std::invalid_argument("Expresión inválida '" + std::string(text_) + "': " + why);
+    }
+
+    std::string_view    text_;      /**< Expresión completa */
+    const SymbolTable&  symbols_;   /**< Símbolos visibles */
+    size_t              pos_{0};    /**< Siguiente carácter */
 };
 
-std::string Compiler::to_bin(int value, int bits) {
-    return std::bitset<64>(value).to_string().substr(64 - bits);
+int64_t Compiler::evaluate(std::string_view expression, const SymbolTable& symbols) {
+    // Camino rápido: un número sin símbolos ni operadores, como en los archivos sin macros
+    if (is_plain_number(expression)) return parse_number(expression);
+    return ExpressionParser(expression, symbols).parse();
 }
 
-std::string Compiler::validate_src(const std::string& value) {
-    int num = std::stoi(value, nullptr, 0);
-    if (num < 0 || num > MAX_SRC) throw std::invalid_argument("SRC inválido: " + value);
-    return to_bin(num, SRC_SIZE);
+/* ----------------------------------------- Assembler ----------------------------------------- */
+
+/** @brief Separadores entre tokens: los mismos que la expresión [\s,]+ de antes. */
+static bool is_separator(char c) {
+    return c == ' ' || c == ',' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
 }
 
-std::string Compiler::validate_addr(const std::string& value) {
-    int num = std::stoi(value, nullptr, 0);
-    if (num % 4 != 0) throw std::invalid_argument("Dirección no alineada a 4 bytes: " + value);
-    if (num < 0 || num >= MAX_ADDR) throw std::invalid_argument("Dirección fuera de rango: " + value);
-    return to_bin(num, ADDR_SIZE);
+/** @brief Tokens de una línea (sin su comentario); como máximo TOKENS, y uno de más indica que sobran. */
+static constexpr size_t TOKENS = InstructionLayout::MAX_OPERANDS + 2;
+
+/** @brief Quita espacios y tabs de los extremos. */
+static std::string_view trim(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n\v\f");
+    if (first == std::string_view::npos) return {};
+    size_t last = text.find_last_not_of(" \t\r\n\v\f");
+    return text.substr(first, last - first + 1);
 }
 
-std::string Compiler::validate_cache_line(const std::string& value) {
-    int num = std::stoi(value, nullptr, 0);
-    if (num < 0 || num >= MAX_CACHE_LINE) throw std::invalid_argument("Línea de caché fuera de rango: " + value);
-    return to_bin(num, CACHE_LINE_SIZE);
+/**
+ * @brief Separa @p line en vistas sobre la misma línea.
+ *
+ * El primer token (mnemónico o directiva) termina en un espacio o una coma.
+ * Si el resto de la línea tiene comas, los operandos se separan solo por
+ * comas y pueden tener espacios ("BASE + i * 16"); si no, por espacios, y
+ * una expresión con espacios va entre paréntesis. Las comas o espacios de
+ * más se ignoran, como antes.
+ *
+ * @return Cantidad de tokens; TOKENS + 1 si había más de TOKENS.
+ */
+static size_t split_tokens(std::string_view line, std::array<std::string_view, TOKENS>& tokens) {
+    line = line.substr(0, line.find(';'));  // comentario
+    size_t count = 0;
+    size_t pos   = 0;
+    auto push = [&](std::string_view token) {
+        if (token.empty()) return true;
+        if (count == tokens.size()) {
+            ++count;
+            return false;
+        }
+        tokens[count++] = token;
+        return true;
+    };
+
+    while (pos < line.size() && is_separator(line[pos])) ++pos;
+    size_t start = pos;
+    while (pos < line.size() && !is_separator(line[pos])) ++pos;
+    push(line.substr(start, pos - start));
+
+    std::string_view rest = line.substr(pos);
+    if (rest.find(',') != std::string_view::npos) {
+        while (!rest.empty()) {
+            size_t comma = rest.find(',');
+            if (!push(trim(rest.substr(0, comma)))) return count;
+            rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+        }
+        return count;
+    }
+
+    pos = 0;
+    while (pos < rest.size()) {
+        while (pos < rest.size() && is_separator(rest[pos])) ++pos;
+        start = pos;
+        int depth = 0;
+        while (pos < rest.size() && (depth > 0 || !is_separator(rest[pos]))) {
+            if (rest[pos] == '(') ++depth;
+            else if (rest[pos] == ')' && depth > 0) --depth;
+            ++pos;
+        }
+        if (!push(rest.substr(start, pos - start))) return count;
+    }
+    return count;
 }
 
-std::string Compiler::validate_qos(const std::string& value) {
-    int num = std::stoi(value, nullptr, 0);
-    if (num < 0 || num > MAX_QOS) throw std::invalid_argument("QoS fuera de rango: " + value);
-    return to_bin(num, QOS_SIZE);
+uint64_t Compiler::assemble_line(std::string_view line, const SymbolTable& symbols, bool& empty) {
+    std::array<std::string_view, TOKENS> tokens;
+    size_t count = split_tokens(line, tokens);
+
+    empty = count == 0;
+    if (empty) return 0;
+
+    const InstructionLayout* layout = InstructionFormat::find(tokens[0]);
+    if (!layout) throw std::invalid_argument("Instrucción no válida: " + std::string(tokens[0]));
+    if (count != layout->operand_count + 1) {
+        std::string found = count > tokens.size() ? "más" : std::to_string(count - 1);
+        throw std::invalid_argument(std::string(layout->mnemonic) + " espera " + std::to_string(layout->operand_count)
+                                    + " operandos, tiene " + found);
+    }
+
+    // Cada operando se evalúa, se valida según su tipo y se coloca en el campo que indica la tabla
+    std::array<uint64_t, InstructionLayout::MAX_OPERANDS> values{};
+    for (size_t i = 0; i < layout->operand_count; ++i) {
+        const std::string_view text = tokens[i + 1];
+        values[i] = validate_operand(layout->operands[i].operand, evaluate(text, symbols), text);
+    }
+    validate_range(*layout, values);
+    return InstructionFormat::encode(*layout, values);
 }
 
-std::vector<std::vector<std::string>> Compiler::clean_instructions(std::ifstream& file) {
-    std::vector<std::vector<std::string>> instructions;
-    std::string line;
-    std::regex re("[\\s,]+");
-
-    while (std::getline(file, line)) {
-        line = line.substr(0, line.find(';')); // strip comments
-        std::stringstream ss(line);
-        std::string token;
-        std::vector<std::string> parts;
-        while (std::getline(ss, token, ' ')) {
-            if (!token.empty()) {
-                std::sregex_token_iterator it(token.begin(), token.end(), re, -1), end;
-                for (; it != end; ++it) {
-                    if (!it->str().empty()) parts.push_back(it->str());
+/**
+ * @class ObjectWriter
+ * @brief Escribe las instrucciones ensambladas de a bloques, en objeto binario o en texto.
+ */
+class ObjectWriter {
+public:
+    ObjectWriter(std::ostream& output, uint32_t pe_id, ObjectEncoding encoding)
+        : output_(output), encoding_(encoding) {
+        // La cabecera se escribe con COUNT en 0 y se completa en finish()
+        header_.version = ObjectFormat::VERSION;
+        header_.bits    = InstructionFormat::BITS;
+        header_.pe_id   = pe_id;
+        if (encoding_ == ObjectEncoding::PACKED) write_header();
+    }
+
+    void write(uint64_t word) {
+        if (encoding_ == ObjectEncoding::PACKED) {
+            ObjectFormat::store_le(&packed_[pending_ * ObjectFormat::INSTRUCTION_BYTES], word,
+                                   ObjectFormat::INSTRUCTION_BYTES);
+        } else {
+            // Una línea de BITS caracteres '0'/'1', del bit más significativo al menos
+            char* bits = &text_[pending_ * (InstructionFormat::BITS + 1)];
+            for (uint32_t b = 0; b < InstructionFormat::BITS; ++b) {
+                bits[b] = static_cast<char>('0' + ((word >> (InstructionFormat::BITS - 1 - b)) & 1));
+            }
+            bits[InstructionFormat::BITS] = '\n';
+        }
+        ++header_.count;
+        if (++pending_ == CHUNK) flush();
+    }
+
+    /** @brief Vacía el buffer y completa la cabecera; devuelve las instrucciones escritas. */
+    size_t finish() {
+        flush();
+        if (encoding_ == ObjectEncoding::PACKED) {
+            output_.seekp(0);
+            write_header();
+            output_.seekp(0, std::ios::end);
+        }
+        return header_.count;
+    }
+
+private:
+    static constexpr size_t CHUNK = 512;   /**< Instrucciones por escritura */
+
+    void write_header() {
+        std::array<uint8_t, ObjectFormat::HEADER_BYTES> bytes{};
+        ObjectFormat::encode_header(bytes.data(), header_);
+        output_.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    void flush() {
+        if (encoding_ == ObjectEncoding::PACKED) {
+            output_.write(reinterpret_cast<const char*>(packed_.data()),
+                          static_cast<std::streamsize>(pending_ * ObjectFormat::INSTRUCTION_BYTES));
+        } else {
+            output_.write(text_.data(), static_cast<std::streamsize>(pending_ * (InstructionFormat::BITS + 1)));
+        }
+        pending_ = 0;
+    }
+
+    std::ostream&                                               output_;
+    ObjectEncoding                                              encoding_;
+    ObjectHeader                                                header_;
+    std::array<uint8_t, CHUNK * ObjectFormat::INSTRUCTION_BYTES> packed_;
+    std::array<char, CHUNK * (InstructionFormat::BITS + 1)>      text_;
+    size_t                                                      pending_{0};
+};
+
+/**
+ * @class MacroExpander
+ * @brief Procesa las directivas del ensamblador y emite las instrucciones, ya expandidas.
+ *
+ *     .equ NOMBRE expr        constante (o la redefine)
+ *     .repeat N [VAR]         repite hasta el .endr que le corresponde N veces;
+ *     ...                     VAR vale 0..N-1 dentro del bloque
+ *     .endr
+ *
+ * Las líneas fuera de un .repeat se ensamblan en cuanto llegan; un .repeat
+ * del nivel superior se guarda hasta su .endr y se expande entonces, así que
+ * solo los cuerpos de los bloques quedan en memoria.
+ */
+class MacroExpander {
+public:
+    MacroExpander(ObjectWriter& writer, const std::string& source)
+        : writer_(writer), source_(source) {}
+
+    /** @brief Procesa la línea @p number del archivo. */
+    void feed(const std::string& line, size_t number) {
+        if (depth_ == 0 && directive(line) != ".repeat") {
+            run_line(line, number);
+            return;
+        }
+        // Dentro de un bloque: se guarda hasta cerrar el .repeat del nivel superior
+        std::string_view name = directive(line);
+        if (name == ".repeat") ++depth_;
+        if (name == ".endr")   --depth_;
+        block_.push_back({line, number});
+        if (depth_ == 0) {
+            run_lines(block_, 0, block_.size());
+            block_.clear();
+        }
+    }
+
+    /** @brief Fin del archivo: no puede quedar un .repeat abierto. */
+    void finish() const {
+        if (depth_ > 0) {
+            throw std::invalid_argument(source_ + ":" + std::to_string(block_.front().number)
+                                        + ": .repeat sin .endr");
+        }
+    }
+
+private:
+    /** @brief Línea guardada de un bloque .repeat. */
+    struct BodyLine {
+        std::string text;       /**< Línea tal como se leyó */
+        size_t      number;     /**< Número de línea en el archivo */
+    };
+
+    /** @brief Iteración en curso de un .repeat, para los mensajes de error. */
+    struct Frame {
+        std::string_view var;       /**< Variable del bloque ("" si no tiene) */
+        int64_t          iteration; /**< Iteración actual */
+    };
+
+    /** @brief Nombre de la directiva de la línea, o "" si no es una. */
+    static std::string_view directive(std::string_view line) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos || line[start] != '.') return {};
+        size_t end = start;
+        while (end < line.size() && !is_separator(line[end]) && line[end] != ';') ++end;
+        return line.substr(start, end - start);
+    }
+
+    /** @brief Ejecuta lines[begin, end), expandiendo los .repeat que contenga. */
+    void run_lines(const std::vector<BodyLine>& lines, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (directive(lines[i].text) != ".repeat") {
+                run_line(lines[i].text, lines[i].number);
+                continue;
+            }
+
+            // El .endr que cierra este .repeat (los bloques ya llegan balanceados)
+            size_t close = i + 1;
+            for (int depth = 1; ; ++close) {
+                std::string_view name = directive(lines[close].text);
+                if (name == ".repeat") ++depth;
+                if (name == ".endr" && --depth == 0) break;
+            }
+
+            std::string_view var;
+            int64_t times = 0;
+            guarded(lines[i].number, [&]() { times = parse_repeat(lines[i].text, var); });
+
+            size_t symbol = symbols_.size();
+            if (!var.empty()) symbols_.push_back({std::string(var), 0});
+            frames_.push_back({var, 0});
+            for (int64_t k = 0; k < times; ++k) {
+                if (!var.empty()) symbols_[symbol].value = k;
+                frames_.back().iteration = k;
+                run_lines(lines, i + 1, close);
+            }
+            frames_.pop_back();
+            if (!var.empty()) symbols_.erase(symbols_.begin() + static_cast<long>(symbol));
+            i = close;
+        }
+    }
+
+    /** @brief Una línea sin .repeat: instrucción, .equ, o un error. */
+    void run_line(std::string_view line, size_t number) {
+        guarded(number, [&]() {
+            std::string_view name = directive(line);
+            if (name.empty()) {
+                bool empty = false;
+                uint64_t word = Compiler::assemble_line(line, symbols_, empty);
+                if (!empty) writer_.write(word);
+            } else if (name == ".equ") {
+                define(line);
+            } else if (name == ".endr") {
+                throw std::invalid_argument(".endr sin .repeat");
+            } else {
+                throw std::invalid_argument("Directiva no válida: " + std::string(name));
+            }
+        });
+    }
+
+    /** @brief .repeat N [VAR]: devuelve N y deja en @p var el nombre de la variable. */
+    int64_t parse_repeat(std::string_view line, std::string_view& var) const {
+        std::array<std::string_view, TOKENS> tokens;
+        size_t count = split_tokens(line, tokens);
+        if (count < 2 || count > 3) throw std::invalid_argument(".repeat espera una cantidad y, opcional, una variable");
+        int64_t times = Compiler::evaluate(tokens[1], symbols_);
+        if (times < 0) throw std::invalid_argument(".repeat con cantidad negativa: " + describe(times, tokens[1]));
+        var = count == 3 ? check_name(tokens[2]) : std::string_view{};
+        return times;
+    }
+
+    /** @brief .equ NOMBRE expr. */
+    void define(std::string_view line) {
+        std::array<std::string_view, TOKENS> tokens;
+        if (split_tokens(line, tokens) != 3) throw std::invalid_argument(".equ espera un nombre y un valor");
+        std::string_view name = check_name(tokens[1]);
+        int64_t value = Compiler::evaluate(tokens[2], symbols_);
+
+        for (const Frame& frame : frames_) {
+            if (frame.var == name) throw std::invalid_argument(".equ no puede cambiar la variable de .repeat " + std::string(name));
+        }
+        for (auto it = symbols_.rbegin(); it != symbols_.rend(); ++it) {
+            if (it->name == name) {
+                it->value = value;
+                return;
+            }
+        }
+        symbols_.push_back({std::string(name), value});
+    }
+
+    /** @brief Un nombre de símbolo válido que no sea un mnemónico. */
+    static std::string_view check_name(std::string_view name) {
+        if (!is_symbol_start(name[0]) || !std::all_of(name.begin(), name.end(), is_symbol_char)) {
+            throw std::invalid_argument("Nombre de símbolo inválido: " + std::string(name));
+        }
+        if (InstructionFormat::find(name)) {
+            throw std::invalid_argument("Un símbolo no puede llamarse como una instrucción: " + std::string(name));
+        }
+        return name;
+    }
+
+    /** @brief Ejecuta @p body; un error sale con archivo, línea y las iteraciones en curso. */
+    template <typename Body>
+    void guarded(size_t number, Body&& body) {
+        try {
+            body();
+        } catch (const std::invalid_argument& e) {
+            std::string where = source_ + ":" + std::to_string(number);
+            if (!frames_.empty()) {
+                where += " (";
+                for (size_t f = 0; f < frames_.size(); ++f) {
+                    if (f > 0) where += ", ";
+                    where += frames_[f].var.empty() ? "iteración " : std::string(frames_[f].var) + "=";
+                    where += std::to_string(frames_[f].iteration);
                 }
+                where += ")";
             }
+            throw std::invalid_argument(where + ": " + e.what());
         }
-        if (!parts.empty()) instructions.push_back(parts);
+    }
+
+    ObjectWriter&           writer_;        /**< Destino de las instrucciones */
+    const std::string&      source_;        /**< Archivo, para los mensajes */
+    SymbolTable             symbols_;       /**< Constantes y variables de .repeat visibles */
+    std::vector<Frame>      frames_;        /**< .repeat en ejecución, del más externo al más interno */
+    std::vector<BodyLine>   block_;         /**< .repeat del nivel superior que se está leyendo */
+    int                     depth_{0};      /**< .repeat abiertos en block_ */
+};
+
+size_t Compiler::assemble(std::istream& input, std::ostream& output, const std::string& source,
+                          uint32_t pe_id, ObjectEncoding encoding) {
+    ObjectWriter  writer(output, pe_id, encoding);
+    MacroExpander expander(writer, source);
+
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(input, line)) {
+        expander.feed(line, ++line_number);
+    }
+    expander.finish();
+
+    size_t instructions = writer.finish();
+    if (!output) {
+        throw std::runtime_error(source + ": no se pudo escribir el objeto compilado");
     }
     return instructions;
 }
 
-std::vector<std::string> Compiler::get_binary(const std::vector<std::vector<std::string>>& instructions) {
-    std::vector<std::string> binary_instr;
-    for (const auto& instr : instructions) {
-        const std::string& mnemonic = instr[0];
-        auto it = isa.find(mnemonic);
-        if (it == isa.end()) throw std::invalid_argument("Instrucción no válida: " + mnemonic);
-        const std::string& opcode = it->second;
+/* --------------------------------------------------------------------------------------------- */
 
-        if (mnemonic == "WRITE_MEM") {
-            std::string src       = validate_src(instr[1]);
-            std::string addr      = validate_addr(instr[2]);
-            std::string num_cl    = validate_cache_line(instr[3]);
-            std::string start_cl  = validate_cache_line(instr[4]);
-            std::string qos       = validate_qos(instr[5]);
-            binary_instr.push_back(opcode + src + addr + num_cl + start_cl + qos);
-        }
-        else if (mnemonic == "READ_MEM") {
-            std::string src       = validate_src(instr[1]);
-            std::string addr      = validate_addr(instr[2]);
-            std::string size      = validate_cache_line(instr[3]);
-            std::string relleno   = to_bin(0, CACHE_LINE_SIZE);
-            std::string qos       = validate_qos(instr[4]);
-            binary_instr.push_back(opcode + src + addr + size + relleno + qos);
+/* ------------------------------------- Batch compilation ------------------------------------- */
+
+/** @brief Resultado de compilar un archivo, para el reporte final. */
+struct CompileResult {
+    std::string         in_path;            /**< Archivo de ensamblador */
+    std::string         out_path;           /**< Binario generado */
+    size_t              instructions{0};    /**< Instrucciones compiladas */
+    double              ms{0.0};            /**< Tiempo de compilación */
+    bool                written{false};     /**< false si no se pudo leer o escribir */
+    std::exception_ptr  error;              /**< Instrucción inválida (se relanza al final) */
+};
+
+/** @brief PE de un archivo "pe_<n>", o ObjectFormat::ANY_PE si el nombre no tiene esa forma. */
+static uint32_t pe_id_from_stem(const std::string& stem) {
+    const std::string prefix = "pe_";
+    if (stem.compare(0, prefix.size(), prefix) != 0) return ObjectFormat::ANY_PE;
+    uint32_t id = 0;
+    const char* last = stem.data() + stem.size();
+    auto [end, ec] = std::from_chars(stem.data() + prefix.size(), last, id);
+    if (ec != std::errc() || end != last || stem.size() == prefix.size()) return ObjectFormat::ANY_PE;
+    return id;
+}
+
+/** @brief Compila un archivo; los errores quedan en el resultado, no se lanzan. */
+static CompileResult compile_file(const std::filesystem::path& in, const std::string& output_dir) {
+    CompileResult result;
+    result.in_path  = in.string();
+    result.out_path = output_dir + "/" + in.stem().string() + ".bin";
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        std::ifstream input(result.in_path);
+        if (!input) {
+            std::cerr << "[Compiler] Cannot open " << result.in_path << "\n";
+            return result;
         }
-        else if (mnemonic == "BROADCAST_INVALIDATE") {
-            std::string src       = validate_src(instr[1]);
-            std::string relleno1  = to_bin(0, CACHE_LINE_SIZE);
-            std::string cl        = validate_cache_line(instr[2]);
-            std::string relleno2  = to_bin(0, ADDR_SIZE);
-            std::string qos       = validate_qos(instr[3]);
-            binary_instr.push_back(opcode + src + relleno1 + cl + relleno2 + qos);
+        std::ofstream output(result.out_path, std::ios::binary);
+        if (!output) {
+            std::cerr << "[Compiler] Cannot create " << result.out_path << "\n";
+            return result;
         }
+        result.instructions = Compiler::assemble(input, output, result.in_path, pe_id_from_stem(in.stem().string()));
+        result.written      = true;
+    } catch (...) {
+        // No queda un binario a medias que el PE pueda cargar
+        result.error = std::current_exception();
+        std::error_code ec;
+        std::filesystem::remove(result.out_path, ec);
     }
-    return binary_instr;
+
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
 }
 
 void Compiler::compile_directory(const std::string& input_dir,
-                                 const std::string& output_dir) const {
+                                 const std::string& output_dir) {
     namespace fs = std::filesystem;
     try {
         fs::create_directories(output_dir);
@@ -127,26 +717,53 @@ void Compiler::compile_directory(const std::string& input_dir,
         return;
     }
 
+    // Orden fijo por nombre: el reporte no depende del orden del directorio ni de los hilos
+    std::vector<fs::path> files;
     for (auto const& entry : fs::directory_iterator(input_dir)) {
-        if (!entry.is_regular_file()) continue;
-        const auto in_path  = entry.path().string();
-        const auto stem     = entry.path().stem().string();
-        const auto out_path = output_dir + "/" + stem + ".bin";
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) return;
 
-        std::ifstream input(in_path);
-        if (!input) {
-            std::cerr << "[Compiler] Cannot open " << in_path << "\n";
-            continue;
-        }
-        auto instr     = clean_instructions(input);
-        auto bin_instr = get_binary(instr);
+    // Cada archivo es independiente: los hilos toman el siguiente pendiente hasta agotarlos
+    size_t workers = std::min<size_t>(files.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<CompileResult> results(files.size());
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex log_mtx;
+    auto start = std::chrono::steady_clock::now();
 
-        std::ofstream output(out_path);
-        if (!output) {
-            std::cerr << "[Compiler] Cannot create " << out_path << "\n";
-            continue;
-        }
-        for (auto& line : bin_instr) output << line << "\n";
-        std::cout << "[Compiler] " << in_path << " -> " << out_path << "\n";
+    std::vector<std::thread> pool;
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            for (size_t i = next++; i < files.size(); i = next++) {
+                results[i] = compile_file(files[i], output_dir);
+                const CompileResult& r = results[i];
+                std::lock_guard<std::mutex> lock(log_mtx);
+                std::cout << "[Compiler] (" << ++done << "/" << files.size() << ") " << r.in_path;
+                if (r.written) {
+                    std::cout << " -> " << r.out_path << ": " << r.instructions
+                              << " instrucciones en " << r.ms << " ms\n";
+                } else {
+                    std::cout << (r.error ? ": error\n" : ": omitido\n");
+                }
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double busy = 0.0;
+    size_t total = 0;
+    for (const auto& r : results) {
+        busy  += r.ms;
+        total += r.instructions;
+    }
+    std::cout << "[Compiler] " << files.size() << " archivo(s), " << total << " instrucciones en "
+              << wall << " ms con " << workers << " hilo(s) (suma por archivo: " << busy << " ms)\n";
+
+    // Una instrucción inválida detiene la compilación, como antes: se relanza la del primer archivo
+    for (const auto& r : results) {
+        if (r.error) std::rethrow_exception(r.error);
     }
 }
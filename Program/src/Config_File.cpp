@@ -0,0 +1,82 @@
+#include "../include/Config_File.h"
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+/** @brief Quita espacios al inicio y al final. */
+static std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+ConfigFile::ConfigFile(const std::string& path)
+    : path_(path) {
+    std::ifstream infile(path_);
+    if (!infile) return;
+    loaded_ = true;
+
+    std::string line;
+    while (std::getline(infile, line)) {
+        // Quitar comentarios
+        line = line.substr(0, line.find('#'));
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+
+        std::string key   = trim(line.substr(0, colon));
+        std::string value = trim(line.substr(colon + 1));
+        if (!key.empty()) values_[key] = value;
+    }
+}
+
+bool ConfigFile::is_loaded() const {
+    return loaded_;
+}
+
+bool ConfigFile::has(const std::string& key) const {
+    return values_.count(key) != 0;
+}
+
+int64_t ConfigFile::get_int(const std::string& key, int64_t fallback) const {
+    auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    try {
+        return std::stoll(it->second, nullptr, 0);
+    } catch (const std::exception&) {
+        throw std::invalid_argument(path_ + ": valor entero inválido para '" + key + "': " + it->second);
+    }
+}
+
+double ConfigFile::get_double(const std::string& key, double fallback) const {
+    auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    try {
+        return std::stod(it->second);
+    } catch (const std::exception&) {
+        throw std::invalid_argument(path_ + ": valor real inválido para '" + key + "': " + it->second);
+    }
+}
+
+std::string ConfigFile::get_string(const std::string& key, const std::string& fallback) const {
+    auto it = values_.find(key);
+    return it == values_.end() ? fallback : it->second;
+}
+
+bool ConfigFile::get_bool(const std::string& key, bool fallback) const {
+    auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (value == "1" || value == "true" || value == "on" || value == "yes")  return true;
+    if (value == "0" || value == "false" || value == "off" || value == "no") return false;
+    throw std::invalid_argument(path_ + ": valor booleano inválido para '" + key + "': " + it->second);
+}
+
+const std::string& ConfigFile::path() const {
+    return path_;
+}
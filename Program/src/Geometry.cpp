@@ -0,0 +1,42 @@
+#include "../include/Geometry.h"
+#include "../include/Config_File.h"
+#include <stdexcept>
+
+/** @brief true si @p value es potencia de 2 (y distinto de 0). */
+static bool is_power_of_two(uint32_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+Geometry Geometry::load(const std::string& memory_file, const std::string& cache_file) {
+    ConfigFile memory(memory_file);
+    ConfigFile cache(cache_file);
+    Geometry geometry;
+
+    geometry.memory_words = static_cast<uint64_t>(memory.get_int("memory_words",
+                                                                 static_cast<int64_t>(geometry.memory_words)));
+    geometry.sets         = static_cast<uint32_t>(cache.get_int("sets", geometry.sets));
+    geometry.ways         = static_cast<uint32_t>(cache.get_int("ways", geometry.ways));
+    geometry.line_size    = static_cast<uint32_t>(cache.get_int("line_size", geometry.line_size));
+
+    geometry.validate();
+    return geometry;
+}
+
+void Geometry::validate() const {
+    if (memory_words == 0 || memory_words % BLOCK_WORDS != 0) {
+        throw std::invalid_argument("Geometry: memory_words debe ser múltiplo de "
+                                    + std::to_string(BLOCK_WORDS) + " y mayor que 0");
+    }
+    if (memory_words > max_memory_words()) {
+        throw std::invalid_argument("Geometry: memory_words no puede pasar de 2^"
+                                    + std::to_string(ADDRESS_FIELD_BITS)
+                                    + ", lo que direcciona el campo ADDR");
+    }
+    if (!is_power_of_two(sets) || ways == 0) {
+        throw std::invalid_argument("Geometry: sets debe ser potencia de 2 y ways mayor que 0");
+    }
+    if (!is_power_of_two(line_size) || line_size < BLOCK_SIZE) {
+        throw std::invalid_argument("Geometry: line_size debe ser potencia de 2 y al menos "
+                                    + std::to_string(BLOCK_SIZE));
+    }
+}
@@ -2,9 +2,12 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
 
-InstructionGenerator::InstructionGenerator(int num_pes, int instructions_per_file)
-    : num_pes_(num_pes), instructions_per_file_(instructions_per_file), rng_(rd_()) {}
+InstructionGenerator::InstructionGenerator(int num_pes, int instructions_per_file,
+                                           const Geometry& geometry)
+    : num_pes_(num_pes), instructions_per_file_(instructions_per_file),
+      geometry_(geometry), rng_(rd_()) {}
 
 void InstructionGenerator::generate() const {
 
@@ -32,19 +35,32 @@ std::string InstructionGenerator::generate_instruction(int pe_id) const {
     std::uniform_int_distribution<int> instr_selector(0, 2);
     int instr_type = instr_selector(rng_);
 
-    std::uniform_int_distribution<int> addr_dist(0, (MEM_SIZE - 1) / 4);
-    std::uniform_int_distribution<int> cache_line_dist(0, CACHE_LINES - 1);
-    
-    std::uniform_int_distribution<int> size_dist(1, 16);
+    // Límites tomados de la misma Geometry que valida el compilador
+    const int cache_lines  = static_cast<int>(geometry_.cache_block_limit());
+    const int cache_frames = static_cast<int>(geometry_.cache_frame_limit());
+    const int max_blocks  = static_cast<int>(Geometry::max_read_size() / Geometry::BLOCK_SIZE);
+
+    std::uniform_int_distribution<uint64_t> addr_dist(0, geometry_.address_limit() / Geometry::BLOCK_WORDS - 1);
+    std::uniform_int_distribution<int> cache_line_dist(0, cache_lines - 1);
+    std::uniform_int_distribution<int> cache_frame_dist(0, cache_frames - 1);
+
+    // Bloques desde addr hasta el final de la memoria: el acceso entero debe caber, como valida el compilador
+    auto blocks_left = [this](uint64_t addr) {
+        return static_cast<int>(std::min<uint64_t>((geometry_.address_limit() - addr) / Geometry::BLOCK_WORDS,
+                                                   Geometry::max_field_value()));
+    };
+
     std::uniform_int_distribution<int> qos_dist(0, MAX_QOS);
 
     std::string instruction;
 
     switch (instr_type) {
         case 0: { // WRITE_MEM
-            int addr = addr_dist(rng_) * 4;
+            uint64_t addr = addr_dist(rng_) * Geometry::BLOCK_WORDS;
             int start_cache_line = cache_line_dist(rng_);
-            std::uniform_int_distribution<int> num_cache_lines_dist(1, CACHE_LINES - start_cache_line);
+            int max_count = std::min({cache_lines - start_cache_line, static_cast<int>(Geometry::max_field_value()),
+                                      blocks_left(addr)});
+            std::uniform_int_distribution<int> num_cache_lines_dist(1, max_count);
             int num_cache_lines = num_cache_lines_dist(rng_);
             int qos = qos_dist(rng_);
             instruction = "WRITE_MEM " + std::to_string(pe_id) + ", " +
@@ -55,8 +71,9 @@ std::string InstructionGenerator::generate_instruction(int pe_id) const {
             break;
         }
         case 1: { // READ_MEM
-            int addr = addr_dist(rng_) * 4;
-            int size = size_dist(rng_) * 16; /* Alineado con los bloques de Cache */
+            uint64_t addr = addr_dist(rng_) * Geometry::BLOCK_WORDS;
+            std::uniform_int_distribution<int> size_dist(1, std::min(max_blocks, blocks_left(addr)));
+            int size = size_dist(rng_) * Geometry::BLOCK_SIZE; /* Alineado con los bloques de Cache */
             int qos = qos_dist(rng_);
             instruction = "READ_MEM " + std::to_string(pe_id) + ", " +
                           std::to_string(addr) + ", " +
@@ -65,7 +82,7 @@ std::string InstructionGenerator::generate_instruction(int pe_id) const {
             break;
         }
         case 2: { // BROADCAST_INVALIDATE
-            int cache_line = cache_line_dist(rng_);
+            int cache_line = cache_frame_dist(rng_);
             int qos = qos_dist(rng_);
             instruction = "BROADCAST_INVALIDATE " + std::to_string(pe_id) + ", " +
                           std::to_string(cache_line) + ", " +
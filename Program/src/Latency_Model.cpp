@@ -0,0 +1,167 @@
+#include "../include/Latency_Model.h"
+#include "../include/Config_File.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+LatencyModel::LatencyModel(const LatencyParams& params)
+    : params_(params) {}
+
+LatencyModel LatencyModel::load_from_file(const std::string& filename) {
+    ConfigFile cfg(filename);
+    LatencyParams p;
+
+    if (!cfg.is_loaded()) {
+        std::cerr << "[LatencyModel] Warning: could not open " << filename
+                  << ", using default latencies\n";
+        return LatencyModel(p);
+    }
+
+    auto cycles = [&](const char* key, uint32_t fallback) {
+        return static_cast<uint32_t>(cfg.get_int(key, fallback));
+    };
+
+    p.fetch               = cycles("fetch",               p.fetch);
+    p.cache_read_per_line = cycles("cache_read_per_line", p.cache_read_per_line);
+    p.send                = cycles("send",                p.send);
+    p.queue_wait_per_unit = cycles("queue_wait_per_unit", p.queue_wait_per_unit);
+    p.response_scale      = cfg.get_double("response_scale", p.response_scale);
+    p.read_mem_base       = cycles("read_mem_base",       p.read_mem_base);
+    p.write_mem_base      = cycles("write_mem_base",      p.write_mem_base);
+    p.inv_line            = cycles("inv_line",            p.inv_line);
+    p.inv_complete_per_pe = cycles("inv_complete_per_pe", p.inv_complete_per_pe);
+    p.inv_complete        = cycles("inv_complete",        p.inv_complete);
+    p.response_receive    = cycles("response_receive",    p.response_receive);
+    p.inv_ack             = cycles("inv_ack",             p.inv_ack);
+    p.read_resp_per_byte  = cycles("read_resp_per_byte",  p.read_resp_per_byte);
+    p.write_resp          = cycles("write_resp",          p.write_resp);
+    p.inv_complete_resp   = cycles("inv_complete_resp",   p.inv_complete_resp);
+    p.snoop_per_pe        = cycles("snoop_per_pe",        p.snoop_per_pe);
+    p.coherence_upgrade   = cycles("coherence_upgrade",   p.coherence_upgrade);
+    p.coherence_invalidate = cycles("coherence_invalidate", p.coherence_invalidate);
+    p.coherence_downgrade = cycles("coherence_downgrade", p.coherence_downgrade);
+    p.c2c_base            = cycles("c2c_base",            p.c2c_base);
+    p.c2c_per_line        = cycles("c2c_per_line",        p.c2c_per_line);
+
+    std::cout << "[LatencyModel] Loaded latencies from " << filename << "\n";
+    return LatencyModel(p);
+}
+
+const LatencyParams& LatencyModel::params() const {
+    return params_;
+}
+
+/* ------------------------------------------- PE ---------------------------------------------- */
+
+uint32_t LatencyModel::instruction_fetch() const {
+    return params_.fetch;
+}
+
+uint32_t LatencyModel::cache_read(uint32_t num_lines) const {
+    return params_.cache_read_per_line * num_lines;
+}
+
+uint32_t LatencyModel::send_to_interconnect() const {
+    return params_.send;
+}
+
+uint32_t LatencyModel::response_receive() const {
+    return params_.response_receive;
+}
+
+uint32_t LatencyModel::inv_ack() const {
+    return params_.inv_ack;
+}
+
+uint32_t LatencyModel::read_resp(uint32_t size) const {
+    return params_.read_resp_per_byte * size;
+}
+
+uint32_t LatencyModel::write_resp() const {
+    return params_.write_resp;
+}
+
+uint32_t LatencyModel::inv_complete_resp() const {
+    return params_.inv_complete_resp;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* --------------------------------------- Interconnect ---------------------------------------- */
+
+uint32_t LatencyModel::queue_wait(const Message& msg, ArbitScheme scheme) const {
+    uint32_t wait = params_.queue_wait_per_unit * (msg.get_num_lines() + msg.get_size());
+    if (scheme != ArbitScheme::PRIORITY) {
+        return wait;
+    }
+
+    // Mayor QoS => menos espera. QoS 0 se trata como 1 para no dividir entre cero.
+    double qos = std::max<double>(1.0, msg.get_qos());
+    return static_cast<uint32_t>(std::lround(wait / qos));
+}
+
+uint32_t LatencyModel::response_share(uint32_t request_latency) const {
+    return static_cast<uint32_t>(request_latency * params_.response_scale);
+}
+
+uint32_t LatencyModel::memory_read(uint32_t size) const {
+    return (params_.read_mem_base + size) * size;
+}
+
+uint32_t LatencyModel::memory_write(uint32_t num_lines) const {
+    return (params_.write_mem_base + num_lines) * num_lines;
+}
+
+uint32_t LatencyModel::inv_line() const {
+    return params_.inv_line;
+}
+
+uint32_t LatencyModel::inv_complete_collect(uint32_t total_pes) const {
+    return params_.inv_complete_per_pe * total_pes;
+}
+
+uint32_t LatencyModel::inv_complete() const {
+    return params_.inv_complete;
+}
+
+uint32_t LatencyModel::coherence(const CoherenceStats& transactions) const {
+    return static_cast<uint32_t>(params_.snoop_per_pe         * transactions.snoops
+                               + params_.coherence_upgrade    * transactions.upgrades
+                               + params_.coherence_invalidate * transactions.invalidations
+                               + params_.coherence_downgrade  * transactions.downgrades);
+}
+
+uint32_t LatencyModel::cache_to_cache(uint32_t num_lines) const {
+    return params_.c2c_base + params_.c2c_per_line * num_lines;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ---------------------------------------- Testing -------------------------------------------- */
+
+void LatencyModel::debug_print() const {
+    std::cout << "[LatencyModel] fetch=" << params_.fetch
+              << " cache_read_per_line=" << params_.cache_read_per_line
+              << " send=" << params_.send
+              << " queue_wait_per_unit=" << params_.queue_wait_per_unit
+              << " response_scale=" << params_.response_scale
+              << " read_mem_base=" << params_.read_mem_base
+              << " write_mem_base=" << params_.write_mem_base
+              << "\n[LatencyModel] inv_line=" << params_.inv_line
+              << " inv_complete_per_pe=" << params_.inv_complete_per_pe
+              << " inv_complete=" << params_.inv_complete
+              << " response_receive=" << params_.response_receive
+              << " inv_ack=" << params_.inv_ack
+              << " read_resp_per_byte=" << params_.read_resp_per_byte
+              << " write_resp=" << params_.write_resp
+              << " inv_complete_resp=" << params_.inv_complete_resp
+              << "\n[LatencyModel] snoop_per_pe=" << params_.snoop_per_pe
+              << " coherence_upgrade=" << params_.coherence_upgrade
+              << " coherence_invalidate=" << params_.coherence_invalidate
+              << " coherence_downgrade=" << params_.coherence_downgrade
+              << " c2c_base=" << params_.c2c_base
+              << " c2c_per_line=" << params_.c2c_per_line
+              << "\n";
+}
+
+/* --------------------------------------------------------------------------------------------- */
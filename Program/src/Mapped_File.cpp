@@ -0,0 +1,132 @@
+#include "../include/Mapped_File.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+/** @brief Mensaje de error con la ruta y el errno actual. */
+static std::string mmap_error(const std::string& what, const std::string& path) {
+    return "Error: " + what + " " + path + ": " + std::strerror(errno);
+}
+
+MappedFile::MappedFile(const std::string& path, size_t size) : path_(path), size_(size) {
+    if (size == 0) {
+        throw std::runtime_error("Error: no se puede mapear un archivo vacío: " + path);
+    }
+
+    // Un archivo de otro tamaño no se pisa: se aparta a .bak y se empieza de cero
+    struct stat old {};
+    if (::stat(path.c_str(), &old) == 0 && old.st_size != 0 && static_cast<size_t>(old.st_size) != size) {
+        std::string backup = path + ".bak";
+        if (std::rename(path.c_str(), backup.c_str()) != 0) {
+            throw std::runtime_error(mmap_error("no se pudo apartar", path));
+        }
+        std::cerr << "[MappedFile] Warning: " << path << " has " << old.st_size << " bytes, expected "
+                  << size << "; moved to " << backup << "\n";
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error(mmap_error("no se pudo abrir", path));
+    }
+
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+        int err = errno;
+        ::close(fd_);
+        errno = err;
+        throw std::runtime_error(mmap_error("no se pudo consultar", path));
+    }
+
+    reused_ = static_cast<size_t>(st.st_size) == size;
+    if (!reused_) {
+        // Archivo nuevo (o vacío): ftruncate lo deja disperso en cero
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            int err = errno;
+            ::close(fd_);
+            errno = err;
+            throw std::runtime_error(mmap_error("no se pudo redimensionar", path));
+        }
+    }
+
+    void* region = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (region == MAP_FAILED) {
+        int err = errno;
+        ::close(fd_);
+        errno = err;
+        throw std::runtime_error(mmap_error("no se pudo mapear", path));
+    }
+    data_ = static_cast<uint8_t*>(region);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)),
+      data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      fd_(std::exchange(other.fd_, -1)),
+      reused_(other.reused_) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_   = std::move(other.path_);
+        data_   = std::exchange(other.data_, nullptr);
+        size_   = std::exchange(other.size_, 0);
+        fd_     = std::exchange(other.fd_, -1);
+        reused_ = other.reused_;
+    }
+    return *this;
+}
+
+Storage MappedFile::parse_storage(const std::string& name) {
+    if (name == "heap") return Storage::HEAP;
+    if (name == "mmap") return Storage::MMAP;
+    throw std::invalid_argument("storage debe ser 'heap' o 'mmap': " + name);
+}
+
+const char* MappedFile::storage_to_string(Storage storage) {
+    return storage == Storage::MMAP ? "mmap" : "heap";
+}
+
+InitMode MappedFile::parse_init(const std::string& name) {
+    if (name == "random") return InitMode::RANDOM;
+    if (name == "seed")   return InitMode::SEED;
+    if (name == "image")  return InitMode::IMAGE;
+    throw std::invalid_argument("init debe ser 'random', 'seed' o 'image': " + name);
+}
+
+void MappedFile::sync() const {
+    if (data_ && ::msync(data_, size_, MS_SYNC) != 0) {
+        throw std::runtime_error(mmap_error("msync falló en", path_));
+    }
+}
+
+void MappedFile::discard() {
+    if (fd_ < 0) return;
+    // Achicar a cero suelta las páginas viejas; al volver al tamaño se leen como cero
+    if (::ftruncate(fd_, 0) != 0 || ::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+        throw std::runtime_error(mmap_error("no se pudo vaciar", path_));
+    }
+    reused_ = false;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
@@ -30,6 +30,9 @@ uint32_t Message::get_cache_line() const { return cache_line_; }
 uint32_t Message::get_status() const { return status_; }
 const std::vector<std::vector<uint8_t>>& Message::get_data() const { return data_; }
 uint32_t Message::get_broadcast_id() const { return broadcast_id_; }
+uint32_t Message::get_tag() const { return tag_; }
+bool Message::is_prefetch() const { return prefetch_; }
+bool Message::is_posted() const { return posted_; }
 
 void Message::set_operation(Operation op) { operation_ = op; }
 void Message::set_src_id(int id) { src_id_ = id; }
@@ -43,6 +46,9 @@ void Message::set_cache_line(uint32_t cl) { cache_line_ = cl; }
 void Message::set_status(uint32_t st) { status_ = st; }
 void Message::set_data(std::vector<std::vector<uint8_t>>& data) { data_ = data; }
 void Message::set_broadcast_id(uint32_t id) { broadcast_id_ = id; }
+void Message::set_tag(uint32_t tag) { tag_ = tag; }
+void Message::set_prefetch(bool prefetch) { prefetch_ = prefetch; }
+void Message::set_posted(bool posted) { posted_ = posted; }
 
 /* --------------------------------------------------------------------------------------------- */
 
@@ -104,6 +110,7 @@ std::string Message::to_string() const {
             case Operation::INV_COMPLETE:           return "INV_COMPLETE";
             case Operation::READ_RESP:              return "READ_RESP";
             case Operation::WRITE_RESP:             return "WRITE_RESP";
+            case Operation::WRITEBACK:              return "WRITEBACK";
             case Operation::END:                    return "END";
             case Operation::UNDEFINED:              return "UNDEFINED";
         }
@@ -112,10 +119,11 @@ std::string Message::to_string() const {
 
     char buf[256];
     std::snprintf(buf, sizeof(buf),
-                  "[MSG %s src=%d dst=%d qos=%u addr=0x%016llX size=%u nl=%u sl=%u cl=%u status=%u data_words=%zu latency=%u]",
+                  "[MSG %s src=%d dst=%d qos=%u addr=0x%016llX size=%u nl=%u sl=%u cl=%u status=%u data_words=%zu latency=%u tag=%u%s%s]",
                   operation_name(operation_), src_id_, dest_id_, qos_,
                   static_cast<unsigned long long>(address_), size_, num_lines_,
-                  start_line_, cache_line_, status_, data_.size(), latency_);
+                  start_line_, cache_line_, status_, data_.size(), latency_, tag_,
+                  prefetch_ ? " prefetch" : "", posted_ ? " posted" : "");
     return std::string(buf);
 }
 
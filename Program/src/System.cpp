@@ -1,10 +1,14 @@
 #include "../include/System.h"
+#include "../include/Config_File.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
 #include <thread>
 #include <bitset>
+#include <algorithm>
+#include <filesystem>
+#include <exception>
 
 /* ---------------------------------------- Constructor ---------------------------------------- */
 
@@ -21,20 +25,24 @@ System::System(int num_pes, ArbitScheme scheme, bool stepping_enabled)
 
 void System::initialize() {
 
-    std::cout << "\n[System] Initializing Interconnect...\n";
-    initialize_interconnect();
-    
     std::cout << "\n[System] Initializing " << total_pes_ << " PEs...\n";
     initialize_pes();
 
+    // Después de los PEs: la tabla de broadcasts se dimensiona con su ventana
+    std::cout << "\n[System] Initializing Interconnect...\n";
+    initialize_interconnect();
+
     std::cout << "\n[System] Setting up Local Cache for " << total_pes_ << " PEs...\n";
     initialize_caches();
 
     std::cout << "\n[System] Setting up Shared Memory...\n";
     initialize_shared_memory();
 
+    std::cout << "\n[System] Getting simulation times from config/times.txt...\n";
+    latency_ = LatencyModel::load_from_file("config/times.txt");
+    latency_.debug_print();
+
     // TODO: estas inicializaciones
-    std::cout << "\n[System] Getting simulation times... (TODO)\n";
 
     std::cout << "\n[System] Setting up Statistics Unit... (TODO)\n";
 
@@ -42,7 +50,8 @@ void System::initialize() {
 }
 
 void System::initialize_interconnect() {
-    interconnect_ = std::make_unique<Interconnect>(total_pes_, scheme_);
+    size_t max_broadcasts = static_cast<size_t>(total_pes_) * max_outstanding_;
+    interconnect_ = std::make_unique<Interconnect>(total_pes_, scheme_, max_broadcasts);
 }
 
 void System::initialize_pes() {
@@ -70,27 +79,91 @@ void System::initialize_pes() {
         }
     }
 
+    // Ventana de peticiones en vuelo por PE (1 = PE bloqueante)
+    std::cout << "[System] Getting PEs' outstanding request window from config/pe.txt...\n";
+    ConfigFile pe_cfg("config/pe.txt");
+    if (!pe_cfg.is_loaded()) {
+        std::cerr << "[System] Warning: could not open config/pe.txt, "
+                  << "using max_outstanding=1 for all PEs\n";
+    }
+    int64_t window = pe_cfg.get_int("max_outstanding", 1);
+    max_outstanding_ = window < 1 ? 1 : static_cast<size_t>(window);
+    WriteCombineConfig wc_config = WriteCombineConfig::from_config(pe_cfg);
+    drained_pes_.store(0);
+
     // Instancia los PEs con QoS leído o 0 por defecto
     pes_.clear();
     for (int i = 0; i < total_pes_; ++i) {
         uint8_t qos = qos_map.count(i) ? qos_map[i] : 0;
-        pes_.emplace_back(i, qos);
+        pes_.emplace_back(i, qos, max_outstanding_);
+    }
+    write_buffers_.assign(static_cast<size_t>(total_pes_), WriteCombiningBuffer(wc_config));
+    if (wc_config.entries > 0) {
+        std::cout << "[System] Write-combining: " << wc_config.entries << " entries per PE, window="
+                  << wc_config.window << " steps, max_blocks=" << wc_config.max_blocks << "\n";
     }
 }
 
 void System::initialize_caches() {
+    std::cout << "[System] Getting cache geometry from config/cache.txt...\n";
+    CacheConfig config = CacheConfig::load_from_file("config/cache.txt");
+
     caches_.clear();
-    caches_.reserve(total_pes_);
     for (int i = 0; i < total_pes_; ++i) {
-        caches_.emplace_back(i);  // construye un LocalCache vacío
+        caches_.emplace_back(i, config);  // construye un LocalCache frío (sin líneas válidas)
         std::cout << "[System] Cache " << i << " instantiated.\n";
     }
 
+    // Cada caché tiene su propio flujo aleatorio y sus propios archivos: se llenan en paralelo
+    std::filesystem::create_directories("config/caches");
+    size_t workers = std::min<size_t>(caches_.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> fillers;
+    std::vector<std::exception_ptr> errors(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        fillers.emplace_back([this, w, workers, &errors]() {
+            try {
+                for (size_t i = w; i < caches_.size(); i += workers) {
+                    caches_[i].initialize();
+                }
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+    for (auto& t : fillers) t.join();
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+
+    // Directorio de sharers/owner para responder lecturas desde otro caché
+    directory_.reset();
+    if (config.cache_to_cache) {
+        directory_ = std::make_unique<Directory>(total_pes_);
+    }
+
     std::cout << "[System] All local caches initialized.\n";
 }
 
 void System::initialize_shared_memory() {
-    shared_memory_ = std::make_unique<SharedMemory>();
+    std::cout << "[System] Getting memory banks from config/memory.txt...\n";
+    MemoryConfig config = MemoryConfig::load_from_file("config/memory.txt");
+    config.dram = DramConfig::load_from_file("config/dram.txt");
+    shared_memory_ = std::make_unique<SharedMemory>(config);
+
+    SharedCacheConfig l2_config = SharedCacheConfig::load_from_file("config/memory.txt");
+    shared_cache_.reset();
+    if (l2_config.enabled) {
+        shared_cache_ = std::make_unique<SharedCache>(l2_config, *shared_memory_);
+    }
+
+    ControllerConfig mc_config = ControllerConfig::load_from_file("config/memory.txt");
+    memory_controller_.reset();
+    if (mc_config.enabled) {
+        memory_controller_ = std::make_unique<MemoryController>(mc_config, *shared_memory_);
+        std::cout << "[System] Memory controller: " << ControllerConfig::policy_to_string(mc_config.policy)
+                  << ", read queue " << mc_config.read_queue << ", write queue " << mc_config.write_queue
+                  << " (drain " << mc_config.write_high << " -> " << mc_config.write_low << ")\n";
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -142,6 +215,25 @@ void System::run() {
 
     // 5) Esperar a que el Interconnect termine
     join_interconnect_thread();
+
+    // 6) Volcar el estado final de la memoria compartida y de los caches
+    /* Las líneas sucias de los L1 y luego las del L2 se escriben antes para que el volcado esté al día */
+    for (auto& cache : caches_) {
+        std::vector<Writeback> dirty = cache.flush_dirty();
+        if (!dirty.empty()) {
+            write_back_lines(dirty);
+            std::cout << "[System] L1 flush: " << dirty.size() << " línea(s) sucia(s) escritas\n";
+        }
+    }
+    if (shared_cache_) {
+        uint64_t written = shared_cache_->flush();
+        std::cout << "[System] L2 flush: " << written << " línea(s) sucia(s) escritas en SharedMemory\n";
+    }
+    shared_memory_->dump_to_binary_file();
+    shared_memory_->dump_to_text_file();
+    for (const auto& cache : caches_) {
+        cache.persist();
+    }
 }
 
 /* ------------------------------------ */
@@ -176,6 +268,9 @@ void System::pe_execution_cycle(int pe_id) {
     // 0.2) Referencia al Cache correspondiente al PE
     LocalCache& cache = caches_.at(pe_id);
 
+    // 0.2b) Write-combining buffer del PE (solo lo usa este hilo)
+    WriteCombiningBuffer& wc = write_buffers_.at(pe_id);
+
     // 0.3) Se obtiene la cantidad de instrucciones por ejecutar
     size_t total_instr = pe.instruction_memory_.size();
 
@@ -187,6 +282,9 @@ void System::pe_execution_cycle(int pe_id) {
               << ", instr_count=" << total_instr
               << "\n";
 
+    /* true cuando el PE ya emitió todo y no le queda ninguna petición en vuelo */
+    bool drained = false;
+
     /* Ciclo de ejecucion correra hasta que el estado del PE llegue a FINISHED */
     while (pe.get_state() != PEState::FINISHED) {
 
@@ -201,143 +299,177 @@ void System::pe_execution_cycle(int pe_id) {
         // Actualizamos el tracker local
         last_step = current_step_;
 
-        // —— 4) CHEQUEO DE RESPUESTA —— 
-        if (pe.get_response_state() == PEResponseState::WAITING) {
-
-            if (interconnect_->has_response(pe_id)) {
-
-                // Se pondra a procesar la respuesta
-                pe.set_response_state(PEResponseState::PROCESSING);
+        // —— 4) CHEQUEO DE RESPUESTA ——
+        /* Se revisa siempre, aunque el PE no espere nada propio: los INV_LINE de
+           broadcasts de otros PEs pueden llegar en cualquier momento */
+        if (interconnect_->has_response(pe_id)) {
+
+            // Se pondra a procesar la respuesta
+            pe.set_response_state(PEResponseState::PROCESSING);
+
+            // 1) Sacamos UNA respuesta para este PE
+            Message resp = interconnect_->pop_response(pe_id);
+
+            // 6) Calculamos y asignamos la latencia
+            resp.increment_full_latency(latency_.response_receive());
+
+            // 2) El PE la procesa
+            std::cout << "[PE " << pe_id << "] Received response: "
+                    << resp.to_string() << "\n";
+
+            // 1) CASO INV_LINE
+            if (resp.get_operation() == Operation::INV_LINE) {
+                // 1.a) Invalida la línea en el cache local
+                cache.invalidate_line(resp.get_cache_line(), pe_id);
+                
+                // 1.b) Construye el ACK usando el mismo broadcast_id
+                Message inv_ack(
+                    Operation::INV_ACK,
+                    /*src=*/pe_id,
+                    /*dst=*/-1,  // Interconnect (no lo usas en tu diseño)
+                    /*addr=*/0,
+                    /*qos=*/resp.get_qos(), // Mantiene el QoS del PE que envio el B_I
+                    /*size=*/0,
+                    /*num_lines=*/0,
+                    /*start_line=*/0,
+                    /*cache_line=*/0,
+                    /*status=*/0,
+                    /*data=*/{}
+                );
 
-                // 1) Sacamos UNA respuesta para este PE
-                Message resp = interconnect_->pop_response(pe_id);
+                inv_ack.set_broadcast_id(resp.get_broadcast_id());
 
                 // 6) Calculamos y asignamos la latencia
-                resp.increment_full_latency(10);
-
-                // 2) El PE la procesa
-                std::cout << "[PE " << pe_id << "] Received response: "
-                        << resp.to_string() << "\n";
-
-                // 1) CASO INV_LINE
-                if (resp.get_operation() == Operation::INV_LINE) {
-                    // 1.a) Invalida la línea en el cache local
-                    cache.invalidate_line(resp.get_cache_line(), pe_id);
-                    
-                    // 1.b) Construye el ACK usando el mismo broadcast_id
-                    Message inv_ack(
-                        Operation::INV_ACK,
-                        /*src=*/pe_id,
-                        /*dst=*/-1,  // Interconnect (no lo usas en tu diseño)
-                        /*addr=*/0,
-                        /*qos=*/resp.get_qos(), // Mantiene el QoS del PE que envio el B_I
-                        /*size=*/0,
-                        /*num_lines=*/0,
-                        /*start_line=*/0,
-                        /*cache_line=*/0,
-                        /*status=*/0,
-                        /*data=*/{}
-                    );
+                resp.increment_full_latency(latency_.inv_ack());
 
-                    inv_ack.set_broadcast_id(resp.get_broadcast_id());
+                /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
+                log_message_metrics(resp);
 
-                    // 6) Calculamos y asignamos la latencia
-                    resp.increment_full_latency(6 + 3 + 4);
-
-                    /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
-                    log_message_metrics(resp);
+                // Se envia al in_queue del Interconnect como un mensaje asincrono
+                interconnect_->push_message(inv_ack);
 
-                    // Se envia al in_queue del Interconnect como un mensaje asincrono
-                    interconnect_->push_message(inv_ack);
-
-                    std::cout << "[PE " << pe_id 
-                            << "] Procesado INV_LINE (línea " << resp.get_cache_line()
-                            << "), enviado INV_ACK con bid=" << resp.get_broadcast_id() << "\n";
+                std::cout << "[PE " << pe_id 
+                        << "] Procesado INV_LINE (línea " << resp.get_cache_line()
+                        << "), enviado INV_ACK con bid=" << resp.get_broadcast_id() << "\n";
 
-                    /* State check */
-                    //if(pe.get_actual_message().get_operation() == Operation::BROADCAST_INVALIDATE) {
-                    pe.set_response_state(PEResponseState::WAITING);
-                    //}
+            }
 
+            // 2) CASO READ_RESP
+            else if (resp.get_operation() == Operation::READ_RESP) {
+                // Por ahora solo imprimimos información básica
+                std::cout << "[PE " << pe_id << "] READ_RESP recibido:\n"
+                        << "    Dirección solicitada: 0x" << std::hex << resp.get_address() << std::dec << "\n"
+                        << "    Tamaño solicitado: " << resp.get_size() << " bytes\n"
+                        << "    Líneas de cache leídas: " << resp.get_num_lines() << "\n"
+                        << "    Payload (líneas): " << resp.get_data().size() << "\n";
+                // Opcional: imprimir primer byte de cada línea
+                for (size_t i = 0; i < resp.get_data().size(); ++i) {
+                    const auto& line = resp.get_data()[i];
+                    if (!line.empty()) {
+                        std::cout << "      Línea[" << i << "][0] = 0x"
+                                << std::hex << static_cast<int>(line[0]) << std::dec << "\n";
+                    }
                 }
 
-                // 2) CASO READ_RESP
-                else if (resp.get_operation() == Operation::READ_RESP) {
-                    // Por ahora solo imprimimos información básica
-                    std::cout << "[PE " << pe_id << "] READ_RESP recibido:\n"
-                            << "    Dirección solicitada: 0x" << std::hex << resp.get_address() << std::dec << "\n"
-                            << "    Tamaño solicitado: " << resp.get_size() << " bytes\n"
-                            << "    Líneas de cache leídas: " << resp.get_num_lines() << "\n"
-                            << "    Payload (líneas): " << resp.get_data().size() << "\n";
-                    // Opcional: imprimir primer byte de cada línea
-                    for (size_t i = 0; i < resp.get_data().size(); ++i) {
-                        const auto& line = resp.get_data()[i];
-                        if (!line.empty()) {
-                            std::cout << "      Línea[" << i << "][0] = 0x"
-                                    << std::hex << static_cast<int>(line[0]) << std::dec << "\n";
-                        }
+                // Instala las líneas en el caché (la petición se alineó a línea al emitirla);
+                // una lectura NOT_OK no trae datos y solo libera su entrada de la ventana
+                try {
+                    if (resp.get_status() & STATUS_OK) {
+                        cache.fill_lines(resp.get_address(), resp.get_data(),
+                                         (resp.get_status() & STATUS_SHARED) != 0);
                     }
+                } catch (const std::exception& e) {
+                    std::cerr << "[PE " << pe_id << "] Error filling cache lines: " << e.what() << "\n";
+                }
 
-                    // Escribe en cache quemado en 0 lol, sorry profe
-                    cache.write_cache_lines(pe_id, resp.get_start_line(), resp.get_data());
-
-                    // Calculamos y asignamos la latencia
-                    resp.increment_full_latency(4 * resp.get_size());
-
-                    /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
-                    log_message_metrics(resp);
+                // Un prefetch no está en la ventana: solo se avisa al prefetcher
+                if (resp.is_prefetch() && cache.get_prefetcher()) {
+                    cache.get_prefetcher()->on_fill(cache.line_of(resp.get_address()));
+                }
 
-                    /* Check PE states */
-                    pe.set_response_state(PEResponseState::COMPLETED);
-                    pe.set_state(PEState::IDLE);
+                // Calculamos y asignamos la latencia
+                resp.increment_full_latency(latency_.read_resp(resp.get_size()));
 
-                // 3) CASO WRITE_RESP
-                } else if (resp.get_operation() == Operation::WRITE_RESP) {
-                    std::cout << "[PE " << pe_id << "] WRITE_RESP recibido:\n"
-                            << "    Dirección escrita: 0x" << std::hex << resp.get_address() << std::dec << "\n"
-                            << "    Estado (status): 0x" << std::hex << resp.get_status() << std::dec << "\n";
+                /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
+                log_message_metrics(resp);
 
-                    // Calculamos y asignamos la latencia
-                    resp.increment_full_latency(5);
+            // 3) CASO WRITE_RESP
+            } else if (resp.get_operation() == Operation::WRITE_RESP) {
+                std::cout << "[PE " << pe_id << "] WRITE_RESP recibido:\n"
+                        << "    Dirección escrita: 0x" << std::hex << resp.get_address() << std::dec << "\n"
+                        << "    Estado (status): 0x" << std::hex << resp.get_status() << std::dec << "\n";
 
-                    /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
-                    log_message_metrics(resp);
+                // Calculamos y asignamos la latencia
+                resp.increment_full_latency(latency_.write_resp());
 
-                    /* Check PE states */
-                    pe.set_response_state(PEResponseState::COMPLETED);
-                    pe.set_state(PEState::IDLE);
+                /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
+                log_message_metrics(resp);
 
-                // 4) CASO INV_COMPLETE
-                } else if (resp.get_operation() == Operation::INV_COMPLETE) {
-                    std::cout << "[PE " << pe_id << "] INV_COMPLETE recibido:\n"
-                            << "    Broadcast ID: " << resp.get_broadcast_id() << "\n"
-                            << "    Línea inválidada confirmada por todos los PEs.\n";
+            // 4) CASO INV_COMPLETE
+            } else if (resp.get_operation() == Operation::INV_COMPLETE) {
+                std::cout << "[PE " << pe_id << "] INV_COMPLETE recibido:\n"
+                        << "    Broadcast ID: " << resp.get_broadcast_id() << "\n"
+                        << "    Línea inválidada confirmada por todos los PEs.\n";
 
-                    // Calculamos y asignamos la latencia
-                    resp.increment_full_latency(5);
+                // Calculamos y asignamos la latencia
+                resp.increment_full_latency(latency_.inv_complete_resp());
 
-                    /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
-                    log_message_metrics(resp);
+                /*TODO: FIN DE MESSAGE PATH -> EXPORTAR DATOS DE LATENCIA*/
+                log_message_metrics(resp);
+            }
 
-                    /* Check PE states */
-                    pe.set_response_state(PEResponseState::COMPLETED);
-                    pe.set_state(PEState::IDLE);
+            // 5) Las respuestas a peticiones propias liberan su entrada de la ventana;
+            //    las escrituras posted solo se descuentan del write-combining buffer
+            if (resp.is_posted()) {
+                wc.on_complete();
+            } else if (resp.get_operation() != Operation::INV_LINE && !resp.is_prefetch()) {
+                if (!pe.complete_request(resp.get_tag())) {
+                    std::cerr << "[PE " << pe_id << "] Warning: respuesta con tag "
+                              << resp.get_tag() << " sin petición en vuelo\n";
                 }
+                std::cout << "[PE " << pe_id << "] Request tag=" << resp.get_tag()
+                          << " completed, outstanding=" << pe.outstanding() << "\n";
+            }
 
-            } else {
-                std::cout << "[PE " << pe_id << "] Waiting for response (?)"
-                          << " - PC: " << pe.get_pc() << "\n";
+            /* Check PE states */
+            pe.set_response_state(pe.outstanding() ? PEResponseState::WAITING
+                                                    : PEResponseState::COMPLETED);
+            if (pe.get_state() == PEState::STALLED && pe.can_issue()) {
+                pe.set_state(PEState::IDLE);
             }
-            
+
+        } else if (pe.outstanding() > 0) {
+            std::cout << "[PE " << pe_id << "] Waiting for " << pe.outstanding()
+                      << " response(s) - PC: " << pe.get_pc() << "\n";
+        }
+
+        // Las líneas sucias que desalojaron un fill o un INV_LINE vuelven a memoria
+        send_writebacks(pe, cache);
+
+        // Las escrituras combinadas que vencieron su ventana salen; al terminar el programa, todas
+        if (!wc.empty()) {
+            send_posted_writes(pe, pe.get_pc() >= total_instr
+                                       ? wc.take_all(FlushReason::DRAIN)
+                                       : wc.take_expired(static_cast<uint64_t>(last_step)));
         }
 
         // —————— 2) FINISHED POR PC FUERA DE RANGO ——————
-        // Si el PC ya no apunta a ninguna instrucción válida, terminamos
-        if (pe.get_pc() >= total_instr && interconnect_->all_queues_empty()) {
+        /* Al agotar el programa y vaciar su ventana (y sus prefetches) el PE queda "drenado": ya no
+           emitirá nada más, pero debe seguir contestando INV_LINE hasta que TODOS
+           los PEs estén drenados, o el broadcast de otro PE nunca se completaría */
+        const Prefetcher* prefetcher = cache.get_prefetcher();
+        if (!drained && pe.get_pc() >= total_instr && pe.outstanding() == 0
+            && (!prefetcher || prefetcher->inflight() == 0) && wc.empty() && wc.inflight() == 0) {
+            drained = true;
+            drained_pes_.fetch_add(1);
             std::cout << "[PE " << pe_id 
                       << "] PC (" << pe.get_pc() 
                       << ") >= total_instr (" << total_instr 
-                      << "), cambiando a FINISHED.\n";
+                      << "), sin peticiones en vuelo.\n";
+        }
+
+        if (drained && drained_pes_.load() == total_pes_ && interconnect_->all_queues_empty()) {
+            std::cout << "[PE " << pe_id << "] Todos los PEs drenados, cambiando a FINISHED.\n";
             pe.set_state(PEState::FINISHED);
             break;
         }
@@ -360,7 +492,7 @@ void System::pe_execution_cycle(int pe_id) {
             pe.set_actual_message(actual_pe_message);
 
             /* Incremento de latencia: Fetch Instr*/
-            pe.get_actual_message().set_full_latency(3); // Ya que sera la primera vez que se agrega
+            pe.get_actual_message().set_full_latency(latency_.instruction_fetch()); // Ya que sera la primera vez que se agrega
 
             // Cambiamos el estado a RUNNING, porque ya tenemos la petición lista
             pe.set_state(PEState::RUNNING);
@@ -370,7 +502,9 @@ void System::pe_execution_cycle(int pe_id) {
                     << actual_pe_message.to_string() << "\n";*/
 
             // —————— 6) Si es WRITE_MEM, leer cache ——————
-            /* Si es WRITE_MEM se trae el dato de Cache */
+            /* Si es WRITE_MEM se trae el dato de Cache; en write-back, si el destino
+               está en el cache local la escritura queda ahí y no sale al Interconnect */
+            bool served_locally = false;
             if (pe.get_actual_message().get_operation() == Operation::WRITE_MEM) {
                 std::cout << "[PE " << pe.get_id() << "] WRITE_MEM detected – reading from cache:\n";
 
@@ -378,13 +512,13 @@ void System::pe_execution_cycle(int pe_id) {
                 /*cache.read_test(pe.get_actual_message().get_start_line(),
                                 pe.get_actual_message().get_num_lines());*/
 
-                // 2) Read the cache lines from disk
+                // 2) Read the cache lines
                 uint32_t start = pe.get_actual_message().get_start_line();
                 uint32_t count = pe.get_actual_message().get_num_lines();
 
                 std::vector<std::vector<uint8_t>> blocks;
                 try {
-                    blocks = cache.read_cache_from_file(pe.get_id(), start, count);
+                    blocks = cache.read_lines(start, count);
                 } catch (const std::exception& e) {
                     std::cerr << "[PE " << pe_id 
                             << "] Error reading cache lines: " << e.what() << "\n";
@@ -394,35 +528,84 @@ void System::pe_execution_cycle(int pe_id) {
                 pe.get_actual_message().set_data(blocks);
 
                 /* Incremento de latencia: Cache Read */
-                pe.get_actual_message().increment_full_latency(4 * count); 
+                pe.get_actual_message().increment_full_latency(latency_.cache_read(count));
 
                 // (Optional) debug print to verify
                 std::cout << "[PE " << pe_id 
                         << "] Cached data attached to message (" 
                         << blocks.size() << " lines)\n";
+
+                Message& msg = pe.get_actual_message();
+                if (cache.absorb_write(msg.get_address(), blocks)) {
+                    served_locally = true;
+                    std::cout << "[PE " << pe_id << "] WRITE_MEM absorbida por el cache local (0x"
+                              << std::hex << msg.get_address() << std::dec << ", queda en M)\n";
+                } else if (wc.enabled()) {
+                    // Posted: queda en el write-combining buffer y el PE sigue sin esperarla
+                    send_posted_writes(pe, wc.insert(msg, static_cast<uint64_t>(last_step)));
+                    served_locally = true;
+                    std::cout << "[PE " << pe_id << "] WRITE_MEM a 0x" << std::hex << msg.get_address()
+                              << std::dec << " en el write-combining buffer\n";
+                }
             }
 
-            // —————— 7) ISSUE: Enviamos el mensaje al Interconnect ——————
-            std::cout << "[PE " << pe.get_id() << "] Sending message to Interconnect...\n";
+            // —————— 6a) BROADCAST_INVALIDATE hace de fence para las escrituras combinadas ——————
+            if (pe.get_actual_message().get_operation() == Operation::BROADCAST_INVALIDATE) {
+                send_posted_writes(pe, wc.take_all(FlushReason::FENCE));
+            }
 
-            /* Incremento de latencia: Send Inter */
-            pe.get_actual_message().increment_full_latency(5);
+            // —————— 6b) Si es READ_MEM, buscar en el cache local ——————
+            /* En un hit la lectura se sirve localmente y no sale al Interconnect;
+               en un miss se piden solo las líneas ausentes, alineadas a línea */
+            if (pe.get_actual_message().get_operation() == Operation::READ_MEM) {
+                Message& msg = pe.get_actual_message();
 
-            interconnect_->push_message(pe.get_actual_message());
+                // Las escrituras combinadas que la lectura toca salen antes que ella
+                send_posted_writes(pe, wc.take_overlapping(msg.get_address(),
+                                                           Interconnect::read_span_words(msg.get_size())));
 
-            // 6) Cambiar el estado del PE a STALLED ya que se acaba de enviar la instruccion a ejecutar
-            pe.set_state(PEState::STALLED);
-            // 7) Cambiar el estado de respuesta del PE a WAITING ya que puede ahora esperar una respuesta
-            pe.set_response_state(PEResponseState::WAITING);
+                CacheLookup lookup = cache.lookup_read(msg.get_address(), msg.get_size());
 
-            // —————— 8) ADVANCE PC y volver a IDLE ——————
-            pe.pc_plus_4();
+                if (lookup.hit) {
+                    served_locally = true;
+                    msg.increment_full_latency(latency_.cache_read(lookup.lines));
+                    std::cout << "[PE " << pe_id << "] READ_MEM hit en cache local (0x"
+                              << std::hex << msg.get_address() << std::dec << ", "
+                              << lookup.lines << " líneas)\n";
+                } else {
+                    std::cout << "[PE " << pe_id << "] READ_MEM miss: pidiendo 0x"
+                              << std::hex << lookup.miss_address << std::dec
+                              << " (" << lookup.miss_size << " bytes) al Interconnect\n";
+                    msg.set_address(lookup.miss_address);
+                    msg.set_size(lookup.miss_size);
+                }
+
+                issue_prefetches(pe_id, cache, lookup);
+            }
 
-            // TODO: Revisar esto porque puede quedar en Stalled si no se resuleve la respuesta
-            //pe.set_state(PEState::IDLE);
+            if (served_locally) {
+                // No ocupa la ventana: el PE puede seguir con la próxima instrucción
+                pe.set_state(PEState::IDLE);
+            } else {
+                // —————— 7) ISSUE: Enviamos el mensaje al Interconnect ——————
+                // La petición ocupa una entrada de la ventana hasta que llegue su respuesta
+                uint32_t tag = pe.track_request(pe.get_actual_message());
+                std::cout << "[PE " << pe.get_id() << "] Sending message to Interconnect (tag="
+                          << tag << ", outstanding=" << pe.outstanding() << ")...\n";
+
+                /* Incremento de latencia: Send Inter */
+                pe.get_actual_message().increment_full_latency(latency_.send_to_interconnect());
 
-            // TODO: Revisar si dejar aqui el cambio de nuevo al estado de WAINTING para una respuesta
-            //pe.set_response_state(PEResponseState::WAITING);
+                interconnect_->push_message(pe.get_actual_message());
+
+                // 6) Si la ventana se llenó el PE queda STALLED; si no, puede seguir emitiendo
+                pe.set_state(pe.can_issue() ? PEState::IDLE : PEState::STALLED);
+                // 7) Cambiar el estado de respuesta del PE a WAITING ya que puede ahora esperar una respuesta
+                pe.set_response_state(PEResponseState::WAITING);
+            }
+
+            // —————— 8) ADVANCE PC ——————
+            pe.pc_plus_4();
 
             // Debug: mostramos nuevo PC
             std::cout << "[PE " << pe_id 
@@ -430,19 +613,13 @@ void System::pe_execution_cycle(int pe_id) {
                     << ", estado " << pe.state_to_string() << ".\n";
 
         }
-        /* Cuando el PE este IDLE puede obtener una nueva instruccion */
+        /* Con la ventana llena el PE espera a que se libere alguna entrada */
         else if (pe.get_state() == PEState::STALLED) {
 
+            pe.record_window_full();
+            std::cout << "[PE " << pe_id << "] state = STALLED. Window full ("
+                      << pe.outstanding() << "/" << pe.get_max_outstanding() << ").\n";
 
-            // El estado de respuesta del PE seria WAITING ya que esta esperando una respuesta
-            pe.set_response_state(PEResponseState::WAITING);
-            std::cout << "[PE " << pe_id << "] state = STALLED. Awaiting response.\n";
-
-        } else {
-            pe.set_response_state(PEResponseState::WAITING);
-            // Debug: mostramos nuevo PC
-            std::cout << "[PE " << pe_id 
-                    << "]  estado " << pe.state_to_string() << " (?).\n";
         }
 
     }
@@ -491,11 +668,12 @@ void System::interconnect_execution_cycle() {
         }
         // Actualizamos el tracker local
         last_step = current_step_;
+        interconnect_->advance_cycle();
 
         // ———————— 2) CHEQUEO DE FIN ————————
         /* Condicion de parada */
         // Si todos los PEs terminaron y NO hay mensajes en ninguna cola:        
-        if (all_pes_finished() && interconnect_->all_queues_empty()) {
+        if (all_pes_finished() && pipeline_empty()) {
             std::cout << "[Interconnect] All work done, switching to FINISHED.\n";
             interconnect_->set_state(ICState::FINISHED);
             break;
@@ -503,7 +681,7 @@ void System::interconnect_execution_cycle() {
 
         // ———————— 3) IDLE vs PROCESSING ————————
         /* Si no hay mensajes en los queues pero los PEs no han terminado, stay IDLE*/
-        if (interconnect_->all_queues_empty()) {
+        if (pipeline_empty()) {
             // No hay peticiones: permanecemos IDLE
             interconnect_->set_state(ICState::IDLE);
             continue;  // esperamos el próximo step
@@ -554,88 +732,211 @@ void System::interconnect_execution_cycle() {
         }
 
         
-        if (!interconnect_->in_queue_empty()) {
+        // Controlador de memoria: despacha a lo sumo un acceso por ciclo
+        MemoryRequest issued;
+        if (memory_controller_ && memory_controller_->dispatch(interconnect_->get_cycle(), issued)) {
+            for (const Message& resp : issued.responses) {
+                interconnect_->push_mid_processing(resp);
+            }
+        }
+
+        bool ack_first = false;
+        if (!interconnect_->in_queue_empty() && in_queue_head_accepted(ack_first)) {
             /* Si hay Messages en in_queue, cada ciclo se pasa la primera instruccion a mid_processing */
             /* Extrae el siguiente Message de in_queue para finalizar su espera por procesamiento */
-            Message next_msg = interconnect_->pop_next();
+            Message next_msg = ack_first ? interconnect_->pop_next_ack() : interconnect_->pop_next();
 
-            /* Incremento de latencia: Wait Queue*/
-            if (scheme_ == ArbitScheme::PRIORITY) {
-                uint32_t latency_increment = 5/*0*/ * (next_msg.get_num_lines() + next_msg.get_size()) * (1/next_msg.get_qos());
-                next_msg.increment_full_latency(latency_increment);
-                next_msg.set_latency(latency_increment);
-            } else {
-                uint32_t latency_increment = 5/*0*/ * (next_msg.get_num_lines() + next_msg.get_size());
-                next_msg.increment_full_latency(latency_increment);
-                next_msg.set_latency(latency_increment);
-            }
+            /* Incremento de latencia: Wait Queue (con PRIORITY depende del QoS) */
+            uint32_t latency_increment = latency_.queue_wait(next_msg, scheme_);
+            next_msg.increment_full_latency(latency_increment);
+            next_msg.set_latency(latency_increment);
             
 
             // 3) DECISION: ¿qué tipo de operación es?
-            if (next_msg.get_operation() == Operation::READ_MEM) {
+            if (next_msg.get_operation() == Operation::READ_MEM && serve_cache_to_cache(next_msg)) {
+                // → Otro PE tiene todas las líneas: su caché ya respondió, no se va a memoria
+                std::cout << "[IC] READ_MEM servido cache-to-cache para PE "
+                          << next_msg.get_src_id() << "\n";
+
+            } else if (next_msg.get_operation() == Operation::READ_MEM) {
                 // → Petición de lectura: iremos a memoria principal
                 std::cout << "[IC] READ_MEM: preparando acceso a SharedMemory\n";
 
                 // 1) Sacamos la dirección y el tamaño
                 uint64_t address = next_msg.get_address();
                 uint32_t size = next_msg.get_size();
-                uint32_t   status    = 0x1;                  // OK por defecto
+                uint32_t   status    = STATUS_OK;            // OK por defecto
+
+                // 2) Coalescing: agrupamos los READ_MEM pendientes cuyo rango se solape
+                uint64_t first_word = address;
+                uint64_t end_word   = address + Interconnect::read_span_words(size);
+                std::vector<Message> group{next_msg};
+                std::vector<Message> overlapping = interconnect_->take_overlapping_reads(first_word, end_word);
+                for (Message& req : overlapping) {
+                    // También esperaron en in_queue: cada una paga su propia espera
+                    uint32_t wait = latency_.queue_wait(req, scheme_);
+                    req.increment_full_latency(wait);
+                    req.set_latency(wait);
+                }
+                group.insert(group.end(), overlapping.begin(), overlapping.end());
+
+                if (group.size() > 1) {
+                    std::cout << "[IC] READ_MEM coalescing: " << group.size()
+                              << " lecturas servidas con un acceso a palabras ["
+                              << first_word << ", " << end_word << ")\n";
+                }
+
+                // 3) Snoop MESI de cada lectura: las copias E/M de otros PEs bajan a S y
+                //    los datos sucios se escriben en memoria antes de leerla
+                std::vector<uint32_t> coherence_lat(group.size());
+                std::vector<bool>     shared_copy(group.size());
+                for (size_t i = 0; i < group.size(); ++i) {
+                    bool shared = false;
+                    coherence_lat[i] = snoop_read_coherence(group[i], shared);
+                    shared_copy[i]   = shared;
+                    if (directory_) {
+                        directory_->record_read(first_line_of(group[i]), last_line_of(group[i]),
+                                                group[i].get_src_id(), /*exclusive=*/!shared);
+                    }
+                }
 
-                // 3) Leemos del SharedMemory
+                // Leemos del SharedMemory una sola vez para todo el grupo
+                uint32_t span_bytes = static_cast<uint32_t>((end_word - first_word) * 4);
                 std::vector<std::vector<std::uint8_t>> memory_data;
+                SharedCacheAccess l2_access;
                 try {
-                    memory_data = shared_memory_->read_shared_memory(address, size);
+                    memory_data = shared_cache_
+                        ? shared_cache_->read(first_word, span_bytes, l2_access)
+                        : shared_memory_->read_shared_memory(first_word, span_bytes);
                 } catch (const std::exception& e) {
+                    // Cada lectura del grupo recibe igual su respuesta, marcada NOT_OK
                     std::cerr << "[IC] Error en READ_MEM: " << e.what() << "\n";
                     status = 0x0;
-                    continue;
+                }
+                if (status == STATUS_OK) {
+                    interconnect_->record_memory_read(group.size());
                 }
 
-                // 5) Creamos la respuesta WRITE_RESP con el estado de la operación
-                Message read_resp(
-                    Operation::READ_RESP,
-                    /*src=*/-1,                     // Interconnect
-                    /*dst=*/next_msg.get_src_id(),  // PE origen
-                    /*addr=*/address,
-                    /*qos=*/next_msg.get_qos(),
-                    /*size=*/size,
-                    /*num_lines=*/0,
-                    /*start_line=*/0,
-                    /*cache_line=*/0,
-                    /*status=*/status,
-                    /*data=*/memory_data
-                );
+                // Bytes contiguos del rango agrupado, para repartirlos por lectura
+                std::vector<std::uint8_t> span;
+                span.reserve(span_bytes);
+                for (const auto& block : memory_data) {
+                    span.insert(span.end(), block.begin(), block.end());
+                }
 
-                // Pasar latencia del Message de Instruccion al de Respuesta
-                read_resp.set_full_latency(next_msg.get_full_latency()* 0.01);
-                read_resp.set_latency(next_msg.get_latency()* 0.01);
+                // 4) Acceso compartido: los bancos sirven en paralelo las palabras pedidas
+                //    (no el redondeo a bloques de la respuesta) cuando se despacha
+                uint64_t request_first = end_word;
+                uint64_t request_end   = first_word;
+                std::vector<std::pair<uint64_t, uint64_t>> parts;   // (primera palabra, palabras) de cada lectura
+                for (const Message& req : group) {
+                    uint64_t words = (req.get_size() + 3) / 4;
+                    parts.emplace_back(req.get_address(), words);
+                    request_first = std::min(request_first, req.get_address());
+                    request_end   = std::max(request_end, req.get_address() + words);
+                }
+                MemoryRequest access;
+                access.first_word = request_first;
+                access.words      = request_end - request_first;
+                access.qos        = next_msg.get_qos();
+                access.issue      = [this, request_first, words = access.words, l2_access, parts]() {
+                    if (shared_cache_) {
+                        uint32_t service = schedule_shared_cache_access(request_first, words, l2_access);
+                        return std::vector<uint32_t>(parts.size(), service);
+                    }
+                    // Los bancos se reservan una vez; cada lectura espera solo a sus palabras
+                    auto read_cycles = [this](uint64_t w) { return bank_read_cycles(w); };
+                    uint64_t now = interconnect_->get_cycle();
+                    std::vector<BankWindow> windows;
+                    shared_memory_->schedule_access(request_first, words, now, read_cycles,
+                                                    /*write=*/false, &windows);
+                    std::vector<uint32_t> service;
+                    for (const auto& [part_first, part_words] : parts) {
+                        service.push_back(static_cast<uint32_t>(shared_memory_->part_cycles(
+                            windows, part_first, part_words, now, read_cycles)));
+                    }
+                    return service;
+                };
+
+                for (size_t i = 0; i < group.size(); ++i) {
+                    const Message& req = group[i];
+                    bool shared = shared_copy[i] && status == STATUS_OK;
+
+                    // a) Recortamos los bloques de esta lectura dentro del rango
+                    std::vector<std::vector<std::uint8_t>> req_data;
+                    if (status == STATUS_OK) {
+                        size_t offset = (req.get_address() - first_word) * 4;
+                        size_t bytes  = Interconnect::read_span_words(req.get_size()) * 4;
+                        for (size_t b = offset; b < offset + bytes; b += 16) {
+                            req_data.emplace_back(span.begin() + b, span.begin() + b + 16);
+                        }
+                    }
 
-                // 6) Calculamos y asignamos la latencia
-                uint32_t incr_lat = (6/*0*/ + size) * size;
-                read_resp.increment_full_latency(incr_lat);
-                read_resp.increment_latency(incr_lat);
+                    // 5) Creamos la respuesta READ_RESP con los datos leídos
+                    Message read_resp(
+                        Operation::READ_RESP,
+                        /*src=*/-1,                     // Interconnect
+                        /*dst=*/req.get_src_id(),       // PE origen
+                        /*addr=*/req.get_address(),
+                        /*qos=*/req.get_qos(),
+                        /*size=*/req.get_size(),
+                        /*num_lines=*/0,
+                        /*start_line=*/0,
+                        /*cache_line=*/0,
+                        /*status=*/shared ? (status | STATUS_SHARED) : status,
+                        /*data=*/req_data
+                    );
 
-                // 7) Encolamos en la etapa media para simular la latencia
-                interconnect_->push_mid_processing(read_resp);
+                    // La respuesta lleva el tag de su petición y la marca de prefetch
+                    read_resp.set_tag(req.get_tag());
+                    read_resp.set_prefetch(req.is_prefetch());
+
+                    // Pasar latencia del Message de Instruccion al de Respuesta
+                    read_resp.set_full_latency(latency_.response_share(req.get_full_latency()));
+                    read_resp.set_latency(latency_.response_share(req.get_latency()));
+
+                    // 6) Latencia de coherencia; la de memoria se suma al despachar el acceso
+                    read_resp.increment_full_latency(coherence_lat[i]);
+                    read_resp.increment_latency(coherence_lat[i]);
+                    access.responses.push_back(read_resp);
+                }
+
+                // 7) Al controlador de memoria, o directo a la etapa media; si la lectura
+                //    falló no se ocupan bancos y los NOT_OK salen de inmediato
+                if (status == STATUS_OK) {
+                    submit_memory_access(std::move(access));
+                } else {
+                    for (const Message& resp : access.responses) {
+                        interconnect_->push_mid_processing(resp);
+                    }
+                }
 
             } else if (next_msg.get_operation() == Operation::WRITE_MEM) {
                 // → Petición de escritura: datos vienen en next_msg.get_data()
                 std::cout << "[IC] WRITE_MEM: preparando escritura en SharedMemory\n";
 
                 // 1) Extraemos dirección y bloque de datos
-                uint32_t   num_lines = next_msg.get_num_lines(); 
                 uint64_t   address   = next_msg.get_address();
                 auto       blocks    = next_msg.get_data();  // vector<vector<uint8_t>>
-                uint32_t   status    = 0x1;                  // OK por defecto
+                uint32_t   status    = STATUS_OK;            // OK por defecto
+
+                // 2) Snoop MESI: se invalidan las copias ajenas y el escritor queda exclusivo;
+                //    los datos sucios del rango llegan a memoria antes que esta escritura
+                uint32_t coherence_lat = snoop_write_coherence(next_msg);
 
+                SharedCacheAccess l2_access;
                 try {
-                    // 3) Volcamos al fichero de texto de SharedMemory
-                    shared_memory_->write_shared_memory_lines(blocks, address);
+                    // 3) Escribimos en el L2 (write-back) o directo en SharedMemory
+                    if (shared_cache_) {
+                        shared_cache_->write(blocks, address, l2_access);
+                    } else {
+                        shared_memory_->write_shared_memory_lines(blocks, address);
+                    }
                 } catch (const std::exception& e) {
-                    // 4) Si falla, lo reportamos y marcamos NOT_OK
+                    // 4) Si falla, lo reportamos y marcamos NOT_OK; la respuesta sale igual
+                    //    para que la petición deje la ventana del PE
                     std::cerr << "[IC] Error en WRITE_MEM: " << e.what() << "\n";
                     status = 0x0;
-                    continue;
                 }
 
                 // 5) Creamos la respuesta WRITE_RESP con el estado de la operación
@@ -653,17 +954,82 @@ void System::interconnect_execution_cycle() {
                     /*data=*/{}                     // sin payload
                 );
 
+                // La respuesta lleva el tag de su petición (o la marca de posted)
+                write_resp.set_tag(next_msg.get_tag());
+                write_resp.set_posted(next_msg.is_posted());
+
                 // Pasar latencia del Message de Instruccion al de Respuesta
-                write_resp.set_full_latency(next_msg.get_full_latency() * 0.01);
-                write_resp.set_latency(next_msg.get_latency() * 0.01);
+                write_resp.set_full_latency(latency_.response_share(next_msg.get_full_latency()));
+                write_resp.set_latency(latency_.response_share(next_msg.get_latency()));
+
+                // 6) Latencia de coherencia; la de memoria se suma al despachar el acceso
+                write_resp.increment_full_latency(coherence_lat);
+                write_resp.increment_latency(coherence_lat);
+
+                // 7) La escritura ocupa sus bancos al despacharse
+                MemoryRequest access;
+                access.first_word = address;
+                access.words      = static_cast<uint64_t>(blocks.size()) * SharedMemory::LINE_WORDS;
+                access.write      = true;
+                access.qos        = next_msg.get_qos();
+                access.issue      = [this, address, words = access.words, l2_access]() {
+                    uint32_t service = shared_cache_
+                        ? schedule_shared_cache_access(address, words, l2_access)
+                        : static_cast<uint32_t>(shared_memory_->schedule_access(
+                              address, words, interconnect_->get_cycle(),
+                              [this](uint64_t w) { return bank_write_cycles(w); },
+                              /*write=*/true));
+                    return std::vector<uint32_t>{service};
+                };
+                access.responses.push_back(write_resp);
+                if (status == STATUS_OK) {
+                    submit_memory_access(std::move(access));
+                } else {
+                    interconnect_->push_mid_processing(write_resp);     // no llegó a ocupar bancos
+                }
 
-                // 6) Calculamos y asignamos la latencia
-                uint32_t incr_lat = (8/*0*/ + num_lines) * num_lines;
-                write_resp.increment_full_latency(incr_lat);
-                write_resp.increment_latency(incr_lat);
+            } else if (next_msg.get_operation() == Operation::WRITEBACK) {
+                // → Línea sucia desalojada por un caché write-back: no lleva respuesta
+                uint64_t address = next_msg.get_address();
+                std::vector<std::vector<uint8_t>> blocks;
 
-                // 7) Encolamos en la etapa media para simular la latencia
-                interconnect_->push_mid_processing(write_resp);
+                // Si un snoop ya la escribió en memoria, el buffer ya no la tiene
+                if (!caches_[next_msg.get_src_id()].take_writeback(address, blocks)) {
+                    std::cout << "[IC] WRITEBACK de PE " << next_msg.get_src_id()
+                              << " ya escrito por un snoop\n";
+                    continue;
+                }
+                std::cout << "[IC] WRITEBACK: PE " << next_msg.get_src_id() << " devuelve 0x"
+                          << std::hex << address << std::dec << " a memoria\n";
+
+                SharedCacheAccess l2_access;
+                try {
+                    if (shared_cache_) {
+                        shared_cache_->write(blocks, address, l2_access);
+                    } else {
+                        shared_memory_->write_shared_memory_lines(blocks, address);
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "[IC] Error en WRITEBACK: " << e.what() << "\n";
+                    continue;
+                }
+
+                MemoryRequest access;
+                access.first_word = address;
+                access.words      = static_cast<uint64_t>(blocks.size()) * SharedMemory::LINE_WORDS;
+                access.write      = true;
+                access.qos        = next_msg.get_qos();
+                access.issue      = [this, address, words = access.words, l2_access]() {
+                    if (shared_cache_) {
+                        schedule_shared_cache_access(address, words, l2_access);
+                    } else {
+                        shared_memory_->schedule_access(
+                            address, words, interconnect_->get_cycle(),
+                            [this](uint64_t w) { return bank_write_cycles(w); }, /*write=*/true);
+                    }
+                    return std::vector<uint32_t>{};     // sin respuesta: solo ocupa los bancos
+                };
+                submit_memory_access(std::move(access));
 
             } else if (next_msg.get_operation() == Operation::BROADCAST_INVALIDATE) {
                 // → Broadcast: invalidar cache line en todos los PEs
@@ -674,8 +1040,15 @@ void System::interconnect_execution_cycle() {
                 std::cout << "[IC] BROADCAST_INVALIDATE: enviando INV_LINE a todos los PEs (incluyendo src=" 
                         << src_pe << ")\n";
 
-                /* Se obtiene un nuevo ID para este nuevo BROADCAST */
-                uint32_t bid = interconnect_->register_broadcast(src_pe);
+                /* Se obtiene un nuevo ID para este nuevo BROADCAST; in_queue_head_accepted()
+                   ya comprobó que hay slot y solo este hilo los ocupa */
+                uint32_t bid = 0;
+                if (!interconnect_->try_register_broadcast(src_pe, next_msg.get_tag(), bid)) {
+                    std::cerr << "[IC] BROADCAST_INVALIDATE from PE " << src_pe
+                              << ": broadcast table full, requeued\n";
+                    interconnect_->push_message(next_msg);
+                    continue;
+                }
 
                 // Para cada PE creamos un INV_LINE
                 for (int pid = 0; pid < total_pes_; ++pid) {
@@ -702,7 +1075,7 @@ void System::interconnect_execution_cycle() {
                     inv_line_msg.set_broadcast_id(bid);
 
                     // 6) Calculamos y asignamos la latencia
-                    uint32_t incr_lat = 6;
+                    uint32_t incr_lat = latency_.inv_line();
                     inv_line_msg.increment_full_latency(incr_lat);
                     inv_line_msg.increment_latency(incr_lat);
 
@@ -717,30 +1090,20 @@ void System::interconnect_execution_cycle() {
                 uint32_t bid    = next_msg.get_broadcast_id(); // identificador del broadcast
                 uint32_t qos    = next_msg.get_qos();
                 int      origin = -1;
+                uint32_t origin_tag = 0;
                 bool     complete = false;
 
-                {
-                    // 1) Protegemos el acceso al mapa de broadcasts pendientes
-                    std::lock_guard<std::mutex> lk(interconnect_->broadcast_mtx_);
-                    auto it = interconnect_->pending_broadcasts_.find(bid);
-
-                    /* Si no esta fuera de rango */
-                    if (it != interconnect_->pending_broadcasts_.end()) {
-                        // 2) Restamos un ACK pendiente
-                        /* it->second da acceso al valor de PendingBroadcast, first seria su key*/
-                        it->second.pending_acks--;   // restar un ACK pendiente
-                        origin = it->second.origin_pe;  // leer quién inició el broadcast
-                        std::cout << "[IC] INV_ACK recibido para broadcast " << bid
-                                << ", faltan " << it->second.pending_acks << " ACKs\n";
-
-                        // 3) Si ya no falta ninguno, marcamos completo y borramos el registro
-                        if (it->second.pending_acks == 0) {
-                            complete = true;
-                            interconnect_->pending_broadcasts_.erase(it);
-                        }
-                    } else {
-                        std::cerr << "[IC] INV_ACK con broadcast_id inválido: " << bid << "\n";
-                    }
+                // 1) Restamos el ACK en la tabla de broadcasts (sin locks)
+                int remaining = -1;
+                AckResult ack = interconnect_->acknowledge_broadcast(bid, origin, origin_tag, remaining);
+
+                if (ack == AckResult::INVALID) {
+                    std::cerr << "[IC] INV_ACK con broadcast_id inválido: " << bid << "\n";
+                } else {
+                    std::cout << "[IC] INV_ACK recibido para broadcast " << bid
+                            << ", faltan " << remaining << " ACKs\n";
+                    // 2) Si ya no falta ninguno, el broadcast está completo
+                    complete = (ack == AckResult::COMPLETE);
                 }
 
                 // TODO: Como medir esta latencia?
@@ -766,13 +1129,14 @@ void System::interconnect_execution_cycle() {
                     );
 
                     // Pasar latencia del Message de Instruccion al de Respuesta
-                    inv_complete.set_full_latency(5 * total_pes_);
-                    inv_complete.set_latency(5 * total_pes_);
+                    inv_complete.set_full_latency(latency_.inv_complete_collect(total_pes_));
+                    inv_complete.set_latency(latency_.inv_complete_collect(total_pes_));
 
                     inv_complete.set_broadcast_id(bid);
+                    inv_complete.set_tag(origin_tag);
 
                     // 6) Calculamos y asignamos la latencia
-                    uint32_t incr_lat = 5;
+                    uint32_t incr_lat = latency_.inv_complete();
                     inv_complete.increment_full_latency(incr_lat);
                     inv_complete.increment_latency(incr_lat);
 
@@ -820,6 +1184,305 @@ void System::join_interconnect_thread() {
     std::cout << "[System] Interconnect thread has joined.\n";
 }
 
+uint32_t System::snoop_read_coherence(const Message& req, bool& shared) {
+    CoherenceStats tx;
+    shared = false;
+    std::vector<Writeback> dirty;
+
+    for (int pid = 0; pid < total_pes_; ++pid) {
+        if (pid == req.get_src_id()) {
+            // El lector no se consulta, pero sus writebacks pendientes van primero
+            std::vector<Writeback> own = caches_[pid].take_buffered(req.get_address(), req.get_size());
+            dirty.insert(dirty.end(), std::make_move_iterator(own.begin()), std::make_move_iterator(own.end()));
+            continue;
+        }
+        SnoopResult snoop = caches_[pid].snoop_read(req.get_address(), req.get_size());
+        ++tx.snoops;
+        tx.downgrades += snoop.downgraded;
+        shared = shared || snoop.present > 0;
+        dirty.insert(dirty.end(), std::make_move_iterator(snoop.dirty.begin()),
+                     std::make_move_iterator(snoop.dirty.end()));
+    }
+
+    interconnect_->record_coherence(tx);
+    return latency_.coherence(tx) + write_back_lines(dirty);
+}
+
+uint32_t System::snoop_write_coherence(const Message& req) {
+    CoherenceStats tx;
+    uint32_t bytes = static_cast<uint32_t>(req.get_data().size() * LocalCache::BLOCK_SIZE);
+    bool writer_present = false;
+    std::vector<Writeback> dirty;
+
+    for (int pid = 0; pid < total_pes_; ++pid) {
+        SnoopResult snoop;
+        if (pid == req.get_src_id()) {
+            // El escritor actualiza su copia y la hace exclusiva
+            snoop = caches_[pid].apply_write(req.get_address(), req.get_data());
+            tx.upgrades   += snoop.upgraded;
+            writer_present = snoop.present > 0;
+        } else {
+            snoop = caches_[pid].snoop_write(req.get_address(), bytes);
+            ++tx.snoops;
+            tx.invalidations += snoop.invalidated;
+        }
+        dirty.insert(dirty.end(), std::make_move_iterator(snoop.dirty.begin()),
+                     std::make_move_iterator(snoop.dirty.end()));
+    }
+
+    // Los datos sucios llegan a memoria antes que la escritura que los reemplaza
+    uint32_t writeback_lat = write_back_lines(dirty);
+
+    // Las demás copias quedaron invalidadas: el escritor es el único que puede responder
+    if (directory_) {
+        uint64_t first_line = caches_.front().line_of(req.get_address());
+        uint64_t last_line  = caches_.front().line_of(req.get_address() + bytes / 4 - 1);
+        directory_->record_write(first_line, last_line, req.get_src_id(), writer_present);
+    }
+
+    interconnect_->record_coherence(tx);
+    return latency_.coherence(tx) + writeback_lat;
+}
+
+bool System::serve_cache_to_cache(const Message& req) {
+    if (!directory_) {
+        return false;
+    }
+
+    // 1) Candidatos del directorio; se comprueba el caché porque los desalojos son silenciosos
+    uint64_t first_line = first_line_of(req);
+    uint64_t last_line  = last_line_of(req);
+    std::vector<std::vector<uint8_t>> data;
+    int    supplier = -1;
+    size_t stale    = 0;
+    for (int pid : directory_->holders(first_line, last_line, req.get_src_id())) {
+        if (caches_[pid].supply_lines(req.get_address(), req.get_size(), data)) {
+            supplier = pid;
+            break;
+        }
+        directory_->remove(first_line, last_line, pid);
+        ++stale;
+    }
+    if (stale) {
+        interconnect_->record_directory_stale(stale);
+    }
+    if (supplier < 0) {
+        return false;
+    }
+
+    // 2) Snoop MESI como en una lectura normal: el que responde queda en S
+    bool shared = false;
+    uint32_t coherence_lat = snoop_read_coherence(req, shared);
+    directory_->record_read(first_line, last_line, req.get_src_id(), /*exclusive=*/false);
+    interconnect_->record_cache_to_cache();
+
+    // 3) Respuesta con los datos del caché del otro PE
+    Message read_resp(
+        Operation::READ_RESP,
+        /*src=*/-1,                     // Interconnect
+        /*dst=*/req.get_src_id(),       // PE origen
+        /*addr=*/req.get_address(),
+        /*qos=*/req.get_qos(),
+        /*size=*/req.get_size(),
+        /*num_lines=*/0,
+        /*start_line=*/0,
+        /*cache_line=*/0,
+        /*status=*/STATUS_OK | STATUS_SHARED | STATUS_C2C,
+        /*data=*/data
+    );
+    read_resp.set_tag(req.get_tag());
+    read_resp.set_prefetch(req.is_prefetch());
+
+    read_resp.set_full_latency(latency_.response_share(req.get_full_latency()));
+    read_resp.set_latency(latency_.response_share(req.get_latency()));
+
+    uint32_t incr_lat = latency_.cache_to_cache(static_cast<uint32_t>(last_line - first_line + 1))
+                      + coherence_lat;
+    read_resp.increment_full_latency(incr_lat);
+    read_resp.increment_latency(incr_lat);
+
+    interconnect_->push_mid_processing(read_resp);
+
+    std::cout << "[IC] Cache-to-cache: PE " << supplier << " responde "
+              << (last_line - first_line + 1) << " línea(s) a PE " << req.get_src_id() << "\n";
+    return true;
+}
+
+uint64_t System::first_line_of(const Message& req) const {
+    return caches_.front().line_of(req.get_address());
+}
+
+uint64_t System::last_line_of(const Message& req) const {
+    return caches_.front().line_of(req.get_address() + Interconnect::read_span_words(req.get_size()) - 1);
+}
+
+void System::issue_prefetches(int pe_id, LocalCache& cache, const CacheLookup& lookup) {
+    Prefetcher* prefetcher = cache.get_prefetcher();
+    if (!prefetcher) {
+        return;
+    }
+
+    std::vector<uint64_t> candidates = prefetcher->on_demand_access(
+        lookup.first_line, lookup.last_line,
+        lookup.miss_first_line, lookup.miss_last_line, !lookup.hit);
+
+    const PrefetchConfig& config = prefetcher->get_config();
+    uint32_t line_size = cache.get_config().line_size;
+
+    for (uint64_t line : candidates) {
+        uint64_t address = cache.line_address(line);
+        // Fuera de la memoria compartida la lectura fallaría y el prefetch nunca volvería
+        if (address + line_size / 4 > shared_memory_->size()) continue;
+        if (!prefetcher->can_issue(line) || cache.contains_line(line)) continue;
+
+        Message prefetch(
+            Operation::READ_MEM,
+            /*src=*/pe_id,
+            /*dst=*/-1,
+            /*addr=*/address,
+            /*qos=*/config.qos,
+            /*size=*/line_size,
+            /*num_lines=*/0,
+            /*start_line=*/0,
+            /*cache_line=*/0,
+            /*status=*/0,
+            /*data=*/{}
+        );
+        prefetch.set_prefetch(true);
+        prefetch.set_full_latency(latency_.instruction_fetch());
+        prefetch.increment_full_latency(latency_.send_to_interconnect());
+
+        prefetcher->on_issue(line, line_size);
+        interconnect_->push_message(prefetch);
+
+        std::cout << "[PE " << pe_id << "] Prefetch de la línea " << line
+                  << " (0x" << std::hex << address << std::dec << ", "
+                  << prefetcher->inflight() << " en vuelo)\n";
+    }
+}
+
+uint64_t System::bank_read_cycles(uint64_t words) const {
+    return latency_.memory_read(static_cast<uint32_t>(words * 4));
+}
+
+uint64_t System::bank_write_cycles(uint64_t words) const {
+    uint64_t lines = (words + SharedMemory::LINE_WORDS - 1) / SharedMemory::LINE_WORDS;
+    return latency_.memory_write(static_cast<uint32_t>(lines));
+}
+
+uint32_t System::schedule_shared_cache_access(uint64_t first_word, uint64_t words,
+                                              const SharedCacheAccess& access) {
+    uint64_t now = interconnect_->get_cycle();
+    uint64_t l2  = shared_cache_->schedule_access(first_word, words, now);
+
+    // Los misses esperan a su línea de memoria; los writebacks solo ocupan el banco
+    uint64_t memory = 0;
+    for (uint64_t line : access.fill_lines) {
+        memory = std::max(memory, shared_memory_->schedule_access(
+            line * SharedMemory::LINE_WORDS, SharedMemory::LINE_WORDS, now + l2,
+            [this](uint64_t w) { return bank_read_cycles(w); }));
+    }
+    for (uint64_t line : access.writeback_lines) {
+        shared_memory_->schedule_access(
+            line * SharedMemory::LINE_WORDS, SharedMemory::LINE_WORDS, now + l2,
+            [this](uint64_t w) { return bank_write_cycles(w); }, /*write=*/true);
+    }
+    return static_cast<uint32_t>(l2 + memory);
+}
+
+uint32_t System::write_back_lines(const std::vector<Writeback>& lines) {
+    uint64_t now     = interconnect_->get_cycle();
+    uint32_t latency = 0;
+    for (const Writeback& wb : lines) {
+        uint64_t words = static_cast<uint64_t>(wb.blocks.size()) * SharedMemory::LINE_WORDS;
+        if (shared_cache_) {
+            SharedCacheAccess access;
+            shared_cache_->write(wb.blocks, wb.address, access);
+            latency = std::max(latency, schedule_shared_cache_access(wb.address, words, access));
+        } else {
+            shared_memory_->write_shared_memory_lines(wb.blocks, wb.address);
+            latency = std::max(latency, static_cast<uint32_t>(shared_memory_->schedule_access(
+                wb.address, words, now,
+                [this](uint64_t w) { return bank_write_cycles(w); }, /*write=*/true)));
+        }
+    }
+    return latency;
+}
+
+void System::send_writebacks(PE& pe, LocalCache& cache) {
+    for (uint64_t address : cache.take_evicted()) {
+        uint32_t blocks = cache.get_config().line_size / static_cast<uint32_t>(LocalCache::BLOCK_SIZE);
+        Message writeback(
+            Operation::WRITEBACK,
+            /*src=*/pe.get_id(),
+            /*dst=*/-1,                     // Interconnect
+            /*addr=*/address,
+            /*qos=*/pe.get_qos(),
+            /*size=*/0,
+            /*num_lines=*/blocks,
+            /*start_line=*/0,
+            /*cache_line=*/0,
+            /*status=*/0,
+            /*data=*/{}                     // los datos esperan en el buffer del caché
+        );
+        writeback.set_full_latency(latency_.send_to_interconnect());
+        interconnect_->push_message(writeback);
+        std::cout << "[PE " << pe.get_id() << "] WRITEBACK de la línea 0x" << std::hex
+                  << address << std::dec << " enviado al Interconnect\n";
+    }
+}
+
+void System::send_posted_writes(PE& pe, const std::vector<Message>& writes) {
+    for (Message write : writes) {
+        write.set_posted(true);
+        write.increment_full_latency(latency_.send_to_interconnect());
+        interconnect_->push_message(write);
+        std::cout << "[PE " << pe.get_id() << "] WRITE_MEM combinada enviada al Interconnect (0x"
+                  << std::hex << write.get_address() << std::dec << ", "
+                  << write.get_data().size() << " bloques)\n";
+    }
+}
+
+void System::submit_memory_access(MemoryRequest request) {
+    if (memory_controller_) {
+        request.arrival = interconnect_->get_cycle();
+        memory_controller_->enqueue(std::move(request));
+        return;
+    }
+
+    std::vector<uint32_t> service = request.issue();
+    for (size_t i = 0; i < request.responses.size(); ++i) {
+        Message& resp = request.responses[i];
+        resp.increment_full_latency(service[i]);
+        resp.increment_latency(service[i]);
+        interconnect_->push_mid_processing(resp);
+    }
+}
+
+bool System::in_queue_head_accepted(bool& ack_first) {
+    Operation op = interconnect_->next_operation();
+    ack_first = false;
+
+    // Sin slot libre en la tabla, el broadcast espera a que otro reciba todos sus ACKs;
+    // mientras tanto los INV_ACK que están detrás pasan primero
+    if (op == Operation::BROADCAST_INVALIDATE && !interconnect_->has_free_broadcast_slot()) {
+        ack_first = interconnect_->has_pending_ack();
+        return ack_first;
+    }
+    if (!memory_controller_) return true;
+
+    bool write = op == Operation::WRITE_MEM || op == Operation::WRITEBACK;
+    if (op != Operation::READ_MEM && !write) return true;
+    if (memory_controller_->can_accept(write)) return true;
+
+    memory_controller_->record_full_stall();
+    return false;
+}
+
+bool System::pipeline_empty() const {
+    return interconnect_->all_queues_empty() && (!memory_controller_ || memory_controller_->empty());
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 bool System::all_pes_finished() const {
@@ -836,8 +1499,185 @@ bool System::all_pes_finished() const {
 void System::report_statistics() const {
     std::cout << "\n[System] Reporting statistics for " << total_pes_
               << " PEs...\n";
-    // TODO: Integrar con StatisticsUnit
-    std::cout << "[System] (Placeholder)\n";
+
+    // Coalescing de READ_MEM en el Interconnect
+    CoalescingStats coalescing = interconnect_->get_coalescing_stats();
+    double hit_rate = coalescing.read_requests
+        ? 100.0 * coalescing.coalesced_reads / coalescing.read_requests
+        : 0.0;
+    std::cout << "[Stats] READ_MEM requests: " << coalescing.read_requests
+              << ", served by coalescing: " << coalescing.coalesced_reads
+              << " (" << hit_rate << "%)"
+              << ", SharedMemory reads: " << coalescing.memory_reads << "\n";
+    if (directory_) {
+        std::cout << "[Stats] Cache-to-cache: " << coalescing.cache_to_cache << " of "
+                  << coalescing.read_requests << " READ_MEM ("
+                  << (coalescing.read_requests
+                          ? 100.0 * coalescing.cache_to_cache / coalescing.read_requests : 0.0)
+                  << "%), stale directory hints: " << coalescing.directory_stale
+                  << ", directory lines: " << directory_->size() << "\n";
+    }
+
+    // Contención por banco de la memoria compartida
+    const MemoryConfig& mem_cfg = shared_memory_->get_config();
+    std::cout << "[Stats] SharedMemory: " << mem_cfg.banks << " banks, "
+              << (mem_cfg.interleave == Interleave::LINE ? "line" : "page") << " interleave, "
+              << shared_memory_->touched_pages() << " page(s) touched ("
+              << shared_memory_->touched_pages() * mem_cfg.page_words * 4 / 1024 << " KiB of "
+              << mem_cfg.words * 4 / 1024 << " KiB)\n";
+    uint64_t cycles = std::max<uint64_t>(1, interconnect_->get_cycle());
+    const auto& banks = shared_memory_->get_banks();
+    for (size_t b = 0; b < banks.size(); ++b) {
+        std::cout << "[Stats]   bank " << b
+                  << ": accesses=" << banks[b].accesses
+                  << ", conflicts=" << banks[b].conflicts
+                  << ", max_in_flight=" << banks[b].max_in_flight
+                  << ", utilization=" << (100.0 * banks[b].busy_cycles / cycles) << "%\n";
+    }
+    if (const DramModel* dram = shared_memory_->get_dram()) {
+        const DramStats& ds = dram->get_stats();
+        uint64_t lines = ds.row_hits + ds.row_misses + ds.row_conflicts;
+        std::cout << "[Stats] DRAM: row_hits=" << ds.row_hits
+                  << ", row_misses=" << ds.row_misses
+                  << ", row_conflicts=" << ds.row_conflicts
+                  << ", row_hit_rate=" << (lines ? 100.0 * ds.row_hits / lines : 0.0) << "%"
+                  << ", refreshes=" << ds.refreshes << "\n";
+    }
+    if (memory_controller_) {
+        const ControllerStats& mc = memory_controller_->get_stats();
+        uint64_t issued = mc.reads + mc.writes;
+        std::cout << "[Stats] Memory controller: "
+                  << ControllerConfig::policy_to_string(memory_controller_->get_config().policy)
+                  << ", reads=" << mc.reads
+                  << " (avg_wait=" << (mc.reads ? static_cast<double>(mc.read_wait) / mc.reads : 0.0) << ")"
+                  << ", writes=" << mc.writes
+                  << " (avg_wait=" << (mc.writes ? static_cast<double>(mc.write_wait) / mc.writes : 0.0) << ")"
+                  << ", row_hit_issues=" << (issued ? 100.0 * mc.row_hit_issues / issued : 0.0) << "%"
+                  << ", aged=" << mc.aged_issues
+                  << ", write_drains=" << mc.drains
+                  << ", max_queue=" << mc.max_reads << "/" << mc.max_writes
+                  << ", full_stalls=" << mc.full_stalls << "\n";
+        // Espera media por QoS: cómo se combina la política con el ArbitScheme del Interconnect
+        for (const auto& [qos, wait] : mc.qos_wait) {
+            std::cout << "[Stats]   QoS 0x" << std::hex << static_cast<int>(qos) << std::dec
+                      << ": accesses=" << wait.first
+                      << ", avg_wait=" << static_cast<double>(wait.second) / wait.first << "\n";
+        }
+    }
+
+    // Ventana de peticiones en vuelo de cada PE
+    for (const auto& pe : pes_) {
+        const MSHRStats& mshr = pe.get_mshr_stats();
+        std::cout << "[Stats] PE " << pe.get_id()
+                  << ": window=" << pe.get_max_outstanding()
+                  << ", issued=" << mshr.issued
+                  << ", completed=" << mshr.completed
+                  << ", max_outstanding=" << mshr.max_outstanding
+                  << ", out_of_order=" << mshr.out_of_order
+                  << ", window_full_steps=" << mshr.window_full_steps << "\n";
+
+        // Write-combining: cuántos WRITE_MEM se ahorró el Interconnect
+        const WriteCombiningBuffer& wc = write_buffers_[static_cast<size_t>(pe.get_id())];
+        if (wc.enabled()) {
+            const WriteCombineStats& ws = wc.get_stats();
+            std::cout << "[Stats] PE " << pe.get_id() << " write-combining: writes=" << ws.writes
+                      << ", merged=" << ws.merged
+                      << ", sent=" << ws.flushed
+                      << ", merge_ratio=" << (ws.flushed ? static_cast<double>(ws.writes) / ws.flushed : 0.0)
+                      << ", requests_saved=" << (ws.writes ? 100.0 * (ws.writes - ws.flushed) / ws.writes : 0.0) << "%"
+                      << ", bytes_in=" << ws.bytes_in << ", bytes_out=" << ws.bytes_out
+                      << ", flushes (capacity=" << ws.capacity_flushes
+                      << ", conflict=" << ws.conflict_flushes
+                      << ", fence=" << ws.fence_flushes
+                      << ", timeout=" << ws.timeout_flushes
+                      << ", drain=" << ws.drain_flushes << ")\n";
+        }
+    }
+
+    // L2 compartido: hit rate y líneas que se ahorró SharedMemory
+    if (shared_cache_) {
+        const SharedCacheStats& l2 = shared_cache_->get_stats();
+        uint64_t accesses = l2.read_hits + l2.read_misses + l2.write_hits + l2.write_misses;
+        uint64_t hits     = l2.read_hits + l2.write_hits;
+        uint64_t without  = accesses + l2.bypassed;             // líneas que iban a memoria sin L2
+        uint64_t with     = l2.fills + l2.writebacks + l2.bypassed;
+        std::cout << "[Stats] L2: " << shared_cache_->get_config().size << " bytes, "
+                  << shared_cache_->get_config().ways << " ways, "
+                  << shared_cache_->get_config().banks << " banks"
+                  << ", read_hits=" << l2.read_hits << ", read_misses=" << l2.read_misses
+                  << ", write_hits=" << l2.write_hits << ", write_misses=" << l2.write_misses
+                  << ", hit_rate=" << (accesses ? 100.0 * hits / accesses : 0.0) << "%\n";
+        std::cout << "[Stats] L2 memory traffic: " << with << " lines (fills=" << l2.fills
+                  << ", writebacks=" << l2.writebacks << ") vs " << without
+                  << " without L2, reduction="
+                  << (without ? 100.0 * (static_cast<double>(without) - with) / without : 0.0) << "%\n";
+        const auto& l2_banks = shared_cache_->get_banks();
+        for (size_t b = 0; b < l2_banks.size(); ++b) {
+            std::cout << "[Stats]   L2 bank " << b << ": accesses=" << l2_banks[b].accesses
+                      << ", conflicts=" << l2_banks[b].conflicts << "\n";
+        }
+    }
+
+    // Transacciones de coherencia MESI
+    CoherenceStats coherence = interconnect_->get_coherence_stats();
+    std::cout << "[Stats] Coherence: snoops=" << coherence.snoops
+              << ", upgrades=" << coherence.upgrades
+              << ", invalidations=" << coherence.invalidations
+              << ", downgrades=" << coherence.downgrades << "\n";
+
+    // Caches locales: hits servidos sin pasar por el Interconnect
+    for (size_t i = 0; i < caches_.size(); ++i) {
+        CacheStats cs = caches_[i].get_stats();
+        uint64_t reads = cs.read_hits + cs.read_misses;
+        std::cout << "[Stats] PE " << i << " cache: reads=" << reads
+                  << ", hits=" << cs.read_hits
+                  << ", misses=" << cs.read_misses
+                  << ", hit_rate=" << (reads ? 100.0 * cs.read_hits / reads : 0.0) << "%"
+                  << ", fills=" << cs.fills
+                  << ", evictions=" << cs.evictions
+                  << ", invalidations=" << cs.invalidations << "\n";
+
+        // Write-back: bytes de escritura que no cruzaron el fabric frente a write-through
+        if (caches_[i].get_config().write_policy == WritePolicy::WRITE_BACK) {
+            uint64_t wb_bytes  = cs.writebacks * caches_[i].get_config().line_size;
+            uint64_t fabric    = cs.write_bytes_sent + wb_bytes;
+            uint64_t through   = cs.write_bytes_absorbed + cs.write_bytes_sent;
+            std::cout << "[Stats] PE " << i << " write-back: absorbed=" << cs.writes_absorbed
+                      << " (" << cs.write_bytes_absorbed << " bytes)"
+                      << ", sent=" << cs.writes_sent << " (" << cs.write_bytes_sent << " bytes)"
+                      << ", writebacks=" << cs.writebacks << " (" << wb_bytes << " bytes)"
+                      << ", fabric_write_bytes=" << fabric << " vs " << through << " write-through"
+                      << ", saving=" << (through ? 100.0 * (static_cast<double>(through) - fabric) / through : 0.0)
+                      << "%\n";
+        }
+
+        // Prefetch: exactitud (útiles/emitidos), cobertura (misses evitados) y costo en el fabric
+        const Prefetcher* prefetcher = caches_[i].get_prefetcher();
+        if (prefetcher) {
+            const PrefetchStats& ps = prefetcher->get_stats();
+            uint64_t demand = pes_[i].get_mshr_stats().issued;
+            std::cout << "[Stats] PE " << i << " prefetch ("
+                      << Prefetcher::mode_to_string(prefetcher->get_config().mode)
+                      << ", degree=" << prefetcher->get_config().degree
+                      << "): issued=" << ps.issued
+                      << ", useful=" << ps.useful
+                      << ", late=" << ps.late
+                      << ", accuracy=" << (ps.issued ? 100.0 * ps.useful / ps.issued : 0.0) << "%"
+                      << ", coverage=" << (ps.useful + cs.read_misses
+                                              ? 100.0 * ps.useful / (ps.useful + cs.read_misses) : 0.0) << "%"
+                      << ", fabric_overhead=" << (demand + ps.issued
+                                              ? 100.0 * ps.issued / (demand + ps.issued) : 0.0) << "%"
+                      << " (" << ps.bytes << " bytes)\n";
+        }
+    }
+}
+
+void System::dump_cache_state() const {
+    for (const auto& cache : caches_) {
+        cache.dump_state_to_text_file();
+    }
+    std::cout << "[System] MESI state of " << caches_.size()
+              << " caches dumped to config/caches/inv_cache_<id>.txt\n";
 }
 
 // Helper interno para convertir la operación a texto
@@ -851,6 +1691,7 @@ const char* System::operation_to_string(Operation op) {
         case Operation::INV_COMPLETE:         return "INV_COMPLETE";
         case Operation::READ_RESP:            return "READ_RESP";
         case Operation::WRITE_RESP:           return "WRITE_RESP";
+        case Operation::WRITEBACK:            return "WRITEBACK";
         case Operation::END:                  return "END";
         default:                              return "UNDEFINED";
     }
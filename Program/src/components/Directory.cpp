@@ -0,0 +1,77 @@
+#include "../../include/components/Directory.h"
+#include <stdexcept>
+#include <string>
+
+Directory::Directory(int total_pes)
+    : total_pes_(total_pes) {
+    if (total_pes_ < 1 || total_pes_ > MAX_PES) {
+        throw std::invalid_argument("Directory: soporta de 1 a " + std::to_string(MAX_PES) +
+                                    " PEs, se pidieron " + std::to_string(total_pes_));
+    }
+}
+
+void Directory::record_read(uint64_t first_line, uint64_t last_line, int pe, bool exclusive) {
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        Entry& entry = entries_[line];
+        if (exclusive) {
+            entry.sharers = 0;
+            entry.owner   = pe;
+        } else {
+            entry.owner = -1;
+        }
+        entry.sharers |= 1ULL << pe;
+    }
+}
+
+void Directory::record_write(uint64_t first_line, uint64_t last_line, int pe, bool present) {
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        if (!present) {
+            entries_.erase(line);
+            continue;
+        }
+        Entry& entry  = entries_[line];
+        entry.sharers = 1ULL << pe;
+        entry.owner   = pe;
+    }
+}
+
+void Directory::remove(uint64_t first_line, uint64_t last_line, int pe) {
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        auto it = entries_.find(line);
+        if (it == entries_.end()) continue;
+
+        it->second.sharers &= ~(1ULL << pe);
+        if (it->second.owner == pe) it->second.owner = -1;
+        if (it->second.sharers == 0) entries_.erase(it);
+    }
+}
+
+std::vector<int> Directory::holders(uint64_t first_line, uint64_t last_line, int requester) const {
+    // PEs con copia de TODAS las líneas del rango
+    uint64_t common = ~0ULL;
+    for (uint64_t line = first_line; line <= last_line && common; ++line) {
+        auto it = entries_.find(line);
+        common &= (it == entries_.end()) ? 0 : it->second.sharers;
+    }
+    if (requester >= 0) common &= ~(1ULL << requester);
+
+    std::vector<int> result;
+    if (!common) return result;
+
+    // El owner responde primero: su copia es la única que puede estar en M
+    auto first = entries_.find(first_line);
+    int owner = first->second.owner;
+    if (owner >= 0 && (common & (1ULL << owner))) {
+        result.push_back(owner);
+    }
+    for (int pe = 0; pe < total_pes_; ++pe) {
+        if (pe != owner && (common & (1ULL << pe))) {
+            result.push_back(pe);
+        }
+    }
+    return result;
+}
+
+size_t Directory::size() const {
+    return entries_.size();
+}
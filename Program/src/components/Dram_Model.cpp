@@ -0,0 +1,113 @@
+#include "../../include/components/Dram_Model.h"
+#include "../../include/Config_File.h"
+#include <algorithm>
+#include <stdexcept>
+
+DramConfig DramConfig::load_from_file(const std::string& filename) {
+    ConfigFile cfg(filename);
+    DramConfig config;
+
+    if (!cfg.is_loaded()) {
+        return config;  // sin dram.txt la memoria conserva su fórmula de latencia
+    }
+
+    config.enabled  = cfg.get_bool("dram", config.enabled);
+    config.row_size = static_cast<uint32_t>(cfg.get_int("row_size", config.row_size));
+    config.t_rcd    = static_cast<uint32_t>(cfg.get_int("t_rcd", config.t_rcd));
+    config.t_cas    = static_cast<uint32_t>(cfg.get_int("t_cas", config.t_cas));
+    config.t_rp     = static_cast<uint32_t>(cfg.get_int("t_rp", config.t_rp));
+    config.t_ras    = static_cast<uint32_t>(cfg.get_int("t_ras", config.t_ras));
+    config.t_wr     = static_cast<uint32_t>(cfg.get_int("t_wr", config.t_wr));
+    config.t_burst  = static_cast<uint32_t>(cfg.get_int("t_burst", config.t_burst));
+    config.t_refi   = static_cast<uint32_t>(cfg.get_int("t_refi", config.t_refi));
+    config.t_rfc    = static_cast<uint32_t>(cfg.get_int("t_rfc", config.t_rfc));
+
+    std::string policy = cfg.get_string("page_policy", "open");
+    if (policy == "open") {
+        config.page_policy = PagePolicy::OPEN;
+    } else if (policy == "close") {
+        config.page_policy = PagePolicy::CLOSE;
+    } else {
+        throw std::invalid_argument(filename + ": page_policy debe ser 'open' o 'close': " + policy);
+    }
+
+    if (config.row_size == 0 || config.row_size % 16 != 0) {
+        throw std::invalid_argument(filename + ": row_size debe ser múltiplo de 16 y mayor que 0");
+    }
+    if (config.t_burst == 0) {
+        throw std::invalid_argument(filename + ": t_burst debe ser mayor que 0");
+    }
+    if (config.t_refi != 0 && config.t_rfc >= config.t_refi) {
+        throw std::invalid_argument(filename + ": t_rfc debe ser menor que t_refi");
+    }
+    return config;
+}
+
+DramModel::DramModel(const DramConfig& config, uint32_t banks)
+    : config_(config), banks_(banks) {
+    for (auto& bank : banks_) {
+        bank.next_refresh = config_.t_refi;
+    }
+}
+
+uint64_t DramModel::refresh(DramBank& bank, uint64_t now) {
+    if (config_.t_refi == 0) return now;
+
+    // Un refresco cierra la fila; los que vencieron mientras el banco estaba libre no cuestan
+    while (bank.next_refresh <= now) {
+        uint64_t end = bank.next_refresh + config_.t_rfc;
+        bank.open_row     = -1;
+        bank.next_refresh += config_.t_refi;
+        if (end > now) {
+            ++stats_.refreshes;
+            now = end;
+        }
+    }
+    return now;
+}
+
+uint64_t DramModel::service(uint32_t bank_id, const std::vector<uint64_t>& rows, uint64_t start, bool write) {
+    DramBank& bank = banks_.at(bank_id);
+    uint64_t t = refresh(bank, start);
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        int64_t row = static_cast<int64_t>(rows[i]);
+
+        if (bank.open_row == row) {
+            // Row hit: las líneas seguidas de la misma fila se encadenan en ráfaga
+            ++stats_.row_hits;
+            bool streaming = i > 0 && rows[i - 1] == rows[i];
+            t += (streaming ? 0 : config_.t_cas) + config_.t_burst;
+            continue;
+        }
+
+        if (bank.open_row >= 0) {
+            // Row conflict: cerrar la fila abierta respetando tRAS/tWR
+            ++stats_.row_conflicts;
+            t = std::max(t, bank.precharge_ready) + config_.t_rp;
+        } else {
+            ++stats_.row_misses;
+            t = std::max(t, bank.activate_ready);
+        }
+
+        // ACTIVATE de la fila nueva y primera columna
+        bank.open_row        = row;
+        bank.precharge_ready = t + config_.t_ras;
+        t += config_.t_rcd + config_.t_cas + config_.t_burst;
+    }
+
+    if (write) {
+        bank.precharge_ready = std::max(bank.precharge_ready, t + config_.t_wr);
+    }
+
+    // Close page: el PRECHARGE empieza en cuanto se puede; el próximo ACTIVATE lo espera
+    if (config_.page_policy == PagePolicy::CLOSE && bank.open_row >= 0) {
+        bank.activate_ready = std::max(t, bank.precharge_ready) + config_.t_rp;
+        bank.open_row = -1;
+    }
+    return t;
+}
+
+bool DramModel::is_open(uint32_t bank, uint64_t row) const {
+    return banks_.at(bank).open_row == static_cast<int64_t>(row);
+}
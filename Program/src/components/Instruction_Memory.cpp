@@ -6,6 +6,9 @@
 #include <iomanip>
 #include <bitset>
 #include <filesystem>
+#include <array>
+#include <bit>
+#include "../../include/Instruction_Format.h"
 
 InstructionMemory::InstructionMemory(int pe_id)
     : pe_id_(pe_id) {
@@ -54,14 +57,27 @@ void InstructionMemory::initialize() {
 }
 
 void InstructionMemory::load_from_file(const std::string& filename) {
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         throw std::runtime_error("Error: No se pudo abrir el archivo " + filename);
     }
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
 
+    std::array<uint8_t, ObjectFormat::HEADER_BYTES> header{};
+    if (file_size >= header.size() && file.read(reinterpret_cast<char*>(header.data()), header.size())
+        && ObjectFormat::has_magic(header.data(), header.size())) {
+        load_object(file, filename, file_size, ObjectFormat::decode_header(header.data()));
+        return;
+    }
+
+    // Sin MAGIC: formato de texto anterior, una instrucción por línea
+    file.clear();
+    file.seekg(0);
     std::string line;
     while (std::getline(file, line)) {
         if (!line.empty()) {
+            if (line.back() == '\r') line.pop_back();
             uint64_t value = parse_instruction(line);
             instructions.push_back(value);
         }
@@ -69,6 +85,48 @@ void InstructionMemory::load_from_file(const std::string& filename) {
     file.close();
 }
 
+void InstructionMemory::load_object(std::ifstream& file, const std::string& filename,
+                                    uint64_t file_size, const ObjectHeader& header) {
+    if (header.version != ObjectFormat::VERSION) {
+        throw std::runtime_error("Error: " + filename + " tiene versión de objeto "
+                                 + std::to_string(header.version) + ", se esperaba "
+                                 + std::to_string(ObjectFormat::VERSION) + "; recompilar");
+    }
+    if (header.bits != InstructionFormat::BITS) {
+        throw std::runtime_error("Error: " + filename + " usa instrucciones de " + std::to_string(header.bits)
+                                 + " bits, se esperaban " + std::to_string(InstructionFormat::BITS));
+    }
+    if (header.pe_id != ObjectFormat::ANY_PE && header.pe_id != static_cast<uint32_t>(pe_id_)) {
+        throw std::runtime_error("Error: " + filename + " fue compilado para el PE " + std::to_string(header.pe_id));
+    }
+    uint64_t payload = file_size - ObjectFormat::HEADER_BYTES;
+    if (header.count > payload / ObjectFormat::INSTRUCTION_BYTES
+        || header.count * ObjectFormat::INSTRUCTION_BYTES != payload) {
+        throw std::runtime_error("Error: " + filename + " anuncia " + std::to_string(header.count)
+                                 + " instrucciones pero tiene " + std::to_string(payload) + " bytes de datos");
+    }
+
+    // Una sola lectura directo al vector; en una máquina big-endian se reordenan después
+    size_t base = instructions.size();
+    instructions.resize(base + header.count);
+    uint64_t* words = instructions.data() + base;
+    if (!file.read(reinterpret_cast<char*>(words), static_cast<std::streamsize>(payload))) {
+        instructions.resize(base);
+        throw std::runtime_error("Error: No se pudo leer " + filename);
+    }
+    for (uint64_t i = 0; i < header.count; ++i) {
+        if constexpr (std::endian::native != std::endian::little) {
+            words[i] = ObjectFormat::load_le(reinterpret_cast<const uint8_t*>(&words[i]),
+                                             ObjectFormat::INSTRUCTION_BYTES);
+        }
+        if (!InstructionFormat::fits(words[i])) {
+            instructions.resize(base);
+            throw std::overflow_error("Error: Instrucción supera los "
+                                      + std::to_string(InstructionFormat::BITS) + " bits permitidos.");
+        }
+    }
+}
+
 uint64_t InstructionMemory::fetch_instruction(size_t address) const {
     if (address >= instructions.size()) {
         throw std::out_of_range("Error: Dirección fuera de rango en la memoria de instrucciones.");
@@ -86,8 +144,11 @@ uint64_t InstructionMemory::parse_instruction(const std::string& text) {
     if (text.find("0x") == 0 || text.find("0X") == 0) {
         value = std::stoull(text, nullptr, 16);
     } else {
-        if (text.length() > 64) {
-            throw std::invalid_argument("Error: Instrucción binaria supera los 64 bits.");
+        // Una línea de otro ancho es de un formato anterior: se decodificaría mal
+        if (text.length() != InstructionFormat::BITS) {
+            throw std::invalid_argument("Error: Instrucción binaria de " + std::to_string(text.length())
+                                        + " bits, se esperaban " + std::to_string(InstructionFormat::BITS)
+                                        + " (recompilar el ensamblador)");
         }
         for (char c : text) {
             if (c != '0' && c != '1') {
@@ -97,8 +158,9 @@ uint64_t InstructionMemory::parse_instruction(const std::string& text) {
         }
     }
 
-    if (value >= (1ULL << 43)) {
-        throw std::overflow_error("Error: Instrucción supera los 43 bits permitidos.");
+    if (!InstructionFormat::fits(value)) {
+        throw std::overflow_error("Error: Instrucción supera los "
+                                  + std::to_string(InstructionFormat::BITS) + " bits permitidos.");
     }
 
     return value;
@@ -1,29 +1,84 @@
 #include "../../include/components/Interconnect.h"
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
-Interconnect::Interconnect(int num_pes, ArbitScheme scheme)
-    : num_pes_(num_pes), scheme_(scheme) {
+/** @brief Menor potencia de dos mayor o igual a @p n (mínimo 1). */
+static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+Interconnect::Interconnect(int num_pes, ArbitScheme scheme, size_t max_broadcasts)
+    : num_pes_(num_pes), scheme_(scheme),
+      broadcast_capacity_(round_up_pow2(max_broadcasts)),
+      broadcasts_(std::make_unique<BroadcastSlot[]>(broadcast_capacity_)) {
     std::cout << "[Interconnect] Created with " << num_pes_
               << " PE connections and will use " << (scheme_ == ArbitScheme::FIFO ? "FIFO" : "PRIORITY")
-              << " as its arbitration scheme.\n";
+              << " as its arbitration scheme (" << broadcast_capacity_ << " broadcast slots).\n";
 }
 
-uint32_t Interconnect::register_broadcast(int origin_pe) {
-    // 1) Conseguir un ID único
-    uint32_t bid = next_broadcast_id_.fetch_add(1, std::memory_order_relaxed);
+bool Interconnect::try_register_broadcast(int origin_pe, uint32_t origin_tag, uint32_t& bid) {
+    // 1) Nueva vuelta de IDs; empezamos a buscar en un slot distinto cada vez
+    uint32_t round = next_broadcast_round_.fetch_add(1, std::memory_order_relaxed);
+    uint32_t mask  = static_cast<uint32_t>(broadcast_capacity_ - 1);
+    uint32_t base  = round * static_cast<uint32_t>(broadcast_capacity_);
+
+    for (size_t probe = 0; probe < broadcast_capacity_; ++probe) {
+        uint32_t index = (round + static_cast<uint32_t>(probe)) & mask;
+        uint32_t candidate = base + index;          // candidate % capacidad == index
+        if (candidate + 1 == 0) continue;           // generación 0 significa libre
+
+        // 2) Reclamamos el slot solo si sigue libre
+        BroadcastSlot& slot = broadcasts_[index];
+        uint32_t expected = 0;
+        if (!slot.generation.compare_exchange_strong(expected, candidate + 1,
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed)) {
+            continue;
+        }
 
-    {
-        // 2) Guardamos la info bajo mutex
-        std::lock_guard<std::mutex> lk(broadcast_mtx_);
-        pending_broadcasts_[bid] = PendingBroadcast{
-            .origin_pe    = origin_pe,
-            .pending_acks = num_pes_   // esperamos uno por cada PE
-        };
+        // 3) El ID aún no salió de aquí: ningún ACK puede leer el slot antes de llenarlo
+        slot.origin_pe.store(origin_pe, std::memory_order_relaxed);
+        slot.origin_tag.store(origin_tag, std::memory_order_relaxed);
+        slot.pending_acks.store(num_pes_, std::memory_order_release);  // esperamos uno por cada PE
+        bid = candidate;
+        return true;
     }
+    return false;
+}
 
-    // 3) Devolvemos el ID para que System pueda asignarlo al Message
-    return bid;
+bool Interconnect::has_free_broadcast_slot() const {
+    for (size_t i = 0; i < broadcast_capacity_; ++i) {
+        if (broadcasts_[i].generation.load(std::memory_order_acquire) == 0) return true;
+    }
+    return false;
+}
+
+AckResult Interconnect::acknowledge_broadcast(uint32_t broadcast_id, int& origin_pe,
+                                              uint32_t& origin_tag, int& remaining) {
+    BroadcastSlot& slot = broadcasts_[broadcast_id & (broadcast_capacity_ - 1)];
+    origin_pe  = -1;
+    origin_tag = 0;
+    remaining  = -1;
+
+    // 1) El slot debe pertenecer a este broadcast
+    if (slot.generation.load(std::memory_order_acquire) != broadcast_id + 1) {
+        return AckResult::INVALID;
+    }
+    origin_pe  = slot.origin_pe.load(std::memory_order_relaxed);
+    origin_tag = slot.origin_tag.load(std::memory_order_relaxed);
+
+    // 2) Restamos un ACK pendiente
+    remaining = slot.pending_acks.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (remaining > 0) {
+        return AckResult::PENDING;
+    }
+
+    // 3) Último ACK: liberamos el slot
+    slot.generation.store(0, std::memory_order_release);
+    return AckResult::COMPLETE;
 }
 
 bool Interconnect::has_response(int pe_id) const {
@@ -116,11 +171,89 @@ Message Interconnect::pop_next() {
     return m;
 }
 
+Operation Interconnect::next_operation() const {
+    std::lock_guard<std::mutex> lock(in_queue_mtx_);
+    if (in_queue_.empty()) {
+        throw std::out_of_range("Interconnect::next_operation(): queue is empty");
+    }
+    return in_queue_.front().get_operation();
+}
+
+bool Interconnect::has_pending_ack() const {
+    std::lock_guard<std::mutex> lock(in_queue_mtx_);
+    return std::any_of(in_queue_.begin(), in_queue_.end(),
+                       [](const Message& m) { return m.get_operation() == Operation::INV_ACK; });
+}
+
+Message Interconnect::pop_next_ack() {
+    std::lock_guard<std::mutex> lock(in_queue_mtx_);
+    auto it = std::find_if(in_queue_.begin(), in_queue_.end(),
+                           [](const Message& m) { return m.get_operation() == Operation::INV_ACK; });
+    if (it == in_queue_.end()) {
+        throw std::out_of_range("Interconnect::pop_next_ack(): no INV_ACK queued");
+    }
+    Message m = *it;
+    in_queue_.erase(it);
+    return m;
+}
+
 bool Interconnect::in_queue_empty() const {
     std::lock_guard<std::mutex> lock(in_queue_mtx_);
     return in_queue_.empty();
 }
 
+std::vector<Message> Interconnect::take_overlapping_reads(uint64_t& first_word, uint64_t& end_word) {
+    std::lock_guard<std::mutex> lock(in_queue_mtx_);
+    std::vector<Message> taken;
+
+    // Se repite mientras el rango crezca: una lectura nueva puede tocar otras
+    bool grew = true;
+    while (grew) {
+        grew = false;
+        // Escrituras que están antes en la cola: una lectura que se solape con
+        // alguna no puede adelantarla o leería el dato viejo
+        std::vector<std::pair<uint64_t, uint64_t>> writes;
+        for (auto it = in_queue_.begin(); it != in_queue_.end(); ) {
+            Operation op = it->get_operation();
+            uint64_t lo = it->get_address();
+
+            // Un broadcast invalida caches: nada de lo que viene detrás lo adelanta
+            if (op == Operation::BROADCAST_INVALIDATE) break;
+            if (op == Operation::WRITE_MEM || op == Operation::WRITEBACK) {
+                writes.emplace_back(lo, lo + write_span_words(*it));
+                ++it;
+                continue;
+            }
+            if (op != Operation::READ_MEM) { ++it; continue; }
+
+            uint64_t hi = lo + read_span_words(it->get_size());
+            bool after_write = std::any_of(writes.begin(), writes.end(),
+                [&](const auto& w) { return lo < w.second && w.first < hi; });
+            if (lo < end_word && first_word < hi && !after_write) {
+                first_word = std::min(first_word, lo);
+                end_word   = std::max(end_word, hi);
+                taken.push_back(*it);
+                it = in_queue_.erase(it);
+                grew = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return taken;
+}
+
+uint64_t Interconnect::read_span_words(uint32_t size_bytes) {
+    uint64_t words = (static_cast<uint64_t>(size_bytes) + 3) / 4;
+    return ((words + 3) / 4) * 4;
+}
+
+uint64_t Interconnect::write_span_words(const Message& m) {
+    // WRITE_MEM trae sus bloques; WRITEBACK solo su cantidad (los datos esperan en el caché)
+    uint64_t blocks = std::max<uint64_t>(m.get_data().size(), m.get_num_lines());
+    return blocks * 4;
+}
+
 /* ------------------------------------ */
 /*                                      */
 /*         mid_processing_queue         */
@@ -209,6 +342,53 @@ bool Interconnect::out_queue_empty() const {
 
 /* --------------------------------------------------------------------------------------------- */
 
+/* ---------------------------------------- Statistics ----------------------------------------- */
+
+void Interconnect::record_memory_read(size_t requests_served) {
+    memory_reads_.fetch_add(1, std::memory_order_relaxed);
+    read_requests_.fetch_add(requests_served, std::memory_order_relaxed);
+    if (requests_served > 1) {
+        coalesced_reads_.fetch_add(requests_served - 1, std::memory_order_relaxed);
+    }
+}
+
+void Interconnect::record_cache_to_cache() {
+    read_requests_.fetch_add(1, std::memory_order_relaxed);
+    c2c_reads_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Interconnect::record_directory_stale(size_t holders) {
+    directory_stale_.fetch_add(holders, std::memory_order_relaxed);
+}
+
+CoalescingStats Interconnect::get_coalescing_stats() const {
+    CoalescingStats stats;
+    stats.read_requests   = read_requests_.load(std::memory_order_relaxed);
+    stats.coalesced_reads = coalesced_reads_.load(std::memory_order_relaxed);
+    stats.memory_reads    = memory_reads_.load(std::memory_order_relaxed);
+    stats.cache_to_cache  = c2c_reads_.load(std::memory_order_relaxed);
+    stats.directory_stale = directory_stale_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Interconnect::record_coherence(const CoherenceStats& stats) {
+    snoops_.fetch_add(stats.snoops, std::memory_order_relaxed);
+    upgrades_.fetch_add(stats.upgrades, std::memory_order_relaxed);
+    invalidations_.fetch_add(stats.invalidations, std::memory_order_relaxed);
+    downgrades_.fetch_add(stats.downgrades, std::memory_order_relaxed);
+}
+
+CoherenceStats Interconnect::get_coherence_stats() const {
+    CoherenceStats stats;
+    stats.snoops        = snoops_.load(std::memory_order_relaxed);
+    stats.upgrades      = upgrades_.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    stats.downgrades    = downgrades_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 /* ----------------------------------- Getters & Setters --------------------------------------- */
 
 ICState Interconnect::get_state() const {
@@ -219,6 +399,14 @@ void Interconnect::set_state(ICState s) {
     state_ = s;
 }
 
+void Interconnect::advance_cycle() {
+    cycle_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t Interconnect::get_cycle() const {
+    return cycle_.load(std::memory_order_relaxed);
+}
+
 const std::deque<Message>& Interconnect::get_in_queue() const {
     // No bloqueamos aquí, porque devolvemos solo lectura.
     return in_queue_;
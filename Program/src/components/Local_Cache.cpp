@@ -9,48 +9,163 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
-#include <charconv>
+#include <algorithm>
+#include "../../include/Config_File.h"
+#include "../../include/Seeded_Fill.h"
 
 namespace fs = std::filesystem;
 
-LocalCache::LocalCache(int id)
-    : id_(id), cache_data(BLOCKS) {
+/** @brief true si @p v es potencia de 2 (y distinto de 0). */
+static bool is_power_of_two(uint32_t v) {
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+CacheConfig CacheConfig::load_from_file(const std::string& filename) {
+    ConfigFile cfg(filename);
+    CacheConfig config;
+
+    if (!cfg.is_loaded()) {
+        std::cerr << "[LocalCache] Warning: could not open " << filename
+                  << ", using " << config.sets << " sets x " << config.ways
+                  << " ways x " << config.line_size << " B\n";
+        return config;
+    }
+
+    config.sets        = static_cast<uint32_t>(cfg.get_int("sets", config.sets));
+    config.ways        = static_cast<uint32_t>(cfg.get_int("ways", config.ways));
+    config.line_size   = static_cast<uint32_t>(cfg.get_int("line_size", config.line_size));
+    config.replacement = TagStore::parse_replacement(cfg.get_string("replacement", "lru"));
+    config.prefetch    = PrefetchConfig::from_config(cfg);
+    config.cache_to_cache = cfg.get_bool("cache_to_cache", config.cache_to_cache);
+    config.storage     = MappedFile::parse_storage(cfg.get_string("storage", "heap"));
+    config.init        = MappedFile::parse_init(cfg.get_string("init", "random"));
+    config.seed        = static_cast<uint64_t>(cfg.get_int("seed", static_cast<int64_t>(config.seed)));
+
+    std::string write_policy = cfg.get_string("write_policy", "through");
+    if (write_policy == "through") {
+        config.write_policy = WritePolicy::WRITE_THROUGH;
+    } else if (write_policy == "back") {
+        config.write_policy = WritePolicy::WRITE_BACK;
+    } else {
+        throw std::invalid_argument(filename + ": write_policy debe ser 'through' o 'back': " + write_policy);
+    }
+
+    if (!is_power_of_two(config.sets) || config.ways == 0) {
+        throw std::invalid_argument(filename + ": sets debe ser potencia de 2 y ways mayor que 0");
+    }
+    if (!is_power_of_two(config.line_size) || config.line_size < LocalCache::BLOCK_SIZE) {
+        throw std::invalid_argument(filename + ": line_size debe ser potencia de 2 y al menos "
+                                    + std::to_string(LocalCache::BLOCK_SIZE));
+    }
+    return config;
+}
+
+LocalCache::LocalCache(int id, const CacheConfig& config)
+    : id_(id), config_(config),
+      tags_(config.sets, config.ways, config.replacement, static_cast<uint32_t>(id)),
+      blocks_per_line_(config.line_size / BLOCK_SIZE),
+      state_(static_cast<size_t>(config.sets) * config.ways) {
+    if (config_.prefetch.mode != PrefetchMode::OFF) {
+        prefetcher_ = std::make_unique<Prefetcher>(config_.prefetch);
+    }
+
     std::cout << "\n[LocalCache] PE " << id_
-              << ": creating cache with " << BLOCKS
-              << " blocks of " << BLOCK_SIZE << " bytes each...\n";
+              << ": creating " << config_.sets << "-set " << config_.ways
+              << "-way cache with " << config_.line_size << "-byte lines ("
+              << TagStore::replacement_to_string(config_.replacement) << ", write-"
+              << (config_.write_policy == WritePolicy::WRITE_BACK ? "back" : "through") << ")...\n";
 
     // Guarda el directorio y el filename donde se volcara el cache en disco
-    dump_path = "config/caches/cache_" + std::to_string(id_) + ".txt";
+    dump_path  = "config/caches/cache_" + std::to_string(id_) + ".txt";
+    image_path = "config/caches/cache_" + std::to_string(id_) + ".bin";
+
+    // Los bloques viven en el heap o directamente en cache_<id>.bin
+    size_t blocks = static_cast<size_t>(config_.sets) * config_.ways * blocks_per_line_;
+    if (config_.storage == Storage::MMAP) {
+        fs::create_directories("config/caches");
+        image_ = MappedFile(image_path, blocks * BLOCK_SIZE);
+        cache_data = {reinterpret_cast<std::array<uint8_t, BLOCK_SIZE>*>(image_.data()), blocks};
+    } else {
+        heap_data_.resize(blocks);
+        cache_data = heap_data_;
+    }
 
     inv_path = "config/caches/inv_cache_" + std::to_string(id_) + ".txt";
-
-    // Inicializar Cache
-    initialize();
 }
 
 /* ---------------------------------------- Initializing --------------------------------------- */
 
 void LocalCache::initialize() {
+    // Arranque en caliente desde la imagen anterior; sin ella se genera con la semilla
+    if (config_.init == InitMode::IMAGE && load_image()) return;
+
     // Se llena con datos aleatorios
     fill_random();
 
-    // Volcado del cache a disco
-    dump_to_text_file();
+    // Volcado del cache a disco (solo hace falta si la corrida no es reproducible)
+    if (!image_.is_open() && config_.init == InitMode::RANDOM) {
+        dump_to_text_file();
+    }
+}
+
+bool LocalCache::load_image() {
+    // Con mmap los datos ya están mapeados si el archivo tenía el tamaño del caché
+    if (image_.is_open()) {
+        if (!image_.reused()) {
+            std::cerr << "[LocalCache] Warning: no previous image of this size in "
+                      << image_path << ", generating from seed\n";
+        }
+        return image_.reused();
+    }
+
+    size_t bytes = cache_data.size_bytes();
+    std::ifstream in(image_path, std::ios::binary);
+    if (!in.is_open() || !fs::exists(image_path) || fs::file_size(image_path) != bytes) {
+        std::cerr << "[LocalCache] Warning: no previous image of this size in "
+                  << image_path << ", generating from seed\n";
+        return false;
+    }
+    in.read(reinterpret_cast<char*>(cache_data.data()), static_cast<std::streamsize>(bytes));
+    return static_cast<bool>(in);
+}
+
+void LocalCache::persist() const {
+    if (image_.is_open()) {
+        image_.sync();
+    } else {
+        dump_to_text_file();
+        dump_to_binary_file();
+    }
 }
 
 void LocalCache::fill_random() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint8_t> distrib(0, 255);
+    uint64_t seed;
+    if (config_.init == InitMode::RANDOM) {
+        std::random_device rd;
+        seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    } else {
+        seed = config_.seed;
+    }
 
-    for (auto& block : cache_data) {
-        for (auto& byte : block) {
-            byte = distrib(gen);
-        }
+    // Un flujo por PE: el resultado no depende del orden de inicialización
+    seeded_fill(seed, static_cast<uint64_t>(id_), cache_data.data(), cache_data.size_bytes());
+}
+
+void LocalCache::dump_to_binary_file() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    fs::create_directories("config/caches");
+    std::ofstream out(image_path, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Error: No se pudo crear el archivo binario: " + image_path);
     }
+    out.write(reinterpret_cast<const char*>(cache_data.data()),
+              static_cast<std::streamsize>(cache_data.size_bytes()));
 }
 
 void LocalCache::dump_to_text_file() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+
     // Asegurar que la carpeta existe
     fs::path dir = "config/caches";
 
@@ -68,12 +183,6 @@ void LocalCache::dump_to_text_file() const {
         throw std::runtime_error("Error: No se pudo crear el archivo: " + dump_path);
     }
 
-    // Crear archivo cache_inv_<pe>.txt
-    std::ofstream inv_file(inv_path);
-    if (!inv_file.is_open()) {
-        throw std::runtime_error("Error: No se pudo crear el archivo: " + inv_path);
-    }
-
     // Cada línea es un bloque; escribimos cada byte en hexadecimal (2 dígitos)
     for (const auto& block : cache_data) {
         for (const auto& byte : block) {
@@ -83,201 +192,529 @@ void LocalCache::dump_to_text_file() const {
         }
         // Restaurar formato decimal y relleno por defecto antes de la nueva línea
         out << std::dec << std::setfill(' ') << "\n";
-        inv_file << "0\n";
     }
 
     out.close();
-    inv_file.close();
+}
+
+void LocalCache::dump_state_to_text_file() const {
+    fs::create_directories("config/caches");
+
+    // Una línea por frame con la letra de su estado MESI
+    std::ofstream inv_file(inv_path);
+    if (!inv_file.is_open()) {
+        throw std::runtime_error("Error: No se pudo crear el archivo: " + inv_path);
+    }
+    for (size_t frame = 0; frame < state_.size(); ++frame) {
+        inv_file << state_to_char(state_.load(frame)) << "\n";
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
 
 /* --------------------------------------- Data Handling --------------------------------------- */ 
 
-std::vector<std::vector<uint8_t>> LocalCache::read_cache_from_file(uint32_t id,
-                                                                    uint32_t start_line,
-                                                                    uint32_t num_lines) {
-    // 1) Abrir el fichero
-    std::string filename = "config/caches/cache_" + std::to_string(id) + ".txt";
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("No se pudo abrir el archivo " + filename);
-    }
-
-    std::string line;
-    // 2) Saltar hasta la línea inicial
-    for (uint32_t i = 0; i < start_line; ++i) {
-        if (!std::getline(file, line)) {
-            throw std::out_of_range(
-                "No se encontró la línea " + std::to_string(i)
-            );
+CacheLookup LocalCache::lookup_read(uint64_t address, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    CacheLookup result;
+
+    uint64_t first_line, last_line;
+    line_range(address, size, first_line, last_line);
+    result.lines      = static_cast<uint32_t>(last_line - first_line + 1);
+    result.first_line = first_line;
+    result.last_line  = last_line;
+
+    // Rango de líneas ausentes [miss_first, miss_last]
+    bool     missing    = false;
+    uint64_t miss_first = 0, miss_last = 0;
+
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        int64_t frame = find_frame(line);
+        if (frame >= 0) {
+            tags_.touch(static_cast<uint32_t>(frame / config_.ways),
+                        static_cast<uint32_t>(frame % config_.ways));
+            continue;
         }
+        if (!missing) miss_first = line;
+        miss_last = line;
+        missing   = true;
     }
 
-    // 3) Leer y parsear cada línea
-    std::vector<std::vector<uint8_t>> result;
-    result.reserve(num_lines);
+    if (!missing) {
+        result.hit = true;
+        ++stats_.read_hits;
+        return result;
+    }
 
-    for (uint32_t ln = 0; ln < num_lines; ++ln) {
-        if (!std::getline(file, line)) {
-            throw std::out_of_range(
-                "No se encontró la línea " +
-                std::to_string(start_line + ln)
-            );
-        }
+    ++stats_.read_misses;
+    result.miss_first_line = miss_first;
+    result.miss_last_line  = miss_last;
+    result.miss_address = miss_first * config_.line_size / 4;
+    result.miss_size    = static_cast<uint32_t>((miss_last - miss_first + 1) * config_.line_size);
+    return result;
+}
 
-        // dividimos por espacios
-        std::istringstream iss(line);
-        std::vector<std::string> tokens;
-        std::string token;
-        while (iss >> token) tokens.push_back(token);
-
-        std::vector<uint8_t> bytes;
-        bytes.reserve(LocalCache::BLOCK_SIZE);
-
-        if (tokens.size() == LocalCache::BLOCK_SIZE) {
-            // caso: 16 tokens “ab cd ef …”
-            for (auto& bs : tokens) {
-                uint32_t val = 0;
-                auto [ptr, ec] = std::from_chars(bs.data(),
-                                                bs.data() + bs.size(),
-                                                val,
-                                                16);
-                if (ec != std::errc() || ptr != bs.data() + bs.size()) {
-                    throw std::runtime_error(
-                        "Token hex inválido en línea " +
-                        std::to_string(start_line + ln) +
-                        ": \"" + bs + "\""
-                    );
-                }
-                bytes.push_back(static_cast<uint8_t>(val));
-            }
-        } else {
-            // caso: 32 dígitos contiguos “c80b…”
-            std::string raw;
-            raw.reserve(line.size());
-            for (char c : line) {
-                if (!std::isspace(static_cast<unsigned char>(c)))
-                    raw.push_back(c);
+void LocalCache::fill_lines(uint64_t address,
+                            const std::vector<std::vector<uint8_t>>& blocks,
+                            bool shared) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    with_line_geometry(config_.line_size, [&](auto geo) {
+        fill_lines_with(geo, address, blocks, shared);
+    });
+}
+
+template <typename LineGeo>
+void LocalCache::fill_lines_with(const LineGeo& geo, uint64_t address,
+                                 const std::vector<std::vector<uint8_t>>& blocks,
+                                 bool shared) {
+    if (address % geo.words() != 0) {
+        throw std::invalid_argument(
+            "LocalCache::fill_lines: dirección no alineada a línea: " + std::to_string(address));
+    }
+
+    uint64_t first_line = geo.line_of_word(address);
+    size_t   num_lines  = blocks.size() / geo.blocks();
+
+    for (size_t i = 0; i < num_lines; ++i) {
+        uint64_t line = first_line + i;
+        uint32_t set  = static_cast<uint32_t>(line % config_.sets);
+        uint64_t tag  = line / config_.sets;
+
+        // Si la línea ya está (p. ej. dos misses en vuelo a la misma), se reutiliza su vía
+        int found = tags_.lookup(set, tag);
+        uint32_t way = found >= 0 ? static_cast<uint32_t>(found) : replacement_way(set);
+        size_t frame = static_cast<size_t>(set) * config_.ways + way;
+        MesiState previous = state_.load(frame);
+        if (found >= 0 && previous == MesiState::MODIFIED) {
+            // La copia sucia es más nueva que la respuesta
+            tags_.touch(set, way);
+            continue;
+        }
+        if (found < 0 && previous != MesiState::INVALID) {
+            ++stats_.evictions;
+            if (previous == MesiState::MODIFIED) {
+                buffer_victim(frame);
             }
-            if (raw.size() != LocalCache::BLOCK_SIZE * 2) {
-                throw std::runtime_error(
-                    "Formato inesperado en línea " +
-                    std::to_string(start_line + ln)
+        }
+        tags_.fill(set, way, tag);
+        ++stats_.fills;
+
+        // Copia los bloques de la línea al frame (geo.blocks() es constante en el camino rápido)
+        for (uint32_t b = 0; b < geo.blocks(); ++b) {
+            const auto& bytes = blocks[i * geo.blocks() + b];
+            if (bytes.size() != BLOCK_SIZE) {
+                throw std::invalid_argument(
+                "LocalCache::fill_lines: cada bloque debe tener " +
+                std::to_string(BLOCK_SIZE) + " bytes"
                 );
             }
-            for (size_t i = 0; i < raw.size(); i += 2) {
-                uint32_t val = 0;
-                auto [ptr, ec] = std::from_chars(raw.data() + i,
-                                                raw.data() + i + 2,
-                                                val,
-                                                16);
-                if (ec != std::errc() || ptr != raw.data() + i + 2) {
-                    throw std::runtime_error(
-                        "Hex inválido en línea " +
-                        std::to_string(start_line + ln)
-                    );
-                }
-                bytes.push_back(static_cast<uint8_t>(val));
-            }
+            std::copy_n(bytes.begin(), BLOCK_SIZE,
+                        cache_data[frame * geo.blocks() + b].begin());
         }
+        state_.store(frame, shared ? MesiState::SHARED : MesiState::EXCLUSIVE);
+    }
+}
+
+std::vector<std::vector<uint8_t>> LocalCache::read_lines(uint32_t start_line,
+                                                         uint32_t num_lines) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (static_cast<size_t>(start_line) + num_lines > cache_data.size()) {
+        throw std::out_of_range(
+            "LocalCache::read_lines: líneas " + std::to_string(start_line) + ".." +
+            std::to_string(start_line + num_lines) + " fuera de rango (" +
+            std::to_string(cache_data.size()) + " bloques)"
+        );
+    }
+
+    std::vector<std::vector<uint8_t>> result;
+    result.reserve(num_lines);
+    for (uint32_t ln = 0; ln < num_lines; ++ln) {
+        const auto& block = cache_data[start_line + ln];
+        result.emplace_back(block.begin(), block.end());
+    }
+    return result;
+}
 
-        result.push_back(std::move(bytes));
+void LocalCache::invalidate_line(uint32_t line_index, int pe_id) {
+    // Validar índice
+    if (static_cast<size_t>(line_index) >= state_.size()) {
+        std::cerr << "[LocalCache] PE " << pe_id << ": índice de línea inválido: "
+                  << line_index << "\n";
+        return;
     }
 
+    // El frame pasa a I: el próximo acceso a esa dirección es un miss.
+    // Solo cambia el estado (atómico); el tag se queda, find_frame lo ignora y
+    // replacement_way reutiliza el frame antes de desalojar una línea viva.
+    if (config_.write_policy == WritePolicy::WRITE_BACK) {
+        // Los datos sucios no se pierden: van al buffer de writeback
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (state_.load(line_index) == MesiState::MODIFIED) {
+            buffer_victim(line_index);
+        }
+        invalidate_frame(line_index);
+    } else {
+        invalidate_frame(line_index);
+    }
+
+    std::cout << "[LocalCache] Línea " << line_index << " invalidada exitosamente.\n";
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ---------------------------------------- Coherence ------------------------------------------ */
+
+SnoopResult LocalCache::snoop_read(uint64_t address, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    SnoopResult result;
+
+    uint64_t first_line, last_line;
+    line_range(address, size, first_line, last_line);
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        int64_t frame = find_frame(line);
+        if (frame < 0) continue;
+
+        ++result.present;
+        if (state_.load(static_cast<size_t>(frame)) == MesiState::MODIFIED) {
+            result.dirty.push_back(frame_writeback(static_cast<size_t>(frame)));
+            ++stats_.writebacks;
+        }
+        if (state_.downgrade(static_cast<size_t>(frame))) {
+            ++result.downgraded;
+        }
+    }
+    take_buffered_lines(first_line, last_line, result.dirty);
     return result;
 }
 
-void LocalCache::write_cache_lines(uint32_t id, uint32_t start_line,
-                                    const std::vector<std::vector<uint8_t>>& lines) {
-    // 1) Ruta al fichero
-    std::string filename = "config/caches/cache_" + std::to_string(id) + ".txt";
+bool LocalCache::supply_lines(uint64_t address, uint32_t size,
+                              std::vector<std::vector<uint8_t>>& blocks) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (address % Geometry::BLOCK_WORDS != 0) {
+        return false;
+    }
+    return with_line_geometry(config_.line_size, [&](auto geo) {
+        return supply_lines_with(geo, address, size, blocks);
+    });
+}
 
-    // 2) Leer todo el fichero en memoria
-    std::ifstream infile(filename);
-    if (!infile.is_open()) {
-        throw std::runtime_error("No se pudo abrir el archivo " + filename);
+template <typename LineGeo>
+bool LocalCache::supply_lines_with(const LineGeo& geo, uint64_t address, uint32_t size,
+                                   std::vector<std::vector<uint8_t>>& blocks) const {
+    uint64_t first_block = address / Geometry::BLOCK_WORDS;
+    size_t   num_blocks  = (static_cast<size_t>(size) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<std::vector<uint8_t>> result;
+    result.reserve(num_blocks);
+
+    for (size_t b = 0; b < num_blocks; ++b) {
+        uint64_t block_index = first_block + b;
+        int64_t  frame = find_frame(block_index / geo.blocks());
+        if (frame < 0) {
+            return false;
+        }
+        size_t block = static_cast<size_t>(frame) * geo.blocks() + block_index % geo.blocks();
+        result.emplace_back(cache_data[block].begin(), cache_data[block].end());
     }
-    std::vector<std::string> file_lines;
-    std::string line;
-    while (std::getline(infile, line)) {
-        file_lines.push_back(line);
+
+    blocks = std::move(result);
+    return true;
+}
+
+SnoopResult LocalCache::snoop_write(uint64_t address, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    SnoopResult result;
+
+    uint64_t first_line, last_line;
+    line_range(address, size, first_line, last_line);
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        int64_t frame = find_frame(line);
+        if (frame < 0) continue;
+
+        ++result.present;
+        ++result.invalidated;
+        if (state_.load(static_cast<size_t>(frame)) == MesiState::MODIFIED) {
+            result.dirty.push_back(frame_writeback(static_cast<size_t>(frame)));
+            ++stats_.writebacks;
+        }
+        tags_.invalidate(static_cast<uint32_t>(frame / config_.ways),
+                         static_cast<uint32_t>(frame % config_.ways));
+        invalidate_frame(static_cast<size_t>(frame));
     }
-    infile.close();
+    take_buffered_lines(first_line, last_line, result.dirty);
+    return result;
+}
 
-    // 3) Validar rango
-    if (start_line >= file_lines.size() ||
-        start_line + lines.size() > file_lines.size()) {
-        throw std::out_of_range(
-        "LocalCache::write_cache_lines: líneas fuera de rango"
-        );
+SnoopResult LocalCache::apply_write(uint64_t address,
+                                    const std::vector<std::vector<uint8_t>>& blocks) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    SnoopResult result;
+
+    // Cada bloque escrito cae en una línea del caché; se copia si el escritor la tiene
+    uint64_t first_byte = address * 4;
+    uint64_t counted_line = UINT64_MAX;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        uint64_t byte  = first_byte + b * BLOCK_SIZE;
+        uint64_t line  = byte / config_.line_size;
+        int64_t  frame = find_frame(line);
+        if (frame < 0) continue;
+
+        if (line != counted_line) {
+            counted_line = line;
+            ++result.present;
+            if (state_.upgrade(static_cast<size_t>(frame))) {
+                ++result.upgraded;
+            }
+        }
+
+        // Solo se copian bloques completos alineados dentro de la línea; si no,
+        // la copia local quedaría distinta de la memoria y se invalida
+        if (byte % BLOCK_SIZE != 0 || blocks[b].size() != BLOCK_SIZE) {
+            for (uint64_t touched : {line, (byte + BLOCK_SIZE - 1) / config_.line_size}) {
+                int64_t stale = find_frame(touched);
+                if (stale < 0) continue;
+                if (state_.load(static_cast<size_t>(stale)) == MesiState::MODIFIED) {
+                    result.dirty.push_back(frame_writeback(static_cast<size_t>(stale)));
+                    ++stats_.writebacks;
+                }
+                tags_.invalidate(static_cast<uint32_t>(stale / config_.ways),
+                                 static_cast<uint32_t>(stale % config_.ways));
+                invalidate_frame(static_cast<size_t>(stale));
+            }
+            continue;
+        }
+        size_t block = static_cast<size_t>(frame) * blocks_per_line_
+                     + (byte % config_.line_size) / BLOCK_SIZE;
+        std::copy(blocks[b].begin(), blocks[b].end(), cache_data[block].begin());
     }
 
-    // 4) Reemplazar cada línea por la nueva
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const auto& bytes = lines[i];
-        if (bytes.size() != BLOCK_SIZE) {
-            throw std::invalid_argument(
-            "LocalCache::write_cache_lines: cada línea debe tener " +
-            std::to_string(BLOCK_SIZE) + " bytes"
-            );
+    // Los writebacks pendientes del propio escritor llegan a memoria antes que su escritura
+    if (!blocks.empty()) {
+        uint64_t first_line, last_line;
+        line_range(address, static_cast<uint32_t>(blocks.size() * BLOCK_SIZE), first_line, last_line);
+        take_buffered_lines(first_line, last_line, result.dirty);
+    }
+    return result;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ---------------------------------------- Write-back ----------------------------------------- */
+
+bool LocalCache::absorb_write(uint64_t address, const std::vector<std::vector<uint8_t>>& blocks) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    uint64_t bytes = static_cast<uint64_t>(blocks.size()) * BLOCK_SIZE;
+
+    // Solo bloques completos sobre líneas propias (E/M); lo demás va al Interconnect
+    bool local = config_.write_policy == WritePolicy::WRITE_BACK && !blocks.empty()
+              && address % Geometry::BLOCK_WORDS == 0;
+    uint64_t first_line = 0, last_line = 0;
+    std::vector<size_t> frames;
+    if (local) {
+        line_range(address, static_cast<uint32_t>(bytes), first_line, last_line);
+        for (uint64_t line = first_line; line <= last_line && local; ++line) {
+            int64_t frame = find_frame(line);
+            local = frame >= 0 && state_.load(static_cast<size_t>(frame)) != MesiState::SHARED;
+            if (local) frames.push_back(static_cast<size_t>(frame));
         }
-        std::ostringstream oss;
-        for (uint8_t b : bytes) {
-            oss << std::hex << std::setw(2) << std::setfill('0')
-            << static_cast<int>(b);
+        for (const auto& block : blocks) {
+            local = local && block.size() == BLOCK_SIZE;
         }
-        file_lines[start_line + i] = oss.str();
     }
 
-    // 5) Volcar de nuevo al disco
-    std::ofstream outfile(filename, std::ios::trunc);
-    if (!outfile.is_open()) {
-        throw std::runtime_error("No se pudo escribir en el archivo " + filename);
+    if (!local) {
+        ++stats_.writes_sent;
+        stats_.write_bytes_sent += bytes;
+        return false;
     }
-    for (const auto& l : file_lines) {
-        outfile << l << "\n";
+
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        uint64_t byte  = address * 4 + b * BLOCK_SIZE;
+        size_t   frame = frames[byte / config_.line_size - first_line];
+        size_t   block = frame * blocks_per_line_ + (byte % config_.line_size) / BLOCK_SIZE;
+        std::copy(blocks[b].begin(), blocks[b].end(), cache_data[block].begin());
+    }
+    for (size_t frame : frames) {
+        state_.modify(frame);
+        tags_.touch(static_cast<uint32_t>(frame / config_.ways),
+                    static_cast<uint32_t>(frame % config_.ways));
     }
-    outfile.close();
+
+    ++stats_.writes_absorbed;
+    stats_.write_bytes_absorbed += bytes;
+    return true;
 }
 
-void LocalCache::invalidate_line(uint32_t line_index, int pe_id) {
-    // Leer todas las líneas del archivo de invalidación
-    std::string inv_path = "config/caches/inv_cache_" + std::to_string(pe_id) + ".txt";
-    std::ifstream infile(inv_path);
-    if (!infile.is_open()) {
-        std::cerr << "[LocalCache] No se pudo abrir " << inv_path << " para lectura.\n";
-        return;
+std::vector<uint64_t> LocalCache::take_evicted() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<uint64_t> addresses;
+    addresses.reserve(evicted_.size());
+    for (uint64_t line : evicted_) {
+        addresses.push_back(line_address(line));
     }
+    evicted_.clear();
+    return addresses;
+}
 
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(infile, line)) {
-        lines.push_back(line);
+bool LocalCache::take_writeback(uint64_t address, std::vector<std::vector<uint8_t>>& blocks) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = writeback_buffer_.find(line_of(address));
+    if (it == writeback_buffer_.end()) {
+        return false;
     }
-    infile.close();
+    blocks = std::move(it->second);
+    writeback_buffer_.erase(it);
+    ++stats_.writebacks;
+    return true;
+}
 
-    // Validar índice
-    if (line_index < 0 || static_cast<size_t>(line_index) >= lines.size()) {
-        std::cerr << "[LocalCache] Índice de línea inválido: " << line_index << "\n";
-        return;
+std::vector<Writeback> LocalCache::take_buffered(uint64_t address, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<Writeback> out;
+    uint64_t first_line, last_line;
+    line_range(address, size, first_line, last_line);
+    take_buffered_lines(first_line, last_line, out);
+    return out;
+}
+
+std::vector<Writeback> LocalCache::flush_dirty() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<Writeback> out;
+    for (size_t frame = 0; frame < state_.size(); ++frame) {
+        if (state_.load(frame) != MesiState::MODIFIED) continue;
+        out.push_back(frame_writeback(frame));
+        state_.clean(frame);
+        ++stats_.writebacks;
     }
+    take_buffered_lines(0, UINT64_MAX, out);
+    evicted_.clear();
+    return out;
+}
 
-    // Cambiar la línea a "1"
-    lines[line_index] = "1";
+MesiState LocalCache::get_state(uint32_t frame) const {
+    if (frame >= state_.size()) {
+        throw std::out_of_range("LocalCache::get_state: frame fuera de rango");
+    }
+    return state_.load(frame);
+}
 
-    // Reescribir el archivo completo con la línea actualizada
-    std::ofstream outfile(inv_path);
-    if (!outfile.is_open()) {
-        std::cerr << "[LocalCache] No se pudo abrir " << inv_path << " para escritura.\n";
-        return;
+char LocalCache::state_to_char(MesiState state) {
+    switch (state) {
+        case MesiState::MODIFIED:  return 'M';
+        case MesiState::EXCLUSIVE: return 'E';
+        case MesiState::SHARED:    return 'S';
+        case MesiState::INVALID:
+        default:                   return 'I';
+    }
+}
+
+void LocalCache::line_range(uint64_t address, uint32_t size,
+                            uint64_t& first, uint64_t& last) const {
+    uint64_t first_byte = address * 4;
+    uint64_t last_byte  = first_byte + std::max<uint32_t>(size, 1) - 1;
+    first = first_byte / config_.line_size;
+    last  = last_byte / config_.line_size;
+}
+
+int64_t LocalCache::find_frame(uint64_t line) const {
+    uint32_t set = static_cast<uint32_t>(line % config_.sets);
+    int way = tags_.lookup(set, line / config_.sets);
+    if (way < 0) return -1;
+
+    // Un INV_LINE deja el tag pero pone el estado en I
+    int64_t frame = static_cast<int64_t>(set) * config_.ways + way;
+    if (state_.load(static_cast<size_t>(frame)) == MesiState::INVALID) return -1;
+    return frame;
+}
+
+void LocalCache::invalidate_frame(size_t frame) {
+    if (state_.invalidate(frame) != MesiState::INVALID) {
+        invalidations_.fetch_add(1, std::memory_order_relaxed);
     }
+}
 
-    for (const auto& l : lines) {
-        outfile << l << "\n";
+uint32_t LocalCache::replacement_way(uint32_t set) {
+    // Un frame invalidado queda libre: reutilizarlo no desaloja ninguna copia viva
+    size_t base = static_cast<size_t>(set) * config_.ways;
+    for (uint32_t way = 0; way < config_.ways; ++way) {
+        if (state_.load(base + way) == MesiState::INVALID) return way;
     }
+    return tags_.victim(set);
+}
 
-    std::cout << "[LocalCache] Línea " << line_index << " invalidada exitosamente.\n";
+uint64_t LocalCache::line_of_frame(size_t frame) const {
+    uint32_t set = static_cast<uint32_t>(frame / config_.ways);
+    uint32_t way = static_cast<uint32_t>(frame % config_.ways);
+    return tags_.get_tag(set, way) * config_.sets + set;
+}
+
+Writeback LocalCache::frame_writeback(size_t frame) const {
+    Writeback wb;
+    wb.address = line_address(line_of_frame(frame));
+    wb.blocks.reserve(blocks_per_line_);
+    for (uint32_t b = 0; b < blocks_per_line_; ++b) {
+        const auto& block = cache_data[frame * blocks_per_line_ + b];
+        wb.blocks.emplace_back(block.begin(), block.end());
+    }
+    return wb;
+}
+
+void LocalCache::buffer_victim(size_t frame) {
+    uint64_t line = line_of_frame(frame);
+    writeback_buffer_[line] = frame_writeback(frame).blocks;
+    evicted_.push_back(line);
+}
+
+void LocalCache::take_buffered_lines(uint64_t first, uint64_t last, std::vector<Writeback>& out) {
+    auto it = writeback_buffer_.lower_bound(first);
+    while (it != writeback_buffer_.end() && it->first <= last) {
+        out.push_back({line_address(it->first), std::move(it->second)});
+        it = writeback_buffer_.erase(it);
+        ++stats_.writebacks;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ----------------------------------- Getters & Setters --------------------------------------- */
+
+const CacheConfig& LocalCache::get_config() const {
+    return config_;
+}
+
+CacheStats LocalCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    CacheStats stats = stats_;
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint32_t LocalCache::frames() const {
+    return config_.sets * config_.ways;
+}
+
+uint32_t LocalCache::blocks() const {
+    return static_cast<uint32_t>(cache_data.size());
+}
+
+bool LocalCache::contains_line(uint64_t line) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return find_frame(line) >= 0;
+}
+
+uint64_t LocalCache::line_address(uint64_t line) const {
+    return line * config_.line_size / 4;
+}
+
+uint64_t LocalCache::line_of(uint64_t address) const {
+    return address * 4 / config_.line_size;
+}
+
+Prefetcher* LocalCache::get_prefetcher() {
+    return prefetcher_.get();
+}
+
+const Prefetcher* LocalCache::get_prefetcher() const {
+    return prefetcher_.get();
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -290,7 +727,7 @@ void LocalCache::read_test(uint32_t start_line, uint32_t num_lines) const {
               << ": reading lines " << start_line
               << " to " << (start_line + num_lines - 1)
               << "\n";
-    if (start_line >= BLOCKS || start_line + num_lines > BLOCKS) {
+    if (start_line >= blocks() || start_line + num_lines > blocks()) {
         throw std::out_of_range(
             "LocalCache::read: rango fuera de límites");
     }
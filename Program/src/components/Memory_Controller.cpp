@@ -0,0 +1,161 @@
+#include "../../include/components/Memory_Controller.h"
+#include "../../include/Config_File.h"
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+ControllerConfig ControllerConfig::load_from_file(const std::string& filename) {
+    ConfigFile cfg(filename);
+    ControllerConfig config;
+
+    if (!cfg.is_loaded()) {
+        return config;  // MemoryConfig ya avisa que no se pudo abrir
+    }
+
+    std::string policy = cfg.get_string("mc_policy", "off");
+    if (policy == "off") {
+        config.enabled = false;
+    } else if (policy == "fcfs") {
+        config.enabled = true;
+        config.policy  = SchedulePolicy::FCFS;
+    } else if (policy == "frfcfs") {
+        config.enabled = true;
+        config.policy  = SchedulePolicy::FR_FCFS;
+    } else if (policy == "qos_frfcfs") {
+        config.enabled = true;
+        config.policy  = SchedulePolicy::QOS_FR_FCFS;
+    } else {
+        throw std::invalid_argument(filename + ": mc_policy debe ser off, fcfs, frfcfs o qos_frfcfs: " + policy);
+    }
+
+    config.read_queue  = static_cast<uint32_t>(cfg.get_int("mc_read_queue", config.read_queue));
+    config.write_queue = static_cast<uint32_t>(cfg.get_int("mc_write_queue", config.write_queue));
+    config.write_high  = static_cast<uint32_t>(cfg.get_int("mc_write_high", config.write_high));
+    config.write_low   = static_cast<uint32_t>(cfg.get_int("mc_write_low", config.write_low));
+    config.max_age     = static_cast<uint32_t>(cfg.get_int("mc_max_age", config.max_age));
+
+    if (config.read_queue == 0 || config.write_queue == 0) {
+        throw std::invalid_argument(filename + ": mc_read_queue y mc_write_queue deben ser mayores que 0");
+    }
+    if (config.write_high == 0 || config.write_high > config.write_queue || config.write_low >= config.write_high) {
+        throw std::invalid_argument(filename + ": se requiere mc_write_low < mc_write_high <= mc_write_queue");
+    }
+    return config;
+}
+
+std::string ControllerConfig::policy_to_string(SchedulePolicy policy) {
+    switch (policy) {
+        case SchedulePolicy::FCFS:        return "fcfs";
+        case SchedulePolicy::FR_FCFS:     return "frfcfs";
+        case SchedulePolicy::QOS_FR_FCFS: return "qos_frfcfs";
+    }
+    return "unknown";
+}
+
+MemoryController::MemoryController(const ControllerConfig& config, const SharedMemory& memory)
+    : config_(config), memory_(memory) {}
+
+bool MemoryController::can_accept(bool write) const {
+    return write ? writes_.size() < config_.write_queue : reads_.size() < config_.read_queue;
+}
+
+void MemoryController::enqueue(MemoryRequest request) {
+    if (request.write) {
+        writes_.push_back(std::move(request));
+        stats_.max_writes = std::max(stats_.max_writes, writes_.size());
+    } else {
+        reads_.push_back(std::move(request));
+        stats_.max_reads = std::max(stats_.max_reads, reads_.size());
+    }
+}
+
+void MemoryController::record_full_stall() {
+    ++stats_.full_stalls;
+}
+
+bool MemoryController::empty() const {
+    return reads_.empty() && writes_.empty();
+}
+
+void MemoryController::update_drain_mode() {
+    if (!draining_) {
+        // Lote de escrituras: la cola llegó al umbral, o no hay lecturas que atender
+        if (writes_.size() >= config_.write_high || (reads_.empty() && !writes_.empty())) {
+            draining_ = true;
+            ++stats_.drains;
+        }
+    } else if (writes_.empty() || (writes_.size() <= config_.write_low && !reads_.empty())) {
+        draining_ = false;
+    }
+}
+
+long MemoryController::select(const std::deque<MemoryRequest>& queue, uint64_t now,
+                              bool& row_hit, bool& aged) const {
+    if (queue.empty()) return -1;
+
+    // FCFS: solo la más antigua, y espera a que sus bancos queden libres
+    if (config_.policy == SchedulePolicy::FCFS) {
+        const MemoryRequest& head = queue.front();
+        if (!memory_.banks_free(head.first_word, head.words, now)) return -1;
+        row_hit = memory_.rows_open(head.first_word, head.words);
+        aged    = false;
+        return 0;
+    }
+
+    // FR-FCFS: la cola está en orden de llegada, así que a igualdad gana la primera
+    long best = -1;
+    std::tuple<bool, int, bool> best_key{false, -1, false};
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const MemoryRequest& req = queue[i];
+        if (!memory_.banks_free(req.first_word, req.words, now)) continue;
+
+        bool old = config_.max_age != 0 && now - req.arrival >= config_.max_age;
+        int  qos = config_.policy == SchedulePolicy::QOS_FR_FCFS ? req.qos : 0;
+        bool hit = memory_.rows_open(req.first_word, req.words);
+        std::tuple<bool, int, bool> key{old, qos, hit};
+        if (best < 0 || key > best_key) {
+            best     = static_cast<long>(i);
+            best_key = key;
+        }
+    }
+    if (best >= 0) {
+        aged    = std::get<0>(best_key);
+        row_hit = std::get<2>(best_key);
+    }
+    return best;
+}
+
+bool MemoryController::dispatch(uint64_t now, MemoryRequest& issued) {
+    update_drain_mode();
+    std::deque<MemoryRequest>& queue = draining_ ? writes_ : reads_;
+
+    bool row_hit = false;
+    bool aged    = false;
+    long index   = select(queue, now, row_hit, aged);
+    if (index < 0) return false;
+
+    issued = std::move(queue[static_cast<size_t>(index)]);
+    queue.erase(queue.begin() + index);
+
+    // La espera en cola ya transcurrió: cuenta en la latencia total, no en la que falta
+    uint64_t wait    = now - issued.arrival;
+    std::vector<uint32_t> service = issued.issue();
+    for (size_t i = 0; i < issued.responses.size(); ++i) {
+        issued.responses[i].increment_full_latency(static_cast<uint32_t>(wait) + service[i]);
+        issued.responses[i].increment_latency(service[i]);
+    }
+
+    if (issued.write) {
+        ++stats_.writes;
+        stats_.write_wait += wait;
+    } else {
+        ++stats_.reads;
+        stats_.read_wait += wait;
+    }
+    if (row_hit) ++stats_.row_hit_issues;
+    if (aged) ++stats_.aged_issues;
+    auto& per_qos = stats_.qos_wait[issued.qos];
+    ++per_qos.first;
+    per_qos.second += wait;
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "../../include/components/Mesi_State_Array.h"
+
+/** @brief Palabra que guarda el frame. */
+static size_t word_of(size_t frame) {
+    return frame / MesiStateArray::STATES_PER_WORD;
+}
+
+/** @brief Desplazamiento de los 2 bits del frame dentro de su palabra. */
+static unsigned shift_of(size_t frame) {
+    return static_cast<unsigned>(frame % MesiStateArray::STATES_PER_WORD) * 2;
+}
+
+MesiStateArray::MesiStateArray(size_t frames)
+    : frames_(frames),
+      words_(new std::atomic<uint64_t>[(frames + STATES_PER_WORD - 1) / STATES_PER_WORD]) {
+    for (size_t w = 0; w < (frames_ + STATES_PER_WORD - 1) / STATES_PER_WORD; ++w) {
+        words_[w].store(0, std::memory_order_relaxed);
+    }
+}
+
+MesiState MesiStateArray::load(size_t frame) const {
+    uint64_t word = words_[word_of(frame)].load(std::memory_order_acquire);
+    return static_cast<MesiState>((word >> shift_of(frame)) & 0b11);
+}
+
+void MesiStateArray::store(size_t frame, MesiState state) {
+    transition(frame, [](MesiState) { return true; }, state);
+}
+
+MesiState MesiStateArray::invalidate(size_t frame) {
+    uint64_t mask = 0b11ULL << shift_of(frame);
+    uint64_t prev = words_[word_of(frame)].fetch_and(~mask, std::memory_order_acq_rel);
+    return static_cast<MesiState>((prev >> shift_of(frame)) & 0b11);
+}
+
+bool MesiStateArray::downgrade(size_t frame) {
+    return transition(frame, [](MesiState s) {
+        return s == MesiState::EXCLUSIVE || s == MesiState::MODIFIED;
+    }, MesiState::SHARED);
+}
+
+bool MesiStateArray::upgrade(size_t frame) {
+    return transition(frame, [](MesiState s) { return s == MesiState::SHARED; },
+                      MesiState::EXCLUSIVE);
+}
+
+bool MesiStateArray::modify(size_t frame) {
+    return transition(frame, [](MesiState s) {
+        return s == MesiState::EXCLUSIVE || s == MesiState::MODIFIED;
+    }, MesiState::MODIFIED);
+}
+
+bool MesiStateArray::clean(size_t frame) {
+    return transition(frame, [](MesiState s) { return s == MesiState::MODIFIED; },
+                      MesiState::EXCLUSIVE);
+}
+
+size_t MesiStateArray::size() const {
+    return frames_;
+}
+
+template <typename Pred>
+bool MesiStateArray::transition(size_t frame, Pred from, MesiState to) {
+    std::atomic<uint64_t>& word = words_[word_of(frame)];
+    unsigned shift = shift_of(frame);
+    uint64_t mask  = 0b11ULL << shift;
+
+    uint64_t current = word.load(std::memory_order_acquire);
+    do {
+        if (!from(static_cast<MesiState>((current >> shift) & 0b11))) {
+            return false;
+        }
+    } while (!word.compare_exchange_weak(
+                 current, (current & ~mask) | (static_cast<uint64_t>(to) << shift),
+                 std::memory_order_acq_rel, std::memory_order_acquire));
+    return true;
+}
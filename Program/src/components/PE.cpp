@@ -1,11 +1,16 @@
 #include "../../include/components/PE.h"
+#include "../../include/Instruction_Format.h"
 #include <iostream>
 #include <bitset>
+#include <algorithm>
+#include <stdexcept>
 
-PE::PE(int id, uint8_t qos)
+PE::PE(int id, uint8_t qos, size_t max_outstanding)
     : instruction_memory_(id), id_(id), qos_(qos), pc_(0), actual_instruction_(0), 
-    actual_message_(Operation::UNDEFINED, id, -1, 0, qos, 0, 0, 0, 0, 0, {}) {
-    std::cout << "\n[PE] Created PE " << id_ << " with QoS=" << static_cast<int>(qos_) << "\n";
+    actual_message_(Operation::UNDEFINED, id, -1, 0, qos, 0, 0, 0, 0, 0, {}),
+    max_outstanding_(std::max<size_t>(1, max_outstanding)) {
+    std::cout << "\n[PE] Created PE " << id_ << " with QoS=" << static_cast<int>(qos_)
+              << ", max_outstanding=" << max_outstanding_ << "\n";
     // Inicializa el instruction memory de una vez
     instruction_memory_.initialize();
 }
@@ -16,46 +21,83 @@ void PE::pc_plus_4() {
 }
 
 Message PE::convert_to_message(int instruction_index) {
-    std::string bin = instruction_memory_.get_instruction(instruction_index);
-    uint64_t instr = std::bitset<64>(bin).to_ullong();
-    
-    Message msg(Operation::UNDEFINED);
-
-    uint8_t opcode = (instr >> 41) & 0b11;
-    msg.set_src_id((instr >> 36) & 0b11111);
-
-    switch (opcode) {
-        case 0b00: // WRITE_MEM
-            msg.set_operation(Operation::WRITE_MEM);
-            msg.set_address((instr >> 20) & 0xFFFF);
-            msg.set_num_lines((instr >> 12) & 0xFF);
-            msg.set_start_line((instr >> 4) & 0xFF);
-            msg.set_qos(qos_);
-            break;
-            
-
-        case 0b01: // READ_MEM
-            msg.set_operation(Operation::READ_MEM);
-            msg.set_address((instr >> 20) & 0xFFFF);
-            msg.set_size((instr >> 12) & 0xFF);
-            msg.set_qos(qos_);
-            break;
-            
-
-        case 0b10: // BROADCAST_INVALIDATE
-            msg.set_operation(Operation::BROADCAST_INVALIDATE);
-            msg.set_cache_line((instr >> 20) & 0xFF);
-            msg.set_qos(qos_); 
-            break;
-
-        default:
-            msg.set_operation(Operation::UNDEFINED);  
-            break; 
-
+    // La instrucción ya está en memoria como entero: se decodifica sin pasar por texto
+    uint64_t instr = instruction_memory_.fetch_instruction(static_cast<size_t>(instruction_index));
+    DecodedInstruction decoded = InstructionFormat::decode(instr);
+
+    // Los operandos que la operación no tiene valen 0, igual que en el Message por defecto
+    Message msg(decoded.operation);
+    msg.set_src_id(static_cast<int>(decoded.get(Operand::SRC)));
+    msg.set_address(decoded.get(Operand::ADDRESS));
+    msg.set_size(static_cast<uint32_t>(decoded.get(Operand::READ_SIZE)));
+    msg.set_num_lines(static_cast<uint32_t>(decoded.get(Operand::LINE_COUNT)));
+    msg.set_start_line(static_cast<uint32_t>(decoded.get(Operand::START_LINE)));
+    msg.set_cache_line(static_cast<uint32_t>(decoded.get(Operand::CACHE_LINE)));
+    if (decoded.operation != Operation::UNDEFINED) {
+        msg.set_qos(qos_);   // el QoS del PE (config/qos.txt), no el de la instrucción
+    }
     return msg;
+}
+
+/* ------------------------------------ Outstanding Requests ----------------------------------- */
+
+bool PE::can_issue() const {
+    return mshr_.size() < max_outstanding_;
+}
+
+uint32_t PE::track_request(Message& msg) {
+    if (!can_issue()) {
+        throw std::runtime_error("PE " + std::to_string(id_) + ": ventana de peticiones llena");
     }
+
+    uint32_t tag = next_tag_++;
+    if (next_tag_ == 0) next_tag_ = 1;  // El 0 queda reservado para "sin tag"
+
+    uint64_t address = msg.get_operation() == Operation::BROADCAST_INVALIDATE
+        ? msg.get_cache_line()
+        : msg.get_address();
+    msg.set_tag(tag);
+    mshr_.push_back({tag, msg.get_operation(), address});
+
+    ++mshr_stats_.issued;
+    mshr_stats_.max_outstanding = std::max(mshr_stats_.max_outstanding, mshr_.size());
+    return tag;
 }
 
+bool PE::complete_request(uint32_t tag) {
+    auto it = std::find_if(mshr_.begin(), mshr_.end(),
+                           [tag](const MSHREntry& e) { return e.tag == tag; });
+    if (it == mshr_.end()) {
+        return false;
+    }
+
+    // Si no es la más vieja, la respuesta se adelantó a otra petición
+    if (it != mshr_.begin()) {
+        ++mshr_stats_.out_of_order;
+    }
+    mshr_.erase(it);
+    ++mshr_stats_.completed;
+    return true;
+}
+
+size_t PE::outstanding() const {
+    return mshr_.size();
+}
+
+size_t PE::get_max_outstanding() const {
+    return max_outstanding_;
+}
+
+void PE::record_window_full() {
+    ++mshr_stats_.window_full_steps;
+}
+
+const MSHRStats& PE::get_mshr_stats() const {
+    return mshr_stats_;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 /* ----------------------------------- Getters & Setters --------------------------------------- */
 
 int PE::get_id() const {
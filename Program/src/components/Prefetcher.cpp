@@ -0,0 +1,116 @@
+#include "../../include/components/Prefetcher.h"
+#include "../../include/Config_File.h"
+#include <stdexcept>
+
+PrefetchConfig PrefetchConfig::from_config(const ConfigFile& cfg) {
+    PrefetchConfig config;
+
+    std::string mode = cfg.get_string("prefetch", "off");
+    if (mode == "off") {
+        config.mode = PrefetchMode::OFF;
+    } else if (mode == "next_line") {
+        config.mode = PrefetchMode::NEXT_LINE;
+    } else if (mode == "stride") {
+        config.mode = PrefetchMode::STRIDE;
+    } else {
+        throw std::invalid_argument(cfg.path() + ": prefetch debe ser 'off', 'next_line' o 'stride': " + mode);
+    }
+
+    config.degree       = static_cast<uint32_t>(cfg.get_int("prefetch_degree", config.degree));
+    config.max_inflight = static_cast<uint32_t>(cfg.get_int("prefetch_max_inflight", config.max_inflight));
+    config.qos          = static_cast<uint8_t>(cfg.get_int("prefetch_qos", config.qos));
+
+    if (config.mode != PrefetchMode::OFF && (config.degree == 0 || config.max_inflight == 0)) {
+        throw std::invalid_argument(cfg.path() + ": prefetch_degree y prefetch_max_inflight deben ser mayores que 0");
+    }
+    return config;
+}
+
+Prefetcher::Prefetcher(const PrefetchConfig& config)
+    : config_(config) {}
+
+std::vector<uint64_t> Prefetcher::on_demand_access(uint64_t first_line, uint64_t last_line,
+                                                   uint64_t miss_first, uint64_t miss_last,
+                                                   bool miss) {
+    // 1) Exactitud: líneas de prefetch que esta lectura usó (o perdió antes de usarlas)
+    for (uint64_t line = first_line; line <= last_line; ++line) {
+        bool missed = miss && line >= miss_first && line <= miss_last;
+        if (unused_.erase(line) && !missed) {
+            ++stats_.useful;
+        }
+        if (missed && inflight_.count(line)) {
+            ++stats_.late;
+        }
+    }
+
+    // 2) Entrenamiento del detector de stride con la primera línea del acceso
+    if (has_last_) {
+        int64_t stride = static_cast<int64_t>(first_line) - static_cast<int64_t>(last_line_);
+        if (stride != 0 && stride == stride_) {
+            ++confidence_;
+        } else {
+            stride_     = stride;
+            confidence_ = 0;
+        }
+    }
+    has_last_  = true;
+    last_line_ = first_line;
+
+    // 3) Candidatos: stride estable o, si no, las N líneas que siguen al acceso
+    std::vector<uint64_t> candidates;
+    if (config_.mode == PrefetchMode::OFF) {
+        return candidates;
+    }
+
+    bool use_stride = config_.mode == PrefetchMode::STRIDE
+                   && confidence_ >= STRIDE_CONFIDENCE && stride_ != 0;
+    for (uint32_t k = 1; k <= config_.degree; ++k) {
+        if (use_stride) {
+            int64_t line = static_cast<int64_t>(first_line) + stride_ * k;
+            if (line < 0) break;
+            candidates.push_back(static_cast<uint64_t>(line));
+        } else {
+            candidates.push_back(last_line + k);
+        }
+    }
+    return candidates;
+}
+
+bool Prefetcher::can_issue(uint64_t line) const {
+    return inflight_.size() < config_.max_inflight
+        && !inflight_.count(line)
+        && !unused_.count(line);
+}
+
+void Prefetcher::on_issue(uint64_t line, uint32_t bytes) {
+    inflight_.insert(line);
+    ++stats_.issued;
+    stats_.bytes += bytes;
+}
+
+void Prefetcher::on_fill(uint64_t line) {
+    if (inflight_.erase(line)) {
+        unused_.insert(line);
+    }
+}
+
+size_t Prefetcher::inflight() const {
+    return inflight_.size();
+}
+
+const PrefetchConfig& Prefetcher::get_config() const {
+    return config_;
+}
+
+const PrefetchStats& Prefetcher::get_stats() const {
+    return stats_;
+}
+
+const char* Prefetcher::mode_to_string(PrefetchMode mode) {
+    switch (mode) {
+        case PrefetchMode::OFF:       return "off";
+        case PrefetchMode::NEXT_LINE: return "next_line";
+        case PrefetchMode::STRIDE:    return "stride";
+        default:                      return "unknown";
+    }
+}
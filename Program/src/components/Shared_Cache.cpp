@@ -0,0 +1,223 @@
+#include "../../include/components/Shared_Cache.h"
+#include "../../include/Config_File.h"
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+/** @brief true si @p value es potencia de 2 (y distinto de 0). */
+static bool is_power_of_two(uint32_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+uint32_t SharedCacheConfig::sets() const {
+    return size / (SharedCache::LINE_SIZE * ways);
+}
+
+SharedCacheConfig SharedCacheConfig::load_from_file(const std::string& filename) {
+    ConfigFile cfg(filename);
+    SharedCacheConfig config;
+
+    if (!cfg.is_loaded()) {
+        return config;  // MemoryConfig ya avisa que no se pudo abrir
+    }
+
+    config.enabled     = cfg.get_bool("l2", config.enabled);
+    config.size        = static_cast<uint32_t>(cfg.get_int("l2_size", config.size));
+    config.ways        = static_cast<uint32_t>(cfg.get_int("l2_ways", config.ways));
+    config.banks       = static_cast<uint32_t>(cfg.get_int("l2_banks", config.banks));
+    config.hit_latency = static_cast<uint32_t>(cfg.get_int("l2_hit_latency", config.hit_latency));
+    config.replacement = TagStore::parse_replacement(cfg.get_string("l2_replacement", "lru"));
+
+    if (config.ways == 0 || config.size % (SharedCache::LINE_SIZE * config.ways) != 0) {
+        throw std::invalid_argument(filename + ": l2_size debe ser múltiplo de 16 * l2_ways");
+    }
+    if (!is_power_of_two(config.sets())) {
+        throw std::invalid_argument(filename + ": l2_size / (16 * l2_ways) debe ser potencia de 2");
+    }
+    if (!is_power_of_two(config.banks) || config.banks > config.sets()) {
+        throw std::invalid_argument(filename + ": l2_banks debe ser potencia de 2 y no mayor que los conjuntos");
+    }
+    return config;
+}
+
+SharedCache::SharedCache(const SharedCacheConfig& config, SharedMemory& memory)
+    : config_(config),
+      memory_(memory),
+      tags_(config.sets(), config.ways, config.replacement, /*seed=*/0x4C32),
+      data_(static_cast<size_t>(config.sets()) * config.ways, std::vector<uint8_t>(LINE_SIZE, 0)),
+      dirty_(static_cast<size_t>(config.sets()) * config.ways, 0),
+      banks_(config.banks) {
+    std::cout << "[SharedCache] L2 de " << config_.size << " bytes: " << config_.sets()
+              << " sets x " << config_.ways << " ways, " << config_.banks << " bancos, "
+              << TagStore::replacement_to_string(config_.replacement) << "\n";
+}
+
+/* --------------------------------------- Data Handling --------------------------------------- */
+
+std::vector<std::vector<uint8_t>> SharedCache::read(size_t address, size_t size_bytes,
+                                                    SharedCacheAccess& access) {
+    size_t blocks_to_read = ((size_bytes + 3) / 4 + 3) / 4;
+    size_t words          = blocks_to_read * SharedMemory::LINE_WORDS;
+
+    // 1) Bytes de todas las líneas que toca el acceso
+    uint64_t first_line = address / SharedMemory::LINE_WORDS;
+    uint64_t end_line   = (address + words + SharedMemory::LINE_WORDS - 1) / SharedMemory::LINE_WORDS;
+    std::vector<uint8_t> span;
+    span.reserve((end_line - first_line) * LINE_SIZE);
+
+    for (uint64_t line = first_line; line < end_line; ++line) {
+        if (!in_memory(line)) {
+            // Fuera de la memoria se lee con relleno de ceros, sin ocupar el L2
+            ++stats_.bypassed;
+            auto block = memory_.read_shared_memory(line * SharedMemory::LINE_WORDS, LINE_SIZE);
+            span.insert(span.end(), block[0].begin(), block[0].end());
+            continue;
+        }
+
+        bool hit = false;
+        size_t f = find_or_allocate(line, /*fetch=*/true, hit, access);
+        hit ? ++stats_.read_hits : ++stats_.read_misses;
+        span.insert(span.end(), data_[f].begin(), data_[f].end());
+    }
+
+    // 2) Bloques de 16 bytes desde la palabra pedida
+    size_t offset = (address - first_line * SharedMemory::LINE_WORDS) * 4;
+    std::vector<std::vector<uint8_t>> result;
+    result.reserve(blocks_to_read);
+    for (size_t b = 0; b < blocks_to_read; ++b) {
+        auto begin = span.begin() + offset + b * LINE_SIZE;
+        result.emplace_back(begin, begin + LINE_SIZE);
+    }
+    return result;
+}
+
+void SharedCache::write(const std::vector<std::vector<uint8_t>>& blocks, size_t address,
+                        SharedCacheAccess& access) {
+    // Mismas validaciones que SharedMemory::write_shared_memory_lines, antes de tocar el L2
+    memory_.check_write(blocks, address);
+
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const auto& block = blocks[b];
+        size_t current_address = address + b * SharedMemory::LINE_WORDS;
+
+        // Un bloque desalineado cae en dos líneas: cada parte es una escritura parcial
+        for (size_t w = 0; w < SharedMemory::LINE_WORDS; ) {
+            uint64_t word   = current_address + w;
+            uint64_t line   = word / SharedMemory::LINE_WORDS;
+            size_t   in_off = word % SharedMemory::LINE_WORDS;
+            size_t   count  = std::min(SharedMemory::LINE_WORDS - in_off, SharedMemory::LINE_WORDS - w);
+
+            bool hit = false;
+            size_t f = find_or_allocate(line, /*fetch=*/count < SharedMemory::LINE_WORDS, hit, access);
+            hit ? ++stats_.write_hits : ++stats_.write_misses;
+
+            std::copy(block.begin() + w * 4, block.begin() + (w + count) * 4,
+                      data_[f].begin() + in_off * 4);
+            dirty_[f] = 1;
+            w += count;
+        }
+    }
+}
+
+uint64_t SharedCache::flush() {
+    uint64_t written = 0;
+    for (uint32_t set = 0; set < tags_.get_sets(); ++set) {
+        for (uint32_t way = 0; way < tags_.get_ways(); ++way) {
+            size_t f = static_cast<size_t>(set) * tags_.get_ways() + way;
+            if (!tags_.is_valid(set, way) || !dirty_[f]) continue;
+
+            uint64_t line = tags_.get_tag(set, way) * tags_.get_sets() + set;
+            memory_.write_shared_memory_lines({data_[f]}, line * SharedMemory::LINE_WORDS);
+            dirty_[f] = 0;
+            ++written;
+        }
+    }
+    stats_.writebacks += written;
+    return written;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ------------------------------------------- Banks ------------------------------------------- */
+
+uint32_t SharedCache::bank_of(uint64_t line) const {
+    return static_cast<uint32_t>(line % config_.banks);
+}
+
+uint64_t SharedCache::schedule_access(uint64_t first_word, uint64_t words, uint64_t now) {
+    std::vector<uint32_t> lines_per_bank(banks_.size(), 0);
+    uint64_t first_line = first_word / SharedMemory::LINE_WORDS;
+    uint64_t end_line   = (first_word + std::max<uint64_t>(words, 1) + SharedMemory::LINE_WORDS - 1)
+                        / SharedMemory::LINE_WORDS;
+    for (uint64_t line = first_line; line < end_line; ++line) {
+        ++lines_per_bank[bank_of(line)];
+    }
+
+    uint64_t finish = now;
+    for (size_t b = 0; b < banks_.size(); ++b) {
+        if (lines_per_bank[b] == 0) continue;
+        SharedCacheBank& bank = banks_[b];
+
+        uint64_t start = std::max(now, bank.busy_until);
+        if (start > now) ++bank.conflicts;
+        bank.busy_until = start + config_.hit_latency + lines_per_bank[b] - 1;
+        ++bank.accesses;
+
+        finish = std::max(finish, bank.busy_until);
+    }
+    return finish - now;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+const SharedCacheConfig& SharedCache::get_config() const {
+    return config_;
+}
+
+const SharedCacheStats& SharedCache::get_stats() const {
+    return stats_;
+}
+
+const std::vector<SharedCacheBank>& SharedCache::get_banks() const {
+    return banks_;
+}
+
+bool SharedCache::in_memory(uint64_t line) const {
+    return (line + 1) * SharedMemory::LINE_WORDS <= memory_.size();
+}
+
+size_t SharedCache::find_or_allocate(uint64_t line, bool fetch, bool& hit, SharedCacheAccess& access) {
+    uint32_t set = static_cast<uint32_t>(line % tags_.get_sets());
+    uint64_t tag = line / tags_.get_sets();
+
+    int way = tags_.lookup(set, tag);
+    if (way >= 0) {
+        hit = true;
+        ++access.hits;
+        tags_.touch(set, static_cast<uint32_t>(way));
+        return static_cast<size_t>(set) * tags_.get_ways() + static_cast<uint32_t>(way);
+    }
+
+    hit = false;
+    ++access.misses;
+
+    // 1) La víctima sucia vuelve a memoria antes de reutilizar el frame
+    uint32_t victim = tags_.victim(set);
+    size_t f = static_cast<size_t>(set) * tags_.get_ways() + victim;
+    if (tags_.is_valid(set, victim) && dirty_[f]) {
+        uint64_t victim_line = tags_.get_tag(set, victim) * tags_.get_sets() + set;
+        memory_.write_shared_memory_lines({data_[f]}, victim_line * SharedMemory::LINE_WORDS);
+        access.writeback_lines.push_back(victim_line);
+        ++stats_.writebacks;
+    }
+
+    // 2) Se instala la línea; si no se va a sobrescribir entera, se trae de memoria
+    if (fetch) {
+        data_[f] = memory_.read_shared_memory(line * SharedMemory::LINE_WORDS, LINE_SIZE)[0];
+        access.fill_lines.push_back(line);
+        ++stats_.fills;
+    }
+    dirty_[f] = 0;
+    tags_.fill(set, victim, tag);
+    return f;
+}
@@ -1,20 +1,94 @@
 #include "../../include/components/Shared_Memory.h"
+#include "../../include/Config_File.h"
+#include "../../include/Seeded_Fill.h"
+#include "../../include/Byte_Swap.h"
 #include <random>
 #include <fstream>
 #include <bitset>
 #include <filesystem>
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
-SharedMemory::SharedMemory()
-    : data(MEMORY_SIZE, 0) {
+/** @brief Una página debe contener líneas completas de 16 bytes. */
+static constexpr uint32_t LINE_WORDS_MIN = SharedMemory::LINE_WORDS;
+
+MemoryConfig MemoryConfig::load_from_file(const std::string& filename) {
+    ConfigFile cfg(filename);
+    MemoryConfig config;
+
+    if (!cfg.is_loaded()) {
+        std::cerr << "[SharedMemory] Warning: could not open " << filename
+                  << ", using " << config.banks << " line-interleaved banks\n";
+        return config;
+    }
+
+    config.words      = static_cast<uint64_t>(cfg.get_int("memory_words", static_cast<int64_t>(config.words)));
+    config.page_words = static_cast<uint32_t>(cfg.get_int("page_words", config.page_words));
+    config.init       = MappedFile::parse_init(cfg.get_string("init", "random"));
+    config.seed       = static_cast<uint64_t>(cfg.get_int("seed", static_cast<int64_t>(config.seed)));
+    config.storage    = MappedFile::parse_storage(cfg.get_string("storage", "heap"));
+    config.banks      = static_cast<uint32_t>(cfg.get_int("banks", config.banks));
+    config.page_lines = static_cast<uint32_t>(cfg.get_int("page_lines", config.page_lines));
+
+    std::string interleave = cfg.get_string("interleave", "line");
+    if (interleave == "line") {
+        config.interleave = Interleave::LINE;
+    } else if (interleave == "page") {
+        config.interleave = Interleave::PAGE;
+    } else {
+        throw std::invalid_argument(filename + ": interleave debe ser 'line' o 'page': " + interleave);
+    }
+
+    if (config.banks == 0 || config.page_lines == 0) {
+        throw std::invalid_argument(filename + ": banks y page_lines deben ser mayores que 0");
+    }
+
+    if (config.page_words < LINE_WORDS_MIN || (config.page_words & (config.page_words - 1)) != 0) {
+        throw std::invalid_argument(filename + ": page_words debe ser potencia de 2 y al menos "
+                                    + std::to_string(LINE_WORDS_MIN));
+    }
+
+    // memory_words sigue las mismas reglas que ve el ensamblador
+    Geometry geometry;
+    geometry.memory_words = config.words;
+    geometry.validate();
+    return config;
+}
+
+SharedMemory::SharedMemory(const MemoryConfig& config)
+    : config_(config), banks_(config.banks) {
+        while ((uint64_t{1} << page_shift_) < config_.page_words) ++page_shift_;
+
         std::cout << "[SharedMemory] Initializing shared memory with "
-              << MEMORY_SIZE << " words of 32 bits each...\n";
+              << config_.words << " words of 32 bits each (" << config_.page_words
+              << "-word pages, allocated on first touch) in " << config_.banks << " "
+              << (config_.interleave == Interleave::LINE ? "line" : "page")
+              << "-interleaved banks (" << bswap32_kernel_name() << " word conversion)...\n";
 
         // Guarda el directorio y el filename donde se volcara el shared memory en disco
         dump_path_txt = "config/shared_memory/shared_memory.txt";
         dump_path_bin = "config/shared_memory/shared_memory.bin";
+        image_path    = "config/shared_memory/shared_memory.img";
+
+        if (config_.dram.enabled) {
+            dram_ = std::make_unique<DramModel>(config_.dram, config_.banks);
+            std::cout << "[SharedMemory] DRAM backend: " << config_.dram.row_size << "-byte rows, "
+                      << (config_.dram.page_policy == PagePolicy::OPEN ? "open" : "close") << " page, tRCD="
+                      << config_.dram.t_rcd << " tCAS=" << config_.dram.t_cas << " tRP=" << config_.dram.t_rp << "\n";
+        }
+
+        // Con mmap el .img es la memoria: imagen plana redondeada a páginas completas.
+        // Va en un archivo propio porque el .bin de heap guarda registros por página.
+        if (config_.storage == Storage::MMAP) {
+            fs::create_directories("config/shared_memory");
+            uint64_t pages = (config_.words + config_.page_words - 1) >> page_shift_;
+            image_ = MappedFile(image_path, static_cast<size_t>((pages << page_shift_) * sizeof(uint32_t)));
+            std::cout << "[SharedMemory] Mapped " << image_path << " ("
+                      << (image_.reused() ? "existing image" : "new image") << ")\n";
+        }
 
         // Inicializar Shared Memory
         initialize();
@@ -23,9 +97,19 @@ SharedMemory::SharedMemory()
 /* ---------------------------------------- Initializing --------------------------------------- */
 
 void SharedMemory::initialize() {
-    // Se llena con datos aleatorios
+    // Se elige la semilla de los datos aleatorios
     fill_random();
 
+    // Arranque en caliente desde la imagen anterior; sin ella se genera con la semilla
+    if (config_.init == InitMode::IMAGE && load_image()) return;
+
+    // Sin arranque en caliente la imagen mapeada de otra corrida se vacía entera:
+    // las páginas que no se toquen no deben quedar con datos viejos
+    if (image_.reused()) image_.discard();
+
+    // Con mmap no hay nada que volcar: el archivo ya es la memoria
+    if (image_.is_open() || config_.init != InitMode::RANDOM) return;
+
     // Volcado del shared memory como binario a disco
     dump_to_binary_file();
 
@@ -33,21 +117,98 @@ void SharedMemory::initialize() {
     dump_to_text_file();
 }
 
-size_t SharedMemory::size() const {
-    return MEMORY_SIZE;
+uint64_t SharedMemory::size() const {
+    return config_.words;
+}
+
+size_t SharedMemory::touched_pages() const {
+    return pages_.size();
 }
 
 void SharedMemory::fill_random() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint32_t> distrib(0, UINT32_MAX);
+    if (config_.init == InitMode::RANDOM) {
+        std::random_device rd;
+        seed_ = (static_cast<uint64_t>(rd()) << 32) | rd();
+    } else {
+        seed_ = config_.seed;
+    }
+    warm_ = false;
+    pages_.clear();
+    heap_pages_.clear();
+}
+
+void SharedMemory::init_page(uint64_t page, uint32_t* words) const {
+    // Cada página tiene su propio flujo: no importa en qué orden se toquen
+    seeded_fill(seed_, page, words, config_.page_words * sizeof(uint32_t));
+}
+
+bool SharedMemory::load_image() {
+    // Con mmap la imagen ya está mapeada: basta con no regenerar sus páginas
+    if (image_.is_open()) {
+        warm_ = image_.reused();
+        if (!warm_) {
+            std::cerr << "[SharedMemory] Warning: no previous image of this size in "
+                      << image_path << ", generating from seed " << seed_ << "\n";
+        }
+        return warm_;
+    }
+
+    std::ifstream in(dump_path_bin, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "[SharedMemory] Warning: could not open " << dump_path_bin
+                  << ", generating from seed " << seed_ << "\n";
+        return false;
+    }
 
-    for (auto& elem : data) {
-        elem = distrib(gen);
+    // Registros (base, count, palabras) tal como los escribe dump_to_binary_file
+    uint64_t base;
+    uint32_t count;
+    while (in.read(reinterpret_cast<char*>(&base), sizeof(base))) {
+        if (!in.read(reinterpret_cast<char*>(&count), sizeof(count))
+            || (base & (config_.page_words - 1)) != 0 || count > config_.page_words
+            || base + count > config_.words) {
+            std::cerr << "[SharedMemory] Warning: " << dump_path_bin
+                      << " does not match this memory geometry, generating from seed " << seed_ << "\n";
+            fill_random();
+            return false;
+        }
+        uint32_t* words = touch_page(base >> page_shift_);
+        if (!in.read(reinterpret_cast<char*>(words), count * sizeof(uint32_t))) {
+            std::cerr << "[SharedMemory] Warning: " << dump_path_bin
+                      << " is truncated, generating from seed " << seed_ << "\n";
+            fill_random();
+            return false;
+        }
     }
+
+    std::cout << "[SharedMemory] Loaded " << pages_.size() << " page(s) from " << dump_path_bin << "\n";
+    return true;
+}
+
+uint32_t* SharedMemory::touch_page(uint64_t page) {
+    auto it = pages_.find(page);
+    if (it != pages_.end()) return it->second;
+
+    uint32_t* words;
+    if (image_.is_open()) {
+        // La página ya está en el archivo; una imagen de arranque en caliente conserva su contenido
+        words = reinterpret_cast<uint32_t*>(image_.data()) + (page << page_shift_);
+        if (!warm_) init_page(page, words);
+    } else {
+        heap_pages_.push_back(std::make_unique<uint32_t[]>(config_.page_words));
+        words = heap_pages_.back().get();
+        init_page(page, words);
+    }
+    pages_.emplace(page, words);
+    return words;
 }
 
 void SharedMemory::dump_to_binary_file() const {
+    if (image_.is_open()) {
+        image_.sync();
+        return;
+    }
+
     // Asegurar que la carpeta existe
     fs::path dir = "config/shared_memory";
     if (fs::exists(dir)) {
@@ -63,7 +224,20 @@ void SharedMemory::dump_to_binary_file() const {
     if (!out.is_open()) {
         throw std::runtime_error("Error: No se pudo crear el archivo binario: " + dump_path_bin);
     }
-    out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint32_t));
+
+    std::vector<uint64_t> order;
+    order.reserve(pages_.size());
+    for (const auto& [page, words] : pages_) order.push_back(page);
+    std::sort(order.begin(), order.end());
+
+    for (uint64_t page : order) {
+        const uint32_t* words = pages_.at(page);
+        uint64_t base  = page << page_shift_;
+        uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(config_.page_words, config_.words - base));
+        out.write(reinterpret_cast<const char*>(&base), sizeof(base));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(words), count * sizeof(uint32_t));
+    }
     out.close();
 }
 
@@ -84,8 +258,19 @@ void SharedMemory::dump_to_text_file() const {
         throw std::runtime_error("Error: No se pudo crear el archivo de texto: " + dump_path_txt);
     }
 
-    for (uint32_t word : data) {
-        file << std::hex << std::setw(8) << std::setfill('0') << word << "\n";
+    std::vector<uint64_t> order;
+    order.reserve(pages_.size());
+    for (const auto& [page, words] : pages_) order.push_back(page);
+    std::sort(order.begin(), order.end());
+
+    for (uint64_t page : order) {
+        const uint32_t* words = pages_.at(page);
+        uint64_t base  = page << page_shift_;
+        uint64_t count = std::min<uint64_t>(config_.page_words, config_.words - base);
+        file << "@" << std::hex << base << "\n";
+        for (uint64_t i = 0; i < count; ++i) {
+            file << std::hex << std::setw(8) << std::setfill('0') << words[i] << "\n";
+        }
     }
 
     file.close();
@@ -95,108 +280,200 @@ void SharedMemory::dump_to_text_file() const {
 
 /* --------------------------------------- Data Handling --------------------------------------- */
 
-void SharedMemory::write_shared_memory_lines(const std::vector<std::vector<uint8_t>>& blocks, size_t address) {
-    // Abrir el archivo para lectura
-    std::ifstream infile(dump_path_txt);
-    if (!infile) {
-        std::cerr << "[SharedMemory] Error: no se pudo abrir shared_memory.txt.\n";
-        return;
+void SharedMemory::check_write(const std::vector<std::vector<uint8_t>>& blocks, uint64_t address) const {
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        if (blocks[b].size() != 16) {
+            throw std::invalid_argument("SharedMemory: el bloque " + std::to_string(b)
+                                        + " no tiene exactamente 16 bytes");
+        }
     }
-
-    std::vector<std::string> file_lines;
-    std::string line;
-    while (std::getline(infile, line)) {
-        file_lines.push_back(line);
+    if (address > config_.words || blocks.size() > (config_.words - address) / 4) {
+        throw std::out_of_range("SharedMemory: escritura de " + std::to_string(blocks.size())
+                                + " bloque(s) desde la palabra " + std::to_string(address)
+                                + " pasa del final de la memoria (" + std::to_string(config_.words) + " palabras)");
     }
-    infile.close();
+}
 
-    // Escribir cada bloque (cada uno contiene 16 bytes = 4 líneas)
-    for (size_t b = 0; b < blocks.size(); ++b) {
-        const auto& block = blocks[b];
+void SharedMemory::write_shared_memory_lines(const std::vector<std::vector<uint8_t>>& blocks, uint64_t address) {
+    // Todo o nada: una escritura inválida no deja bloques a medias
+    check_write(blocks, address);
 
-        if (block.size() != 16) {
-            std::cerr << "[SharedMemory] Error: cada bloque debe tener exactamente 16 bytes.\n";
-            return;
-        }
+    // Los bloques se juntan en un solo buffer para convertir cada tramo de página de una vez
+    const size_t count = blocks.size();
+    std::vector<uint8_t> staging(count * 16);
+    for (size_t b = 0; b < count; ++b) {
+        std::copy(blocks[b].begin(), blocks[b].end(), staging.begin() + b * 16);
+    }
 
-        size_t current_address = address + b * 4;
-        if (current_address + 4 > file_lines.size()) {
-            std::cerr << "[SharedMemory] Error: escritura fuera del rango del archivo en bloque " << b << ".\n";
-            return;
-        }
+    const uint64_t mask  = config_.page_words - 1;
+    const uint64_t words = static_cast<uint64_t>(count) * 4;
+    for (uint64_t w = 0; w < words; ) {
+        uint64_t  word       = address + w;
+        uint32_t* page_words = touch_page(word >> page_shift_);
+        uint64_t  run        = std::min<uint64_t>(words - w, config_.page_words - (word & mask));
+        bswap32_copy(staging.data() + w * 4, page_words + (word & mask), run);
+        w += run;
+    }
 
-        // Convertir cada grupo de 4 bytes a una línea de 8 dígitos hexadecimales
-        for (int i = 0; i < 4; ++i) {
-            uint32_t word = (block[i * 4] << 24) | (block[i * 4 + 1] << 16) |
-                            (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    std::cout << "[SharedMemory] Se escribieron " << blocks.size() << " bloque(s) de 128 bits correctamente desde dirección " << address << ".\n";
+}
 
-            std::stringstream ss;
-            ss << std::hex << std::setw(8) << std::setfill('0') << word;
-            file_lines[current_address + i] = ss.str();
-        }
-    }
 
-    // Escribir de nuevo todo el archivo
-    std::ofstream outfile(dump_path_txt);
-    if (!outfile) {
-        std::cerr << "[SharedMemory] Error: no se pudo abrir el archivo para escritura.\n";
-        return;
+std::vector<std::vector<std::uint8_t>> SharedMemory::read_shared_memory(uint64_t address, size_t size_bytes) {
+    // Calcular cantidad de palabras necesarias (cada palabra = 4 bytes)
+    size_t words_to_read = (size_bytes + 3) / 4;
+    size_t blocks_to_read = (words_to_read + 3) / 4; // bloques de 4 palabras (128 bits)
+
+    // Todo el tramo sale en big-endian a un solo buffer, con padding en 0 fuera de la memoria
+    std::vector<std::uint8_t> staging(blocks_to_read * 16, 0);
+    const uint64_t mask  = config_.page_words - 1;
+    const uint64_t words = address < config_.words
+                         ? std::min<uint64_t>(blocks_to_read * 4, config_.words - address) : 0;
+    for (uint64_t w = 0; w < words; ) {
+        uint64_t  index      = address + w;
+        uint32_t* page_words = touch_page(index >> page_shift_);
+        uint64_t  run        = std::min<uint64_t>(words - w, config_.page_words - (index & mask));
+        bswap32_copy(page_words + (index & mask), staging.data() + w * 4, run);
+        w += run;
     }
 
-    for (const auto& l : file_lines) {
-        outfile << l << "\n";
+    std::vector<std::vector<std::uint8_t>> result;
+    result.reserve(blocks_to_read);
+    for (size_t i = 0; i < blocks_to_read; ++i) {
+        result.emplace_back(staging.begin() + i * 16, staging.begin() + (i + 1) * 16);
     }
-
-    std::cout << "[SharedMemory] Se escribieron " << blocks.size() << " bloque(s) de 128 bits correctamente desde dirección " << address << ".\n";
+    return result;
 }
 
+/* --------------------------------------------------------------------------------------------- */
 
-std::vector<std::vector<std::uint8_t>> SharedMemory::read_shared_memory(size_t address, size_t size_bytes) {
-    std::vector<std::vector<std::uint8_t>> result;
+/* ------------------------------------------- Banks ------------------------------------------- */
 
-    // Abrir archivo directamente
-    std::ifstream infile(dump_path_txt);
-    if (!infile) {
-        std::cerr << "[SharedMemory] Error: no se pudo abrir shared_memory.txt.\n";
-        return result;
+uint32_t SharedMemory::bank_of(uint64_t word_address) const {
+    uint64_t line = word_address / LINE_WORDS;
+    if (config_.interleave == Interleave::PAGE) {
+        line /= config_.page_lines;
     }
+    return static_cast<uint32_t>(line % config_.banks);
+}
 
-    // Leer líneas del archivo
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(infile, line)) {
-        lines.push_back(line);
+uint64_t SharedMemory::row_of(uint64_t line) const {
+    // Línea dentro de su banco: se quita la parte de la dirección que elige el banco
+    uint64_t local;
+    if (config_.interleave == Interleave::PAGE) {
+        uint64_t page = line / config_.page_lines;
+        local = (page / config_.banks) * config_.page_lines + line % config_.page_lines;
+    } else {
+        local = line / config_.banks;
     }
-    infile.close();
+    return local / config_.dram.row_lines();
+}
 
-    // Calcular cantidad de líneas necesarias (cada línea = 4 bytes)
-    size_t lines_to_read = static_cast<size_t>(std::ceil(size_bytes / 4.0));
-    size_t blocks_to_read = (lines_to_read + 3) / 4; // bloques de 4 líneas (128 bits)
+bool SharedMemory::banks_free(uint64_t first_word, uint64_t words, uint64_t now) const {
+    uint64_t first_line = first_word / LINE_WORDS;
+    uint64_t end_line   = (first_word + std::max<uint64_t>(words, 1) + LINE_WORDS - 1) / LINE_WORDS;
+    // Con más líneas que bancos basta recorrer una vuelta completa
+    end_line = std::min(end_line, first_line + banks_.size() * (config_.interleave == Interleave::PAGE
+                                                                    ? config_.page_lines : 1));
+    for (uint64_t line = first_line; line < end_line; ++line) {
+        if (banks_[bank_of(line * LINE_WORDS)].busy_until > now) return false;
+    }
+    return true;
+}
 
+bool SharedMemory::rows_open(uint64_t first_word, uint64_t words) const {
+    if (!dram_) return false;
+    uint64_t first_line = first_word / LINE_WORDS;
+    uint64_t end_line   = (first_word + std::max<uint64_t>(words, 1) + LINE_WORDS - 1) / LINE_WORDS;
+    for (uint64_t line = first_line; line < end_line; ++line) {
+        if (!dram_->is_open(bank_of(line * LINE_WORDS), row_of(line))) return false;
+    }
+    return true;
+}
 
-    for (size_t i = 0; i < blocks_to_read; ++i) {
-        std::vector<std::uint8_t> block;
+std::vector<uint64_t> SharedMemory::words_per_bank(uint64_t first_word, uint64_t words) const {
+    std::vector<uint64_t> per_bank(banks_.size(), 0);
+    uint64_t end_word = first_word + std::max<uint64_t>(words, 1);
+    for (uint64_t line = first_word / LINE_WORDS; line * LINE_WORDS < end_word; ++line) {
+        uint64_t lo = std::max(first_word, line * LINE_WORDS);
+        uint64_t hi = std::min(end_word, (line + 1) * LINE_WORDS);
+        per_bank[bank_of(line * LINE_WORDS)] += hi - lo;
+    }
+    return per_bank;
+}
+
+uint64_t SharedMemory::schedule_access(uint64_t first_word, uint64_t words, uint64_t now,
+                                       const std::function<uint64_t(uint64_t)>& service_cycles,
+                                       bool write, std::vector<BankWindow>* windows) {
+    // 1) Repartir las líneas del acceso entre los bancos (con su fila DRAM, si aplica)
+    //    y contar cuántas de las palabras pedidas caen en cada uno
+    std::vector<std::vector<uint64_t>> rows_per_bank(banks_.size());
+    std::vector<uint64_t> bank_words = words_per_bank(first_word, words);
+    uint64_t first_line = first_word / LINE_WORDS;
+    uint64_t end_line   = (first_word + std::max<uint64_t>(words, 1) + LINE_WORDS - 1) / LINE_WORDS;
+    for (uint64_t line = first_line; line < end_line; ++line) {
+        rows_per_bank[bank_of(line * LINE_WORDS)].push_back(dram_ ? row_of(line) : 0);
+    }
+    if (windows) windows->assign(banks_.size(), BankWindow{});
+
+    // 2) Cada banco arranca cuando queda libre; el acceso acaba con el último
+    uint64_t finish = now;
+    for (size_t b = 0; b < banks_.size(); ++b) {
+        const auto& rows = rows_per_bank[b];
+        if (rows.empty()) continue;
+        MemoryBank& bank = banks_[b];
+
+        // Olvidar los accesos que ya terminaron
+        while (!bank.in_flight.empty() && bank.in_flight.front() <= now) {
+            bank.in_flight.pop_front();
+        }
 
-        for (size_t j = 0; j < 4; ++j) {
-            size_t index = address + i * 4 + j;
-            std::string word_hex = (index < lines.size()) ? lines[index] : "00000000";
+        uint64_t start   = std::max(now, bank.busy_until);
+        uint64_t service = dram_
+            ? dram_->service(static_cast<uint32_t>(b), rows, start, write) - start
+            : service_cycles(bank_words[b]);
+        if (start > now) ++bank.conflicts;
 
-            if (word_hex.length() != 8 ){
+        bank.busy_until   = start + service;
+        bank.busy_cycles += service;
+        ++bank.accesses;
+        bank.in_flight.push_back(bank.busy_until);
+        bank.max_in_flight = std::max(bank.max_in_flight, bank.in_flight.size());
+        if (windows) (*windows)[b] = BankWindow{start, bank.busy_until};
 
-                word_hex = std::string (8 - word_hex.length(), '0') + word_hex;
-            }
+        finish = std::max(finish, bank.busy_until);
+    }
 
-            uint32_t word = std::stoul(word_hex, nullptr, 16);
-            block.push_back((word >> 24) & 0xFF);
-            block.push_back((word >> 16) & 0xFF);
-            block.push_back((word >> 8) & 0xFF);
-            block.push_back(word & 0xFF);
+    return finish - now;
+}
 
-        }
-        result.push_back(block);
+uint64_t SharedMemory::part_cycles(const std::vector<BankWindow>& windows, uint64_t first_word,
+                                   uint64_t words, uint64_t now,
+                                   const std::function<uint64_t(uint64_t)>& service_cycles) const {
+    // Cada banco entrega primero las palabras de esta parte: le bastan sus propios
+    // ciclos de servicio, salvo con DRAM, donde la ráfaga de filas es del acceso entero
+    std::vector<uint64_t> bank_words = words_per_bank(first_word, words);
+    uint64_t finish = now;
+    for (size_t b = 0; b < banks_.size() && b < windows.size(); ++b) {
+        if (bank_words[b] == 0) continue;
+        const BankWindow& window = windows[b];
+        uint64_t end = dram_ ? window.finish
+                             : std::min(window.finish, window.start + service_cycles(bank_words[b]));
+        finish = std::max(finish, end);
     }
+    return finish - now;
+}
 
-    return result;
+const MemoryConfig& SharedMemory::get_config() const {
+    return config_;
+}
+
+const std::vector<MemoryBank>& SharedMemory::get_banks() const {
+    return banks_;
+}
+
+const DramModel* SharedMemory::get_dram() const {
+    return dram_.get();
 }
 
 /* --------------------------------------------------------------------------------------------- */
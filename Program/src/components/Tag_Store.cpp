@@ -0,0 +1,134 @@
+#include "../../include/components/Tag_Store.h"
+#include <stdexcept>
+
+TagStore::TagStore(uint32_t sets, uint32_t ways, Replacement policy, uint32_t seed)
+    : sets_(sets), ways_(ways), policy_(policy),
+      tags_(static_cast<size_t>(sets) * ways, 0),
+      valid_(static_cast<size_t>(sets) * ways, 0),
+      last_use_(static_cast<size_t>(sets) * ways, 0),
+      plru_bits_(sets, 0),
+      rng_(seed) {
+    if (sets_ == 0 || ways_ == 0) {
+        throw std::invalid_argument("TagStore: sets y ways deben ser mayores que 0");
+    }
+    if (policy_ == Replacement::PLRU && (ways_ > 64 || (ways_ & (ways_ - 1)) != 0)) {
+        throw std::invalid_argument("TagStore: PLRU requiere ways potencia de 2 y <= 64");
+    }
+}
+
+Replacement TagStore::parse_replacement(const std::string& name) {
+    if (name == "lru")    return Replacement::LRU;
+    if (name == "plru")   return Replacement::PLRU;
+    if (name == "random") return Replacement::RANDOM;
+    throw std::invalid_argument("replacement debe ser 'lru', 'plru' o 'random': " + name);
+}
+
+const char* TagStore::replacement_to_string(Replacement policy) {
+    switch (policy) {
+        case Replacement::LRU:    return "lru";
+        case Replacement::PLRU:   return "plru";
+        case Replacement::RANDOM: return "random";
+        default:                  return "unknown";
+    }
+}
+
+/* ------------------------------------------ Lookup ------------------------------------------- */
+
+int TagStore::lookup(uint32_t set, uint64_t tag) const {
+    for (uint32_t way = 0; way < ways_; ++way) {
+        size_t f = frame(set, way);
+        if (valid_[f] && tags_[f] == tag) {
+            return static_cast<int>(way);
+        }
+    }
+    return -1;
+}
+
+void TagStore::touch(uint32_t set, uint32_t way) {
+    if (policy_ == Replacement::LRU) {
+        last_use_[frame(set, way)] = ++clock_;
+    } else if (policy_ == Replacement::PLRU) {
+        // Recorre el árbol desde la raíz dejando cada nodo apuntando lejos de esta vía
+        uint64_t& bits = plru_bits_[set];
+        uint32_t node = 1;
+        for (uint32_t span = ways_ / 2; span > 0; span /= 2) {
+            bool right = (way & span) != 0;
+            if (right) bits &= ~(1ULL << node);
+            else       bits |=  (1ULL << node);
+            node = node * 2 + (right ? 1 : 0);
+        }
+    }
+}
+
+uint32_t TagStore::victim(uint32_t set) {
+    for (uint32_t way = 0; way < ways_; ++way) {
+        if (!valid_[frame(set, way)]) return way;
+    }
+
+    switch (policy_) {
+        case Replacement::LRU: {
+            uint32_t oldest = 0;
+            for (uint32_t way = 1; way < ways_; ++way) {
+                if (last_use_[frame(set, way)] < last_use_[frame(set, oldest)]) oldest = way;
+            }
+            return oldest;
+        }
+        case Replacement::PLRU: {
+            // Sigue los bits: 1 = la víctima está a la derecha
+            uint64_t bits = plru_bits_[set];
+            uint32_t node = 1, way = 0;
+            for (uint32_t span = ways_ / 2; span > 0; span /= 2) {
+                bool right = (bits >> node) & 1ULL;
+                if (right) way |= span;
+                node = node * 2 + (right ? 1 : 0);
+            }
+            return way;
+        }
+        case Replacement::RANDOM:
+        default: {
+            std::uniform_int_distribution<uint32_t> pick(0, ways_ - 1);
+            return pick(rng_);
+        }
+    }
+}
+
+void TagStore::fill(uint32_t set, uint32_t way, uint64_t tag) {
+    size_t f = frame(set, way);
+    tags_[f]  = tag;
+    valid_[f] = 1;
+    touch(set, way);
+}
+
+void TagStore::invalidate(uint32_t set, uint32_t way) {
+    valid_[frame(set, way)] = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ----------------------------------- Getters & Setters --------------------------------------- */
+
+bool TagStore::is_valid(uint32_t set, uint32_t way) const {
+    return valid_[frame(set, way)] != 0;
+}
+
+uint64_t TagStore::get_tag(uint32_t set, uint32_t way) const {
+    return tags_[frame(set, way)];
+}
+
+uint32_t TagStore::get_sets() const {
+    return sets_;
+}
+
+uint32_t TagStore::get_ways() const {
+    return ways_;
+}
+
+Replacement TagStore::get_policy() const {
+    return policy_;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+size_t TagStore::frame(uint32_t set, uint32_t way) const {
+    return static_cast<size_t>(set) * ways_ + way;
+}
@@ -0,0 +1,185 @@
+#include "../../include/components/Write_Combining_Buffer.h"
+#include "../../include/Config_File.h"
+#include "../../include/Geometry.h"
+#include <algorithm>
+#include <stdexcept>
+
+WriteCombineConfig WriteCombineConfig::from_config(const ConfigFile& cfg) {
+    WriteCombineConfig config;
+
+    int64_t entries    = cfg.get_int("wc_entries", config.entries);
+    int64_t window     = cfg.get_int("wc_window", config.window);
+    int64_t max_blocks = cfg.get_int("wc_max_blocks", config.max_blocks);
+
+    if (entries < 0 || window < 0) {
+        throw std::invalid_argument(cfg.path() + ": wc_entries y wc_window no pueden ser negativos");
+    }
+    if (max_blocks < 1 || max_blocks > Geometry::max_field_value()) {
+        throw std::invalid_argument(cfg.path() + ": wc_max_blocks debe estar entre 1 y "
+                                    + std::to_string(Geometry::max_field_value()));
+    }
+    config.entries    = static_cast<uint32_t>(entries);
+    config.window     = static_cast<uint32_t>(window);
+    config.max_blocks = static_cast<uint32_t>(max_blocks);
+    return config;
+}
+
+WriteCombiningBuffer::WriteCombiningBuffer(const WriteCombineConfig& config)
+    : config_(config) {}
+
+bool WriteCombiningBuffer::enabled() const {
+    return config_.entries > 0;
+}
+
+/* ------------------------------------------ Insert ------------------------------------------- */
+
+std::vector<Message> WriteCombiningBuffer::insert(const Message& write, uint64_t step) {
+    std::vector<Message> out;
+    uint64_t first = write.get_address();
+    uint64_t words = static_cast<uint64_t>(write.get_data().size()) * Geometry::BLOCK_WORDS;
+
+    ++stats_.writes;
+    stats_.bytes_in += write.get_data().size() * Geometry::BLOCK_SIZE;
+
+    // La primera entrada (la más vieja) que pueda absorberla la recibe
+    long target = -1;
+    for (size_t i = 0; i < entries_.size() && target < 0; ++i) {
+        if (can_merge(entries_[i], first, words)) {
+            target = static_cast<long>(i);
+        }
+    }
+
+    // Las demás entradas que solapa salen antes: las entradas nunca se solapan entre sí
+    for (size_t i = 0; i < entries_.size();) {
+        const Entry& e = entries_[i];
+        bool overlaps = e.first_word < first + words && first < e.first_word + e.words;
+        if (overlaps && static_cast<long>(i) != target) {
+            out.push_back(release(i, FlushReason::CONFLICT));
+            if (target > static_cast<long>(i)) --target;
+        } else {
+            ++i;
+        }
+    }
+
+    if (target >= 0) {
+        merge(entries_[static_cast<size_t>(target)], write, first, words);
+        ++stats_.merged;
+        return out;
+    }
+
+    if (entries_.size() >= config_.entries) {
+        out.push_back(release(0, FlushReason::CAPACITY));
+    }
+    Message msg = write;
+    msg.set_start_line(0);
+    entries_.push_back({std::move(msg), first, words, step});
+    return out;
+}
+
+bool WriteCombiningBuffer::can_merge(const Entry& entry, uint64_t first, uint64_t words) const {
+    if (words == 0 || entry.first_word % Geometry::BLOCK_WORDS != first % Geometry::BLOCK_WORDS) {
+        return false;
+    }
+    // Contiguas o solapadas (un rango que termina justo donde empieza el otro también vale)
+    if (first > entry.first_word + entry.words || entry.first_word > first + words) {
+        return false;
+    }
+    uint64_t lo = std::min(entry.first_word, first);
+    uint64_t hi = std::max(entry.first_word + entry.words, first + words);
+    return (hi - lo) / Geometry::BLOCK_WORDS <= config_.max_blocks;
+}
+
+void WriteCombiningBuffer::merge(Entry& entry, const Message& write, uint64_t first, uint64_t words) const {
+    uint64_t lo = std::min(entry.first_word, first);
+    uint64_t hi = std::max(entry.first_word + entry.words, first + words);
+
+    // Bloques de la unión: primero los de la entrada, encima los de la escritura nueva
+    std::vector<std::vector<uint8_t>> blocks((hi - lo) / Geometry::BLOCK_WORDS);
+    const auto& old_blocks = entry.msg.get_data();
+    const auto& new_blocks = write.get_data();
+    size_t old_offset = (entry.first_word - lo) / Geometry::BLOCK_WORDS;
+    size_t new_offset = (first - lo) / Geometry::BLOCK_WORDS;
+    std::copy(old_blocks.begin(), old_blocks.end(), blocks.begin() + old_offset);
+    std::copy(new_blocks.begin(), new_blocks.end(), blocks.begin() + new_offset);
+
+    entry.msg.set_address(lo);
+    entry.msg.set_data(blocks);
+    entry.msg.set_num_lines(static_cast<uint32_t>(blocks.size()));
+    entry.first_word = lo;
+    entry.words      = hi - lo;
+}
+
+/* ------------------------------------------- Flush ------------------------------------------- */
+
+std::vector<Message> WriteCombiningBuffer::take_overlapping(uint64_t address, uint64_t words) {
+    std::vector<Message> out;
+    for (size_t i = 0; i < entries_.size();) {
+        const Entry& e = entries_[i];
+        if (e.first_word < address + words && address < e.first_word + e.words) {
+            out.push_back(release(i, FlushReason::CONFLICT));
+        } else {
+            ++i;
+        }
+    }
+    return out;
+}
+
+std::vector<Message> WriteCombiningBuffer::take_expired(uint64_t step) {
+    std::vector<Message> out;
+    // Las entradas están en orden de apertura: las vencidas son un prefijo
+    while (!entries_.empty() && step - entries_.front().allocated >= config_.window) {
+        out.push_back(release(0, FlushReason::TIMEOUT));
+    }
+    return out;
+}
+
+std::vector<Message> WriteCombiningBuffer::take_all(FlushReason reason) {
+    std::vector<Message> out;
+    while (!entries_.empty()) {
+        out.push_back(release(0, reason));
+    }
+    return out;
+}
+
+Message WriteCombiningBuffer::release(size_t index, FlushReason reason) {
+    Message msg = std::move(entries_[index].msg);
+    entries_.erase(entries_.begin() + static_cast<long>(index));
+
+    ++stats_.flushed;
+    stats_.bytes_out += msg.get_data().size() * Geometry::BLOCK_SIZE;
+    switch (reason) {
+        case FlushReason::CAPACITY: ++stats_.capacity_flushes; break;
+        case FlushReason::CONFLICT: ++stats_.conflict_flushes; break;
+        case FlushReason::FENCE:    ++stats_.fence_flushes;    break;
+        case FlushReason::TIMEOUT:  ++stats_.timeout_flushes;  break;
+        case FlushReason::DRAIN:    ++stats_.drain_flushes;    break;
+    }
+    ++inflight_;
+    return msg;
+}
+
+void WriteCombiningBuffer::on_complete() {
+    if (inflight_ > 0) --inflight_;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* ----------------------------------- Getters & Setters --------------------------------------- */
+
+bool WriteCombiningBuffer::empty() const {
+    return entries_.empty();
+}
+
+size_t WriteCombiningBuffer::inflight() const {
+    return inflight_;
+}
+
+const WriteCombineConfig& WriteCombiningBuffer::get_config() const {
+    return config_;
+}
+
+const WriteCombineStats& WriteCombiningBuffer::get_stats() const {
+    return stats_;
+}
+
+/* --------------------------------------------------------------------------------------------- */
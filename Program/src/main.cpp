@@ -14,13 +14,11 @@
 #include <iostream>
 #include <string>
 #include <limits>
+#include <stdexcept>
 
 constexpr int MAX_PES = 32;          /**< Límite máximo de PEs según especificación */
 int pe_count = 0;                    /**< Cantidad de PEs configurada por el usuario */
 
-// instancia global del Compiler
-static Compiler* compiler = nullptr;
-
 // Instancia global del System
 static System* interconnect_system = nullptr;
 
@@ -31,6 +29,7 @@ void compile_instructions();
 void initialize_system();
 void run_simulation();
 void show_statistics();
+void dump_cache_state();
 void generate_instruction_files();
 // Test declarations
 void test_G();
@@ -77,6 +76,9 @@ int main() {
 			case 5:
 				show_statistics();
 				break;
+			case 6:
+				dump_cache_state();
+				break;
 			case 8:
 				test_G();
 				break;
@@ -128,6 +130,7 @@ void show_menu() {
 			<< "3. Initialize System\n"	// <-- MODIFICADO
 			<< "4. Run Simulation\n"
 			<< "5. Show Statistics\n"
+			<< "6. Dump Cache State\n"
 			<< "8. Test G\n"
 			<< "9. Test R\n"
 			<< "0. Exit\n";
@@ -142,7 +145,14 @@ void generate_instruction_files() {
 		return;
 	}
 
-	InstructionGenerator generator(pe_count);
+	Geometry geometry;
+	try {
+		geometry = Geometry::load();
+	} catch (const std::exception& e) {
+		std::cerr << "[Init] " << e.what() << "; using default geometry\n";
+	}
+
+	InstructionGenerator generator(pe_count, 10, geometry);
 	generator.generate();
 	std::cout << "[Init] Instruction files generated for " << pe_count << " PEs.\n";
 }
@@ -156,7 +166,17 @@ void compile_instructions() {
 	// Paths
 	const std::string in_dir  = "config/assemblers";
 	const std::string out_dir = "config/binaries";
-	compiler->compile_directory(in_dir, out_dir);
+	try {
+		Compiler::set_geometry(Geometry::load());
+	} catch (const std::exception& e) {
+		std::cerr << "[Init] " << e.what() << "; using default geometry\n";
+	}
+	try {
+		Compiler::compile_directory(in_dir, out_dir);
+	} catch (const std::invalid_argument& e) {
+		std::cerr << "[Init] " << e.what() << "\n";
+		return;
+	}
 	std::cout << "[Init] Binary ready for execution on PEs.\n";
 }
 
@@ -237,6 +257,22 @@ void show_statistics() {
 	interconnect_system->report_statistics();
 }
 
+/**
+ * @brief Vuelca a disco el estado MESI de los caches, para depuración.
+ */
+void dump_cache_state() {
+	if (pe_count == 0 || !interconnect_system) {
+		std::cout << "\n[Debug] No cache state available: system not initialized.\n";
+		return;
+	}
+
+	try {
+		interconnect_system->dump_cache_state();
+	} catch (const std::exception& e) {
+		std::cerr << "[Error] " << e.what() << "\n";
+	}
+}
+
 /* ---------------------------------------- Testing -------------------------------------------- */
 
 void test_G() {